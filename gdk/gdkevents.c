@@ -500,6 +500,32 @@ _gdk_event_emit (GdkEvent *event)
  * Functions for maintaining the event queue *
  *********************************************/
 
+/* Events that are held back until the next frame, unless
+ * another event follows them, so they can be compressed.
+ */
+static gboolean
+gdk_event_is_batched (GdkEvent *event)
+{
+  if (event->flags & GDK_EVENT_FLUSHED)
+    return FALSE;
+
+  switch ((int) event->event_type)
+    {
+    case GDK_MOTION_NOTIFY:
+      return TRUE;
+
+    case GDK_TOUCH_UPDATE:
+      return event->surface && event->surface->input_batching;
+
+    case GDK_SCROLL:
+      return event->surface && event->surface->input_batching &&
+             gdk_scroll_event_get_direction (event) == GDK_SCROLL_SMOOTH;
+
+    default:
+      return FALSE;
+    }
+}
+
 /**
  * _gdk_event_queue_find_first:
  * @display: a #GdkDisplay
@@ -529,7 +555,7 @@ _gdk_event_queue_find_first (GdkDisplay *display)
           if (pending_motion)
             return pending_motion;
 
-          if (event->event_type == GDK_MOTION_NOTIFY && (event->flags & GDK_EVENT_FLUSHED) == 0)
+          if (gdk_event_is_batched (event))
             pending_motion = tmp_list;
           else
             return tmp_list;
@@ -601,6 +627,49 @@ _gdk_event_unqueue (GdkDisplay *display)
   return event;
 }
 
+/* Appends the samples of a scroll event that is dropped in favor of a
+ * later one, including the ones it collected itself when it was the
+ * result of an earlier compression.
+ */
+static GArray *
+gdk_scroll_event_push_history (GArray   *history,
+                               GdkEvent *history_event)
+{
+  GArray *old_history = ((GdkScrollEvent *) history_event)->history;
+  GdkTimeCoord hist;
+  double dx, dy;
+  guint i;
+
+  if (!history)
+    history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+
+  gdk_scroll_event_get_deltas (history_event, &dx, &dy);
+
+  /* The deltas of a compressed event include the ones of its history */
+  if (old_history)
+    {
+      for (i = 0; i < old_history->len; i++)
+        {
+          GdkTimeCoord *coord = &g_array_index (old_history, GdkTimeCoord, i);
+
+          dx -= coord->axes[GDK_AXIS_DELTA_X];
+          dy -= coord->axes[GDK_AXIS_DELTA_Y];
+        }
+
+      g_array_append_vals (history, old_history->data, old_history->len);
+    }
+
+  memset (&hist, 0, sizeof (GdkTimeCoord));
+  hist.time = gdk_event_get_time (history_event);
+  hist.flags = GDK_AXIS_FLAG_DELTA_X | GDK_AXIS_FLAG_DELTA_Y;
+  hist.axes[GDK_AXIS_DELTA_X] = dx;
+  hist.axes[GDK_AXIS_DELTA_Y] = dy;
+
+  g_array_append_val (history, hist);
+
+  return history;
+}
+
 /*
  * If the last N events in the event queue are smooth scroll events
  * for the same surface and device, combine them into one.
@@ -613,9 +682,9 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
   GdkDevice *device = NULL;
   GdkEvent *last_event = NULL;
   GList *scrolls = NULL;
+  GList *compressed = NULL;
   double delta_x, delta_y;
   GArray *history = NULL;
-  GdkTimeCoord hist;
 
   l = g_queue_peek_tail_link (&display->queued_events);
 
@@ -656,20 +725,11 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
       GList *next = scrolls->next;
       double dx, dy;
 
-      if (!history)
-        history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
-
       gdk_scroll_event_get_deltas (event, &dx, &dy);
       delta_x += dx;
       delta_y += dy;
 
-      memset (&hist, 0, sizeof (GdkTimeCoord));
-      hist.time = gdk_event_get_time (event);
-      hist.flags = GDK_AXIS_FLAG_DELTA_X | GDK_AXIS_FLAG_DELTA_Y;
-      hist.axes[GDK_AXIS_DELTA_X] = dx;
-      hist.axes[GDK_AXIS_DELTA_Y] = dy;
-
-      g_array_append_val (history, hist);
+      history = gdk_scroll_event_push_history (history, event);
 
       gdk_event_unref (event);
       g_queue_delete_link (&display->queued_events, scrolls);
@@ -679,10 +739,20 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
   if (scrolls)
     {
       GdkEvent *old_event, *event;
+      GArray *old_history;
       double dx, dy;
 
       old_event = scrolls->data;
 
+      /* Keep the samples the event collected when it was compressed before */
+      old_history = ((GdkScrollEvent *) old_event)->history;
+      if (old_history)
+        {
+          if (!history)
+            history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+          g_array_append_vals (history, old_history->data, old_history->len);
+        }
+
       gdk_scroll_event_get_deltas (old_event, &dx, &dy);
       event = gdk_scroll_event_new (surface,
                                     device,
@@ -697,12 +767,17 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
 
       g_queue_delete_link (&display->queued_events, scrolls);
       g_queue_push_tail (&display->queued_events, event);
+      compressed = g_queue_peek_tail_link (&display->queued_events);
 
       gdk_event_unref (old_event);
     }
 
-  if (g_queue_get_length (&display->queued_events) == 1 &&
-      g_queue_peek_head_link (&display->queued_events) == scrolls)
+  /* A lone scroll event may be held back for batching, so make
+   * sure the next frame delivers it.
+   */
+  if (compressed != NULL &&
+      g_queue_get_length (&display->queued_events) == 1 &&
+      g_queue_peek_head_link (&display->queued_events) == compressed)
     {
       GdkFrameClock *clock = gdk_surface_get_frame_clock (surface);
       if (clock) /* might be NULL if surface was destroyed */
@@ -717,19 +792,26 @@ gdk_motion_event_push_history (GdkEvent *event,
   GdkMotionEvent *self = (GdkMotionEvent *) event;
   GdkDeviceTool *tool;
   GdkTimeCoord hist;
+  GArray *history;
   int i;
 
   g_assert (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY));
   g_assert (GDK_IS_EVENT_TYPE (history_event, GDK_MOTION_NOTIFY));
 
-  if (!self->tool)
-    return;
-
   tool = gdk_event_get_device_tool (history_event);
 
+  /* Without a tool, we only know about the position, and that
+   * is only interesting if the surface asked for all of its input.
+   */
+  if (!self->tool && !event->surface->input_batching)
+    return;
+
   memset (&hist, 0, sizeof (GdkTimeCoord));
   hist.time = gdk_event_get_time (history_event);
-  hist.flags = gdk_device_tool_get_axes (tool);
+  if (tool)
+    hist.flags = gdk_device_tool_get_axes (tool);
+  else
+    hist.flags = GDK_AXIS_FLAG_X | GDK_AXIS_FLAG_Y;
 
   for (i = GDK_AXIS_X; i < GDK_AXIS_LAST; i++)
     gdk_event_get_axis (history_event, i, &hist.axes[i]);
@@ -737,6 +819,11 @@ gdk_motion_event_push_history (GdkEvent *event,
   if (G_UNLIKELY (!self->history))
     self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
 
+  /* The dropped event may have collected a history of its own */
+  history = ((GdkMotionEvent *) history_event)->history;
+  if (history)
+    g_array_append_vals (self->history, history->data, history->len);
+
   g_array_append_val (self->history, hist);
 }
 
@@ -790,9 +877,10 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
         {
           GdkModifierType state = gdk_event_get_modifier_state (last_motion);
 
-          if (state &
-              (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK |
-               GDK_BUTTON4_MASK | GDK_BUTTON5_MASK))
+          if (pending_motion_surface->input_batching ||
+              (state &
+               (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK |
+                GDK_BUTTON4_MASK | GDK_BUTTON5_MASK)))
            gdk_motion_event_push_history (last_motion, pending_motions->data);
         }
 
@@ -810,6 +898,130 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
     }
 }
 
+static void
+gdk_touch_event_push_history (GdkEvent *event,
+                              GdkEvent *history_event)
+{
+  GdkTouchEvent *self = (GdkTouchEvent *) event;
+  GdkTimeCoord hist;
+  GArray *history;
+  int i;
+
+  g_assert (GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE));
+  g_assert (GDK_IS_EVENT_TYPE (history_event, GDK_TOUCH_UPDATE));
+
+  memset (&hist, 0, sizeof (GdkTimeCoord));
+  hist.time = gdk_event_get_time (history_event);
+
+  for (i = GDK_AXIS_X; i < GDK_AXIS_LAST; i++)
+    {
+      if (gdk_event_get_axis (history_event, i, &hist.axes[i]))
+        hist.flags |= 1 << i;
+    }
+
+  if (G_UNLIKELY (!self->history))
+    self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+
+  /* The dropped event may have collected a history of its own */
+  history = ((GdkTouchEvent *) history_event)->history;
+  if (history)
+    g_array_append_vals (self->history, history->data, history->len);
+
+  g_array_append_val (self->history, hist);
+}
+
+/*
+ * If the last N events in the event queue are touch updates for the
+ * same surface and device, drop all but the last one of every touch
+ * sequence and record the dropped ones in its history.
+ */
+void
+gdk_event_queue_handle_touch_compression (GdkDisplay *display)
+{
+  GList *l, *first = NULL;
+  GdkSurface *surface = NULL;
+  GdkDevice *device = NULL;
+  GHashTable *last_updates;
+
+  l = g_queue_peek_tail_link (&display->queued_events);
+
+  while (l)
+    {
+      GdkEvent *event = l->data;
+
+      if (event->flags & GDK_EVENT_PENDING)
+        break;
+
+      if (event->event_type != GDK_TOUCH_UPDATE)
+        break;
+
+      if (surface != NULL &&
+          surface != event->surface)
+        break;
+
+      if (device != NULL &&
+          device != event->device)
+        break;
+
+      surface = event->surface;
+      device = event->device;
+      first = l;
+
+      l = l->prev;
+    }
+
+  if (first == NULL)
+    return;
+
+  if (first->next != NULL)
+    {
+      /* Maps each sequence to the link of its last update */
+      last_updates = g_hash_table_new (NULL, NULL);
+
+      for (l = g_queue_peek_tail_link (&display->queued_events); l != first->prev; l = l->prev)
+        {
+          GdkEvent *event = l->data;
+          GdkEventSequence *sequence = gdk_event_get_event_sequence (event);
+
+          if (!g_hash_table_contains (last_updates, sequence))
+            g_hash_table_insert (last_updates, sequence, l);
+        }
+
+      /* Walk forward so the history ends up in time order */
+      l = first;
+      while (l != NULL)
+        {
+          GdkEvent *event = l->data;
+          GList *next = l->next;
+          GList *last;
+
+          last = g_hash_table_lookup (last_updates, gdk_event_get_event_sequence (event));
+          if (last != l)
+            {
+              gdk_touch_event_push_history (last->data, event);
+
+              if (first == l)
+                first = next;
+
+              gdk_event_unref (event);
+              g_queue_delete_link (&display->queued_events, l);
+            }
+
+          l = next;
+        }
+
+      g_hash_table_unref (last_updates);
+    }
+
+  if (g_queue_get_length (&display->queued_events) == 1 &&
+      g_queue_peek_head_link (&display->queued_events) == first)
+    {
+      GdkFrameClock *clock = gdk_surface_get_frame_clock (surface);
+      if (clock) /* might be NULL if surface was destroyed */
+        gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS);
+    }
+}
+
 void
 _gdk_event_queue_flush (GdkDisplay *display)
 {
@@ -1859,6 +2071,8 @@ gdk_touch_event_finalize (GdkEvent *event)
   GdkTouchEvent *self = (GdkTouchEvent *) event;
 
   g_clear_pointer (&self->axes, g_free);
+  if (self->history)
+    g_array_free (self->history, TRUE);
 
   GDK_EVENT_SUPER (event)->finalize (event);
 }
@@ -2859,7 +3073,7 @@ gdk_motion_event_new (GdkSurface      *surface,
 
 /**
  * gdk_event_get_history:
- * @event: a motion or scroll #GdkEvent
+ * @event: a motion, scroll or touch #GdkEvent
  * @out_n_coords: (out): Return location for the length of the returned array
  *
  * Retrieves the history of the @event, as a list of time and coordinates.
@@ -2867,8 +3081,9 @@ gdk_motion_event_new (GdkSurface      *surface,
  * The history includes events that are not delivered to the application
  * because they occurred in the same frame as @event.
  *
- * Note that only motion and scroll events record history, and motion
- * events only if one of the mouse buttons is down.
+ * Note that only motion, scroll and touch update events record history,
+ * and motion events only if one of the mouse buttons is down or input
+ * batching is enabled for the surface, see gdk_surface_set_input_batching().
  *
  * Returns: (transfer container) (array length=out_n_coords) (nullable): an
  *   array of time and coordinates
@@ -2881,7 +3096,11 @@ gdk_event_get_history (GdkEvent *event,
 
   g_return_val_if_fail (GDK_IS_EVENT (event), NULL);
   g_return_val_if_fail (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY) ||
-                        GDK_IS_EVENT_TYPE (event, GDK_SCROLL), NULL);
+                        GDK_IS_EVENT_TYPE (event, GDK_SCROLL) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_BEGIN) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_END) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_CANCEL), NULL);
   g_return_val_if_fail (out_n_coords != NULL, NULL);
 
   if (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY))
@@ -2889,11 +3108,16 @@ gdk_event_get_history (GdkEvent *event,
       GdkMotionEvent *self = (GdkMotionEvent *) event;
       history = self->history;
     }
-  else
+  else if (GDK_IS_EVENT_TYPE (event, GDK_SCROLL))
     {
       GdkScrollEvent *self = (GdkScrollEvent *) event;
       history = self->history;
     }
+  else
+    {
+      GdkTouchEvent *self = (GdkTouchEvent *) event;
+      history = self->history;
+    }
 
   if (history && history->len > 0)
     {
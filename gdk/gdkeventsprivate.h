@@ -192,6 +192,7 @@ struct _GdkTouchEvent
   GdkEventSequence *sequence;
   gboolean touch_emulating;
   gboolean pointer_emulated;
+  GArray *history; /* <GdkTimeCoord> */
 };
 
 /*
@@ -601,6 +602,7 @@ GList* _gdk_event_queue_append       (GdkDisplay *display,
 
 void    _gdk_event_queue_handle_motion_compression (GdkDisplay *display);
 void    gdk_event_queue_handle_scroll_compression  (GdkDisplay *display);
+void    gdk_event_queue_handle_touch_compression   (GdkDisplay *display);
 void    _gdk_event_queue_flush                     (GdkDisplay       *display);
 
 double * gdk_event_dup_axes (GdkEvent *event);
@@ -27,6 +27,9 @@
 #include "gdkframeclockprivate.h"
 #include "gdkinternals.h"
 
+#include <math.h>
+#include <string.h>
+
 /**
  * SECTION:gdkframeclock
  * @Title: GdkFrameClock
@@ -89,15 +92,35 @@ static guint signals[LAST_SIGNAL];
 
 static guint fps_counter;
 
-#define FRAME_HISTORY_MAX_LENGTH 16
+#define FRAME_HISTORY_DEFAULT_LENGTH 16
+
+/* Phase durations are kept in a log-linear histogram: every power of two
+ * is split into 4 linear sub-buckets, so the relative error of a reported
+ * percentile is at most 25%. The last bucket collects everything from
+ * roughly 33 seconds up.
+ */
+#define PHASE_HISTOGRAM_SUB_BUCKET_BITS 2
+#define PHASE_HISTOGRAM_SUB_BUCKETS (1 << PHASE_HISTOGRAM_SUB_BUCKET_BITS)
+#define PHASE_HISTOGRAM_N_BUCKETS (PHASE_HISTOGRAM_SUB_BUCKETS * 25)
+#define N_PHASES 7
+
+typedef struct
+{
+  guint64 count;
+  gint64 max;
+  guint32 buckets[PHASE_HISTOGRAM_N_BUCKETS];
+} PhaseHistogram;
 
 struct _GdkFrameClockPrivate
 {
   gint64 frame_counter;
   int n_timings;
   int current;
-  GdkFrameTimings *timings[FRAME_HISTORY_MAX_LENGTH];
+  int history_length;
+  GdkFrameTimings **timings;
   int n_freeze_inhibitors;
+
+  PhaseHistogram phases[N_PHASES];
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GdkFrameClock, gdk_frame_clock, G_TYPE_OBJECT)
@@ -111,10 +134,12 @@ gdk_frame_clock_finalize (GObject *object)
   GdkFrameClockPrivate *priv = GDK_FRAME_CLOCK (object)->priv;
   int i;
 
-  for (i = 0; i < FRAME_HISTORY_MAX_LENGTH; i++)
+  for (i = 0; i < priv->history_length; i++)
     if (priv->timings[i] != 0)
       gdk_frame_timings_unref (priv->timings[i]);
 
+  g_free (priv->timings);
+
   G_OBJECT_CLASS (gdk_frame_clock_parent_class)->finalize (object);
 }
 
@@ -259,7 +284,9 @@ gdk_frame_clock_init (GdkFrameClock *clock)
   clock->priv = priv = gdk_frame_clock_get_instance_private (clock);
 
   priv->frame_counter = -1;
-  priv->current = FRAME_HISTORY_MAX_LENGTH - 1;
+  priv->history_length = FRAME_HISTORY_DEFAULT_LENGTH;
+  priv->timings = g_new0 (GdkFrameTimings *, priv->history_length);
+  priv->current = priv->history_length - 1;
 
   if (fps_counter == 0)
     fps_counter = gdk_profiler_define_counter ("fps", "Frames per Second");
@@ -442,6 +469,75 @@ gdk_frame_clock_get_history_start (GdkFrameClock *frame_clock)
   return priv->frame_counter + 1 - priv->n_timings;
 }
 
+/**
+ * gdk_frame_clock_set_history_length:
+ * @frame_clock: a #GdkFrameClock
+ * @history_length: the number of frames to keep timings for
+ *
+ * Sets how many #GdkFrameTimings objects @frame_clock keeps in its
+ * frame history. The default is 16 frames, which is enough to compute
+ * the current frame rate; longer histories are useful to analyze
+ * stutters after the fact.
+ *
+ * When the history is shortened, the timings of the oldest frames
+ * are discarded.
+ */
+void
+gdk_frame_clock_set_history_length (GdkFrameClock *frame_clock,
+                                    guint          history_length)
+{
+  GdkFrameClockPrivate *priv;
+  GdkFrameTimings **timings;
+  int i, n_kept;
+
+  g_return_if_fail (GDK_IS_FRAME_CLOCK (frame_clock));
+  g_return_if_fail (history_length > 0 && history_length <= G_MAXINT);
+
+  priv = frame_clock->priv;
+
+  if (priv->history_length == (int) history_length)
+    return;
+
+  timings = g_new0 (GdkFrameTimings *, history_length);
+  n_kept = MIN (priv->n_timings, (int) history_length);
+
+  /* Walk the ring from the newest frame backwards, so that the frames
+   * we keep end up in order at the start of the new ring.
+   */
+  for (i = 0; i < priv->n_timings; i++)
+    {
+      int pos = (priv->current - i + priv->history_length) % priv->history_length;
+
+      if (i < n_kept)
+        timings[n_kept - 1 - i] = priv->timings[pos];
+      else
+        gdk_frame_timings_unref (priv->timings[pos]);
+    }
+
+  g_free (priv->timings);
+  priv->timings = timings;
+  priv->history_length = history_length;
+  priv->n_timings = n_kept;
+  priv->current = n_kept > 0 ? n_kept - 1 : history_length - 1;
+}
+
+/**
+ * gdk_frame_clock_get_history_length:
+ * @frame_clock: a #GdkFrameClock
+ *
+ * Gets the maximum number of frames kept in the frame history
+ * of @frame_clock. See gdk_frame_clock_set_history_length().
+ *
+ * Returns: the length of the frame history
+ */
+guint
+gdk_frame_clock_get_history_length (GdkFrameClock *frame_clock)
+{
+  g_return_val_if_fail (GDK_IS_FRAME_CLOCK (frame_clock), 0);
+
+  return frame_clock->priv->history_length;
+}
+
 void
 _gdk_frame_clock_begin_frame (GdkFrameClock *frame_clock)
 {
@@ -452,17 +548,17 @@ _gdk_frame_clock_begin_frame (GdkFrameClock *frame_clock)
   priv = frame_clock->priv;
 
   priv->frame_counter++;
-  priv->current = (priv->current + 1) % FRAME_HISTORY_MAX_LENGTH;
+  priv->current = (priv->current + 1) % priv->history_length;
 
   /* Try to steal the previous frame timing instead of discarding
    * and allocating a new one.
    */
-  if G_LIKELY (priv->n_timings == FRAME_HISTORY_MAX_LENGTH &&
+  if G_LIKELY (priv->n_timings == priv->history_length &&
                _gdk_frame_timings_steal (priv->timings[priv->current],
                                          priv->frame_counter))
     return;
 
-  if (priv->n_timings < FRAME_HISTORY_MAX_LENGTH)
+  if (priv->n_timings < priv->history_length)
     priv->n_timings++;
   else
     gdk_frame_timings_unref (priv->timings[priv->current]);
@@ -501,7 +597,7 @@ gdk_frame_clock_get_timings (GdkFrameClock *frame_clock,
   if (frame_counter <= priv->frame_counter - priv->n_timings)
     return NULL;
 
-  pos = (priv->current - (priv->frame_counter - frame_counter) + FRAME_HISTORY_MAX_LENGTH) % FRAME_HISTORY_MAX_LENGTH;
+  pos = (priv->current - (priv->frame_counter - frame_counter) + priv->history_length) % priv->history_length;
 
   return priv->timings[pos];
 }
@@ -797,6 +893,152 @@ gdk_frame_clock_get_fps (GdkFrameClock *frame_clock)
   return ((double) end_counter - start_counter) * G_USEC_PER_SEC / (end_timestamp - start_timestamp);
 }
 
+static guint
+phase_histogram_bucket (gint64 duration)
+{
+  guint msb, sub, bucket;
+
+  if (duration < PHASE_HISTOGRAM_SUB_BUCKETS)
+    return MAX (duration, 0);
+
+  msb = g_bit_storage ((gulong) duration) - 1;
+  sub = (duration >> (msb - PHASE_HISTOGRAM_SUB_BUCKET_BITS)) & (PHASE_HISTOGRAM_SUB_BUCKETS - 1);
+  bucket = (msb - PHASE_HISTOGRAM_SUB_BUCKET_BITS + 1) * PHASE_HISTOGRAM_SUB_BUCKETS + sub;
+
+  return MIN (bucket, PHASE_HISTOGRAM_N_BUCKETS - 1);
+}
+
+/* The largest duration that ends up in @bucket */
+static gint64
+phase_histogram_bucket_limit (guint bucket)
+{
+  guint msb, sub;
+
+  if (bucket < PHASE_HISTOGRAM_SUB_BUCKETS)
+    return bucket;
+
+  msb = bucket / PHASE_HISTOGRAM_SUB_BUCKETS + PHASE_HISTOGRAM_SUB_BUCKET_BITS - 1;
+  sub = bucket % PHASE_HISTOGRAM_SUB_BUCKETS;
+
+  return ((gint64) (PHASE_HISTOGRAM_SUB_BUCKETS + sub + 1) << (msb - PHASE_HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+}
+
+static PhaseHistogram *
+get_phase_histogram (GdkFrameClock      *frame_clock,
+                     GdkFrameClockPhase  phase)
+{
+  int idx = g_bit_nth_lsf (phase, -1);
+
+  g_assert (idx >= 0 && idx < N_PHASES);
+
+  return &frame_clock->priv->phases[idx];
+}
+
+void
+_gdk_frame_clock_add_phase_duration (GdkFrameClock      *frame_clock,
+                                     GdkFrameClockPhase  phase,
+                                     gint64              duration)
+{
+  PhaseHistogram *histogram = get_phase_histogram (frame_clock, phase);
+  guint bucket = phase_histogram_bucket (duration);
+
+  /* Saturate rather than wrap in sessions that run for months */
+  if G_UNLIKELY (histogram->buckets[bucket] == G_MAXUINT32)
+    return;
+
+  histogram->buckets[bucket]++;
+  histogram->count++;
+  histogram->max = MAX (histogram->max, duration);
+}
+
+#define IS_SINGLE_PHASE(phase) ((phase) != 0 && ((phase) & ((phase) - 1)) == 0 && \
+                                (phase) <= GDK_FRAME_CLOCK_PHASE_AFTER_PAINT)
+
+/**
+ * gdk_frame_clock_get_phase_count:
+ * @frame_clock: a #GdkFrameClock
+ * @phase: a single #GdkFrameClockPhase
+ *
+ * Gets the number of frames in which @phase was run and its
+ * duration was recorded since the frame clock was created or
+ * gdk_frame_clock_reset_phase_statistics() was last called.
+ *
+ * Returns: the number of recorded durations for @phase
+ */
+guint64
+gdk_frame_clock_get_phase_count (GdkFrameClock      *frame_clock,
+                                 GdkFrameClockPhase  phase)
+{
+  g_return_val_if_fail (GDK_IS_FRAME_CLOCK (frame_clock), 0);
+  g_return_val_if_fail (IS_SINGLE_PHASE (phase), 0);
+
+  return get_phase_histogram (frame_clock, phase)->count;
+}
+
+/**
+ * gdk_frame_clock_get_phase_percentile:
+ * @frame_clock: a #GdkFrameClock
+ * @phase: a single #GdkFrameClockPhase
+ * @percentile: the percentile to query, between 0 and 100
+ *
+ * Estimates the duration that @percentile percent of all recorded
+ * runs of @phase did not exceed. For example, a @percentile of 99
+ * returns the p99 latency of the phase.
+ *
+ * Durations are accumulated in a histogram by the frame clock, so
+ * this is cheap to call and the value is exact to within 25%. A
+ * @percentile of 100 returns the exact maximum.
+ *
+ * Returns: the duration in microseconds, or 0 if no durations
+ *   have been recorded for @phase
+ */
+gint64
+gdk_frame_clock_get_phase_percentile (GdkFrameClock      *frame_clock,
+                                      GdkFrameClockPhase  phase,
+                                      double              percentile)
+{
+  PhaseHistogram *histogram;
+  guint64 rank, seen;
+  guint i;
+
+  g_return_val_if_fail (GDK_IS_FRAME_CLOCK (frame_clock), 0);
+  g_return_val_if_fail (IS_SINGLE_PHASE (phase), 0);
+  g_return_val_if_fail (percentile >= 0.0 && percentile <= 100.0, 0);
+
+  histogram = get_phase_histogram (frame_clock, phase);
+  if (histogram->count == 0)
+    return 0;
+
+  if (percentile >= 100.0)
+    return histogram->max;
+
+  rank = MAX (1, (guint64) ceil (histogram->count * percentile / 100.0));
+  seen = 0;
+  for (i = 0; i < PHASE_HISTOGRAM_N_BUCKETS; i++)
+    {
+      seen += histogram->buckets[i];
+      if (seen >= rank)
+        return MIN (phase_histogram_bucket_limit (i), histogram->max);
+    }
+
+  return histogram->max;
+}
+
+/**
+ * gdk_frame_clock_reset_phase_statistics:
+ * @frame_clock: a #GdkFrameClock
+ *
+ * Discards all phase durations recorded so far, see
+ * gdk_frame_clock_get_phase_percentile().
+ */
+void
+gdk_frame_clock_reset_phase_statistics (GdkFrameClock *frame_clock)
+{
+  g_return_if_fail (GDK_IS_FRAME_CLOCK (frame_clock));
+
+  memset (frame_clock->priv->phases, 0, sizeof (frame_clock->priv->phases));
+}
+
 void
 _gdk_frame_clock_add_timings_to_profiler (GdkFrameClock   *clock,
                                           GdkFrameTimings *timings)
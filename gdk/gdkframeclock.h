@@ -93,6 +93,11 @@ gint64           gdk_frame_clock_get_history_start (GdkFrameClock *frame_clock);
 GDK_AVAILABLE_IN_ALL
 GdkFrameTimings *gdk_frame_clock_get_timings       (GdkFrameClock *frame_clock,
                                                     gint64         frame_counter);
+GDK_AVAILABLE_IN_ALL
+void             gdk_frame_clock_set_history_length (GdkFrameClock *frame_clock,
+                                                     guint          history_length);
+GDK_AVAILABLE_IN_ALL
+guint            gdk_frame_clock_get_history_length (GdkFrameClock *frame_clock);
 
 GDK_AVAILABLE_IN_ALL
 GdkFrameTimings *gdk_frame_clock_get_current_timings (GdkFrameClock *frame_clock);
@@ -106,6 +111,17 @@ void gdk_frame_clock_get_refresh_info (GdkFrameClock *frame_clock,
 GDK_AVAILABLE_IN_ALL
 double gdk_frame_clock_get_fps (GdkFrameClock *frame_clock);
 
+/* Phase statistics */
+GDK_AVAILABLE_IN_ALL
+guint64 gdk_frame_clock_get_phase_count        (GdkFrameClock      *frame_clock,
+                                                GdkFrameClockPhase  phase);
+GDK_AVAILABLE_IN_ALL
+gint64  gdk_frame_clock_get_phase_percentile   (GdkFrameClock      *frame_clock,
+                                                GdkFrameClockPhase  phase,
+                                                double              percentile);
+GDK_AVAILABLE_IN_ALL
+void    gdk_frame_clock_reset_phase_statistics (GdkFrameClock      *frame_clock);
+
 G_END_DECLS
 
 #endif /* __GDK_FRAME_CLOCK_H__ */
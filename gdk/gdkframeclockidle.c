@@ -37,6 +37,9 @@
 
 #define FRAME_INTERVAL 16667 /* microseconds */
 
+#define PREDICT_MIN_DEADLINE_OFFSET 1000 /* microseconds */
+#define PREDICT_DEADLINE_STEP 100 /* microseconds */
+
 typedef enum {
   SMOOTH_PHASE_STATE_VALID = 0,    /* explicit, since we count on zero-init */
   SMOOTH_PHASE_STATE_AWAIT_FIRST,
@@ -67,8 +70,15 @@ struct _GdkFrameClockIdlePrivate
   GdkFrameClockPhase requested;
   GdkFrameClockPhase phase;
 
+  /* Predictive scheduling, see compute_predicted_frame_start() */
+  gint64 frame_duration_estimate;      /* A peak-tracking estimate of how long a frame cycle takes */
+  gint64 deadline_offset;              /* How long before the presentation time a frame needs to be finished */
+  gint64 last_checked_frame;           /* The last frame whose presentation feedback was evaluated */
+  gint64 target_presentation_time;     /* The presentation time the next frame was scheduled for, or 0 */
+
   guint in_paint_idle : 1;
   guint paint_is_thaw : 1;
+  guint predictive : 1;
 #ifdef G_OS_WIN32
   guint begin_period : 1;
 #endif
@@ -141,6 +151,8 @@ gdk_frame_clock_idle_init (GdkFrameClockIdle *frame_clock_idle)
 
   priv->freeze_count = 0;
   priv->smoothed_frame_time_period = FRAME_INTERVAL;
+  priv->deadline_offset = FRAME_INTERVAL;
+  priv->predictive = (gdk_display_get_debug_flags (NULL) & GDK_DEBUG_FRAME_PREDICT) != 0;
 }
 
 static void
@@ -241,6 +253,87 @@ compute_smooth_frame_time (GdkFrameClock *clock,
   return new_smoothed_time;
 }
 
+static void
+update_frame_duration_estimate (GdkFrameClockIdlePrivate *priv,
+                                gint64                    duration)
+{
+  /* Follow spikes immediately, but only slowly forget about them,
+   * so a single fast frame doesn't make us miss the next deadline.
+   */
+  if (duration > priv->frame_duration_estimate)
+    priv->frame_duration_estimate = duration;
+  else
+    priv->frame_duration_estimate -= (priv->frame_duration_estimate - duration) / 16;
+}
+
+/* Adjusts the deadline offset based on whether the frames we scheduled
+ * predictively were presented when we aimed for. Missing a presentation
+ * backs off by a quarter frame, hitting it moves the deadline closer to
+ * the presentation in small steps, so we converge on the latest start
+ * time the compositor still accepts.
+ */
+static void
+update_deadline_offset (GdkFrameClock *clock)
+{
+  GdkFrameClockIdlePrivate *priv = GDK_FRAME_CLOCK_IDLE (clock)->priv;
+  gint64 frame_counter;
+
+  frame_counter = MAX (priv->last_checked_frame + 1,
+                       gdk_frame_clock_get_history_start (clock));
+
+  for (; frame_counter <= gdk_frame_clock_get_frame_counter (clock); frame_counter++)
+    {
+      GdkFrameTimings *timings = gdk_frame_clock_get_timings (clock, frame_counter);
+      gint64 refresh_interval;
+
+      if (timings == NULL || !timings->complete)
+        break;
+
+      priv->last_checked_frame = frame_counter;
+
+      if (timings->target_presentation_time == 0 || timings->presentation_time == 0)
+        continue;
+
+      refresh_interval = timings->refresh_interval ? timings->refresh_interval : FRAME_INTERVAL;
+
+      if (timings->presentation_time > timings->target_presentation_time + refresh_interval / 2)
+        priv->deadline_offset = MIN (priv->deadline_offset + refresh_interval / 4,
+                                     2 * refresh_interval);
+      else
+        priv->deadline_offset = MAX (priv->deadline_offset - PREDICT_DEADLINE_STEP,
+                                     PREDICT_MIN_DEADLINE_OFFSET);
+    }
+}
+
+/* Returns the time at which the next frame should start so that it is
+ * finished just before the compositor needs it for the next possible
+ * presentation, or 0 if we don't have enough information to predict it.
+ */
+static gint64
+compute_predicted_frame_start (GdkFrameClock *clock,
+                               gint64        *target_presentation_time)
+{
+  GdkFrameClockIdlePrivate *priv = GDK_FRAME_CLOCK_IDLE (clock)->priv;
+  gint64 now, budget, presentation_time, refresh_interval;
+
+  if (!priv->predictive || priv->frame_duration_estimate == 0)
+    return 0;
+
+  update_deadline_offset (clock);
+
+  now = g_get_monotonic_time ();
+  budget = priv->frame_duration_estimate + priv->deadline_offset;
+
+  gdk_frame_clock_get_refresh_info (clock, now + budget,
+                                    &refresh_interval, &presentation_time);
+  if (presentation_time == 0)
+    return 0;
+
+  *target_presentation_time = presentation_time;
+
+  return MAX (presentation_time - budget, now);
+}
+
 static gint64
 gdk_frame_clock_idle_get_frame_time (GdkFrameClock *clock)
 {
@@ -344,6 +437,7 @@ maybe_stop_idle (GdkFrameClockIdle *clock_idle)
     {
       g_source_remove (priv->paint_idle_id);
       priv->paint_idle_id = 0;
+      priv->target_presentation_time = 0;
     }
 }
 
@@ -353,6 +447,7 @@ gdk_frame_clock_flush_idle (void *data)
   GdkFrameClock *clock = GDK_FRAME_CLOCK (data);
   GdkFrameClockIdle *clock_idle = GDK_FRAME_CLOCK_IDLE (clock);
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 phase_start;
 
   priv->flush_idle_id = 0;
 
@@ -362,7 +457,10 @@ gdk_frame_clock_flush_idle (void *data)
   priv->phase = GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS;
   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS;
 
+  phase_start = g_get_monotonic_time ();
   _gdk_frame_clock_emit_flush_events (clock);
+  _gdk_frame_clock_add_phase_duration (clock, GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS,
+                                       g_get_monotonic_time () - phase_start);
 
   if ((priv->requested & ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS) != 0 ||
       priv->updating_count > 0)
@@ -400,6 +498,7 @@ gdk_frame_clock_paint_idle (void *data)
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gboolean skip_to_resume_events;
   GdkFrameTimings *timings = NULL;
+  gint64 phase_start;
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
@@ -526,6 +625,8 @@ gdk_frame_clock_paint_idle (void *data)
               timings->frame_time = priv->frame_time;
               timings->smoothed_frame_time = priv->smoothed_frame_time_base;
               timings->slept_before = priv->sleep_serial != get_sleep_serial ();
+              timings->target_presentation_time = priv->target_presentation_time;
+              priv->target_presentation_time = 0;
 
               priv->phase = GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
 
@@ -535,7 +636,10 @@ gdk_frame_clock_paint_idle (void *data)
                * in them.
                */
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
+              phase_start = g_get_monotonic_time ();
               _gdk_frame_clock_emit_before_paint (clock);
+              _gdk_frame_clock_add_phase_duration (clock, GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT,
+                                                   g_get_monotonic_time () - phase_start);
               priv->phase = GDK_FRAME_CLOCK_PHASE_UPDATE;
             }
           G_GNUC_FALLTHROUGH;
@@ -547,7 +651,10 @@ gdk_frame_clock_paint_idle (void *data)
                   priv->updating_count > 0)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_UPDATE;
+                  phase_start = g_get_monotonic_time ();
                   _gdk_frame_clock_emit_update (clock);
+                  _gdk_frame_clock_add_phase_duration (clock, GDK_FRAME_CLOCK_PHASE_UPDATE,
+                                                       g_get_monotonic_time () - phase_start);
                 }
             }
           G_GNUC_FALLTHROUGH;
@@ -572,12 +679,17 @@ gdk_frame_clock_paint_idle (void *data)
 	       * resizes and natural size changes.
 	       */
 	      iter = 0;
+              phase_start = g_get_monotonic_time ();
               while ((priv->requested & GDK_FRAME_CLOCK_PHASE_LAYOUT) &&
 		     priv->freeze_count == 0 && iter++ < 4)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_LAYOUT;
                   _gdk_frame_clock_emit_layout (clock);
                 }
+              /* All layout iterations of a frame count as one sample */
+              if (iter > 0)
+                _gdk_frame_clock_add_phase_duration (clock, GDK_FRAME_CLOCK_PHASE_LAYOUT,
+                                                     g_get_monotonic_time () - phase_start);
 	      if (iter == 5)
 		g_warning ("gdk-frame-clock: layout continuously requested, giving up after 4 tries");
             }
@@ -599,7 +711,10 @@ gdk_frame_clock_paint_idle (void *data)
               if (priv->requested & GDK_FRAME_CLOCK_PHASE_PAINT)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_PAINT;
+                  phase_start = g_get_monotonic_time ();
                   _gdk_frame_clock_emit_paint (clock);
+                  _gdk_frame_clock_add_phase_duration (clock, GDK_FRAME_CLOCK_PHASE_PAINT,
+                                                       g_get_monotonic_time () - phase_start);
                 }
             }
           G_GNUC_FALLTHROUGH;
@@ -608,15 +723,20 @@ gdk_frame_clock_paint_idle (void *data)
           if (priv->freeze_count == 0)
             {
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_AFTER_PAINT;
+              phase_start = g_get_monotonic_time ();
               _gdk_frame_clock_emit_after_paint (clock);
+              _gdk_frame_clock_add_phase_duration (clock, GDK_FRAME_CLOCK_PHASE_AFTER_PAINT,
+                                                   g_get_monotonic_time () - phase_start);
               /* the ::after-paint phase doesn't get repeated on freeze/thaw,
                */
               priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
+
+              if (timings)
+                {
+                  timings->frame_end_time = g_get_monotonic_time ();
+                  update_frame_duration_estimate (priv, timings->frame_end_time - timings->frame_time);
+                }
             }
-#ifdef G_ENABLE_DEBUG
-            if (GDK_DEBUG_CHECK (FRAMES))
-              timings->frame_end_time = g_get_monotonic_time ();
-#endif /* G_ENABLE_DEBUG */
           G_GNUC_FALLTHROUGH;
 
         case GDK_FRAME_CLOCK_PHASE_RESUME_EVENTS:
@@ -653,9 +773,19 @@ gdk_frame_clock_paint_idle (void *data)
        * receiving "frame drawn" events shortly after losing them, then we should still be in sync.
        */
       gint64 smooth_cycle_start = priv->smoothed_frame_time_base - priv->smoothed_frame_time_phase;
-      priv->min_next_frame_time = smooth_cycle_start + priv->smoothed_frame_time_period;
+      gint64 predicted_start = compute_predicted_frame_start (clock, &priv->target_presentation_time);
+
+      if (predicted_start != 0)
+        priv->min_next_frame_time = predicted_start;
+      else
+        priv->min_next_frame_time = smooth_cycle_start + priv->smoothed_frame_time_period;
 
       maybe_start_idle (clock_idle, FALSE);
+      /* Only a frame that is actually scheduled aims for the target.
+       * The next one may start long after it, when the clock was idle.
+       */
+      if (priv->paint_idle_id == 0)
+        priv->target_presentation_time = 0;
     }
 
   if (priv->freeze_count == 0)
@@ -753,13 +883,29 @@ gdk_frame_clock_idle_thaw (GdkFrameClock *clock)
   priv->freeze_count--;
   if (priv->freeze_count == 0)
     {
+      /* The backend unthrottled us, which usually happens right after
+       * a presentation. Instead of starting the next frame right away,
+       * start it as late as we can while still making the next one.
+       */
+      if (priv->predictive)
+        {
+          gint64 predicted_start = compute_predicted_frame_start (clock, &priv->target_presentation_time);
+
+          /* Without a prediction, keep the time the last cycle computed */
+          if (predicted_start != 0)
+            priv->min_next_frame_time = predicted_start;
+        }
+
       maybe_start_idle (clock_idle, TRUE);
       /* If nothing is requested so we didn't start an idle, we need
        * to skip to the end of the state chain, since the idle won't
        * run and do it for us.
        */
       if (priv->paint_idle_id == 0)
-        priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
+        {
+          priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
+          priv->target_presentation_time = 0;
+        }
 
       priv->sleep_serial = get_sleep_serial ();
 
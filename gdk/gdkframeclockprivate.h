@@ -95,11 +95,12 @@ struct _GdkFrameTimings
   gint64 presentation_time;
   gint64 refresh_interval;
   gint64 predicted_presentation_time;
+  gint64 frame_end_time;
+  gint64 target_presentation_time;
 
 #ifdef G_ENABLE_DEBUG
   gint64 layout_start_time;
   gint64 paint_start_time;
-  gint64 frame_end_time;
 #endif /* G_ENABLE_DEBUG */
 
   guint complete : 1;
@@ -114,6 +115,9 @@ void _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
                                            GdkFrameTimings *timings);
 void _gdk_frame_clock_add_timings_to_profiler (GdkFrameClock *frame_clock,
                                                GdkFrameTimings *timings);
+void _gdk_frame_clock_add_phase_duration (GdkFrameClock      *frame_clock,
+                                          GdkFrameClockPhase  phase,
+                                          gint64              duration);
 
 GdkFrameTimings *_gdk_frame_timings_new   (gint64           frame_counter);
 gboolean         _gdk_frame_timings_steal (GdkFrameTimings *timings,
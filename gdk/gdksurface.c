@@ -2068,6 +2068,52 @@ gdk_surface_get_root_coords (GdkSurface *surface,
   GDK_SURFACE_GET_CLASS (surface)->get_root_coords (surface, x, y, root_x, root_y);
 }
 
+/**
+ * gdk_surface_set_input_batching:
+ * @surface: a #GdkSurface
+ * @batching: %TRUE to deliver high-frequency input once per frame
+ *
+ * Sets whether high-frequency input for @surface is batched per frame.
+ *
+ * By default, only motion events are held back until the next frame
+ * and compressed, while touch updates and smooth scroll events are
+ * delivered as soon as they arrive, unless several of them are already
+ * queued together.
+ *
+ * With batching enabled, touch updates and smooth scroll events are
+ * held back and compressed the same way, and every compressed event
+ * carries the complete history of the events it replaces, including
+ * motion events with no button pressed. Use gdk_event_get_history()
+ * to retrieve it. This is useful for drawing applications that want
+ * full-rate stylus and touch input without paying the cost of
+ * dispatching every event.
+ */
+void
+gdk_surface_set_input_batching (GdkSurface *surface,
+                                gboolean    batching)
+{
+  g_return_if_fail (GDK_IS_SURFACE (surface));
+
+  surface->input_batching = !!batching;
+}
+
+/**
+ * gdk_surface_get_input_batching:
+ * @surface: a #GdkSurface
+ *
+ * Gets whether input batching is enabled for @surface.
+ * See gdk_surface_set_input_batching().
+ *
+ * Returns: %TRUE if input for @surface is batched per frame
+ */
+gboolean
+gdk_surface_get_input_batching (GdkSurface *surface)
+{
+  g_return_val_if_fail (GDK_IS_SURFACE (surface), FALSE);
+
+  return surface->input_batching;
+}
+
 /**
  * gdk_surface_set_input_region:
  * @surface: a #GdkSurface
@@ -2289,6 +2335,7 @@ _gdk_windowing_got_event (GdkDisplay *display,
    */
   _gdk_event_queue_handle_motion_compression (display);
   gdk_event_queue_handle_scroll_compression (display);
+  gdk_event_queue_handle_touch_compression (display);
 }
 
 /**
@@ -124,6 +124,12 @@ void       gdk_surface_request_layout     (GdkSurface       *surface);
 GDK_AVAILABLE_IN_ALL
 GdkFrameClock* gdk_surface_get_frame_clock      (GdkSurface     *surface);
 
+GDK_AVAILABLE_IN_ALL
+void       gdk_surface_set_input_batching       (GdkSurface     *surface,
+                                                 gboolean        batching);
+GDK_AVAILABLE_IN_ALL
+gboolean   gdk_surface_get_input_batching       (GdkSurface     *surface);
+
 GDK_AVAILABLE_IN_ALL
 void       gdk_surface_set_opaque_region        (GdkSurface      *surface,
                                                  cairo_region_t *region);
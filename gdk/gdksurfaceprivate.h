@@ -79,6 +79,7 @@ struct _GdkSurface
   guint autohide : 1;
   guint shortcuts_inhibited : 1;
   guint request_motion : 1;
+  guint input_batching : 1;
 
   guint request_motion_id;
 
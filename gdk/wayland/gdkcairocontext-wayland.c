@@ -85,10 +85,24 @@ gdk_wayland_cairo_context_remove_surface (GdkWaylandCairoContext *self,
 {
   self->surfaces = g_slist_remove (self->surfaces, surface);
 
+  if (self->presented_surface == surface)
+    self->presented_surface = NULL;
+
   cairo_surface_set_user_data (surface, &gdk_wayland_cairo_context_key, NULL, NULL);
   cairo_surface_destroy (surface);
 }
 
+static gboolean
+gdk_wayland_cairo_context_surface_has_current_size (GdkWaylandCairoContext *self,
+                                                    cairo_surface_t        *cairo_surface)
+{
+  GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
+  int scale = gdk_surface_get_scale_factor (surface);
+
+  return cairo_image_surface_get_width (cairo_surface) == gdk_surface_get_width (surface) * scale &&
+         cairo_image_surface_get_height (cairo_surface) == gdk_surface_get_height (surface) * scale;
+}
+
 static void
 gdk_wayland_cairo_context_buffer_release (void             *_data,
                                           struct wl_buffer *wl_buffer)
@@ -100,8 +114,11 @@ gdk_wayland_cairo_context_buffer_release (void             *_data,
   if (self == NULL)
     return;
 
-  /* Cache one surface for reuse when drawing */
-  if (self->cached_surface == NULL)
+  /* Cache one surface for reuse when drawing, unless it is
+   * left over from before a resize
+   */
+  if (self->cached_surface == NULL &&
+      gdk_wayland_cairo_context_surface_has_current_size (self, cairo_surface))
     {
       self->cached_surface = cairo_surface;
       return;
@@ -127,9 +144,11 @@ gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
 
   width = gdk_surface_get_width (surface);
   height = gdk_surface_get_height (surface);
-  cairo_surface = _gdk_wayland_display_create_shm_surface (display_wayland,
-                                                           width, height,
-                                                           gdk_surface_get_scale_factor (surface));
+  if (self->pool == NULL)
+    self->pool = _gdk_wayland_shm_pool_new (display_wayland);
+  cairo_surface = _gdk_wayland_shm_pool_create_surface (self->pool,
+                                                        width, height,
+                                                        gdk_surface_get_scale_factor (surface));
   buffer = _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface);
   wl_buffer_add_listener (buffer, &buffer_listener, cairo_surface);
   gdk_wayland_cairo_context_add_surface (self, cairo_surface);
@@ -155,9 +174,38 @@ gdk_wayland_cairo_context_begin_frame (GdkDrawContext *draw_context,
   else
     self->paint_surface = gdk_wayland_cairo_context_create_surface (self);
 
+  cr = cairo_create (self->paint_surface);
+
   surface_region = gdk_wayland_cairo_context_surface_get_region (self->paint_surface);
   if (surface_region)
-    cairo_region_union (region, surface_region);
+    {
+      if (self->presented_surface &&
+          self->presented_surface != self->paint_surface &&
+          gdk_wayland_cairo_context_surface_has_current_size (self, self->presented_surface))
+        {
+          cairo_region_t *copy;
+
+          /* The last presented buffer is up to date outside of the
+           * repaint area, so copy the parts of it that this buffer
+           * missed instead of redrawing them.
+           */
+          copy = cairo_region_copy (surface_region);
+          cairo_region_subtract (copy, region);
+
+          cairo_save (cr);
+          cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+          cairo_set_source_surface (cr, self->presented_surface, 0, 0);
+          gdk_cairo_region (cr, copy);
+          cairo_fill (cr);
+          cairo_restore (cr);
+
+          cairo_region_destroy (copy);
+        }
+      else
+        {
+          cairo_region_union (region, surface_region);
+        }
+    }
 
   for (l = self->surfaces; l; l = l->next)
     {
@@ -165,7 +213,6 @@ gdk_wayland_cairo_context_begin_frame (GdkDrawContext *draw_context,
     }
 
   /* clear the repaint area */
-  cr = cairo_create (self->paint_surface);
   cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
   gdk_cairo_region (cr, region);
   cairo_fill (cr);
@@ -188,6 +235,7 @@ gdk_wayland_cairo_context_end_frame (GdkDrawContext *draw_context,
   gdk_wayland_surface_notify_committed (surface);
 
   gdk_wayland_cairo_context_surface_clear_region (self->paint_surface);
+  self->presented_surface = self->paint_surface;
   self->paint_surface = NULL;
 }
 
@@ -195,6 +243,7 @@ static void
 gdk_wayland_cairo_context_clear_all_cairo_surfaces (GdkWaylandCairoContext *self)
 {
   self->cached_surface = NULL;
+  self->presented_surface = NULL;
   while (self->surfaces)
     gdk_wayland_cairo_context_remove_surface (self, self->surfaces->data);
 }
@@ -204,7 +253,12 @@ gdk_wayland_cairo_context_surface_resized (GdkDrawContext *draw_context)
 {
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (draw_context);
 
-  gdk_wayland_cairo_context_clear_all_cairo_surfaces (self);
+  /* Buffers that the compositor still holds can't go back to the
+   * pool yet, they get dropped when they are released.
+   */
+  if (self->cached_surface)
+    gdk_wayland_cairo_context_remove_surface (self, g_steal_pointer (&self->cached_surface));
+  self->presented_surface = NULL;
 }
 
 static cairo_t *
@@ -221,6 +275,7 @@ gdk_wayland_cairo_context_dispose (GObject *object)
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (object);
 
   gdk_wayland_cairo_context_clear_all_cairo_surfaces (self);
+  g_clear_pointer (&self->pool, _gdk_wayland_shm_pool_free);
 
   G_OBJECT_CLASS (gdk_wayland_cairo_context_parent_class)->dispose (object);
 }
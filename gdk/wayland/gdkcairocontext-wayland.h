@@ -39,9 +39,11 @@ struct _GdkWaylandCairoContext
 {
   GdkCairoContext parent_instance;
 
+  GdkWaylandShmPool *pool;
   GSList *surfaces;
   cairo_surface_t *cached_surface;
   cairo_surface_t *paint_surface;
+  cairo_surface_t *presented_surface;
 };
 
 struct _GdkWaylandCairoContextClass
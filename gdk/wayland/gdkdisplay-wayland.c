@@ -364,6 +364,20 @@ static const struct wl_shm_listener wl_shm_listener = {
   wl_shm_format
 };
 
+static void
+presentation_clock_id (void                   *data,
+                       struct wp_presentation *presentation,
+                       uint32_t                clk_id)
+{
+  GdkWaylandDisplay *display_wayland = data;
+
+  display_wayland->presentation_clock_id = clk_id;
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+  presentation_clock_id
+};
+
 static void
 server_decoration_manager_default_mode (void                                          *data,
                                         struct org_kde_kwin_server_decoration_manager *manager,
@@ -561,6 +575,14 @@ gdk_registry_handle_global (void               *data,
         wl_registry_bind (display_wayland->wl_registry, id,
                           &zwp_idle_inhibit_manager_v1_interface, 1);
     }
+  else if (strcmp (interface, "wp_presentation") == 0)
+    {
+      display_wayland->presentation =
+        wl_registry_bind (display_wayland->wl_registry, id,
+                          &wp_presentation_interface, 1);
+      wp_presentation_add_listener (display_wayland->presentation,
+                                    &presentation_listener, display_wayland);
+    }
 
   g_hash_table_insert (display_wayland->known_globals,
                        GUINT_TO_POINTER (id), g_strdup (interface));
@@ -1211,6 +1233,10 @@ typedef struct _GdkWaylandCairoSurfaceData {
   struct wl_buffer *buffer;
   GdkWaylandDisplay *display;
   uint32_t scale;
+
+  /* Set for surfaces carved out of a GdkWaylandShmPool */
+  GdkWaylandShmPool *shared_pool;
+  size_t offset;
 } GdkWaylandCairoSurfaceData;
 
 static int
@@ -1319,6 +1345,9 @@ fail:
   return NULL;
 }
 
+static void shm_pool_release (GdkWaylandShmPool *pool,
+                              size_t             offset);
+
 static void
 gdk_wayland_cairo_surface_destroy (void *p)
 {
@@ -1331,6 +1360,10 @@ gdk_wayland_cairo_surface_destroy (void *p)
     wl_shm_pool_destroy (data->pool);
 
   munmap (data->buf, data->buf_length);
+
+  if (data->shared_pool)
+    shm_pool_release (data->shared_pool, data->offset);
+
   g_free (data);
 }
 
@@ -1345,7 +1378,7 @@ _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
   cairo_status_t status;
   int stride;
 
-  data = g_new (GdkWaylandCairoSurfaceData, 1);
+  data = g_new0 (GdkWaylandCairoSurfaceData, 1);
   data->display = display;
   data->buffer = NULL;
   data->scale = scale;
@@ -1395,6 +1428,220 @@ _gdk_wayland_is_shm_surface (cairo_surface_t *surface)
   return cairo_surface_get_user_data (surface, &gdk_wayland_shm_surface_cairo_key) != NULL;
 }
 
+/* A GdkWaylandShmPool is a single shared memory file that is carved
+ * into many buffers, so that drawing contexts don't need to create
+ * a new file, wl_shm_pool and mapping every time they need a buffer.
+ *
+ * Every buffer gets its own page-aligned range and mapping, so the
+ * file can grow without invalidating buffers that are still in use.
+ * Free ranges are reused first-fit.
+ */
+typedef struct {
+  size_t offset;
+  size_t size;
+} ShmPoolRange;
+
+struct _GdkWaylandShmPool
+{
+  GdkWaylandDisplay *display;
+  struct wl_shm_pool *pool;
+  int fd;
+  size_t size;
+  GArray *ranges; /* <ShmPoolRange>, sorted by offset */
+  guint destroyed : 1;
+};
+
+static void
+shm_pool_destroy_backing (GdkWaylandShmPool *pool)
+{
+  g_clear_pointer (&pool->pool, wl_shm_pool_destroy);
+  if (pool->fd >= 0)
+    {
+      close (pool->fd);
+      pool->fd = -1;
+    }
+  pool->size = 0;
+}
+
+static void
+shm_pool_release (GdkWaylandShmPool *pool,
+                  size_t             offset)
+{
+  guint i;
+
+  for (i = 0; i < pool->ranges->len; i++)
+    {
+      if (g_array_index (pool->ranges, ShmPoolRange, i).offset == offset)
+        {
+          g_array_remove_index (pool->ranges, i);
+          break;
+        }
+    }
+
+  if (pool->ranges->len == 0)
+    {
+      if (pool->destroyed)
+        {
+          shm_pool_destroy_backing (pool);
+          g_array_unref (pool->ranges);
+          g_free (pool);
+        }
+    }
+}
+
+static gboolean
+shm_pool_reserve (GdkWaylandShmPool *pool,
+                  size_t             size,
+                  size_t            *offset_out)
+{
+  size_t offset = 0;
+  guint i;
+
+  /* A pool that is empty but much bigger than what we need is
+   * left over from a larger window size, start over.
+   */
+  if (pool->ranges->len == 0 && pool->size > 4 * size)
+    shm_pool_destroy_backing (pool);
+
+  for (i = 0; i < pool->ranges->len; i++)
+    {
+      ShmPoolRange *range = &g_array_index (pool->ranges, ShmPoolRange, i);
+
+      if (range->offset - offset >= size)
+        break;
+
+      offset = range->offset + range->size;
+    }
+
+  if (offset + size > pool->size)
+    {
+      size_t new_size;
+
+      /* Grow in steps, so a window that is being resized doesn't
+       * need to grow the file on every frame.
+       */
+      new_size = MAX (offset + size, pool->size + pool->size / 2);
+
+      if (pool->fd < 0)
+        {
+          pool->fd = open_shared_memory ();
+          if (pool->fd < 0)
+            return FALSE;
+        }
+
+      if (ftruncate (pool->fd, new_size) < 0)
+        {
+          g_critical (G_STRLOC ": Truncating shared memory file failed: %m");
+          return FALSE;
+        }
+
+      if (pool->pool)
+        wl_shm_pool_resize (pool->pool, new_size);
+      else
+        pool->pool = wl_shm_create_pool (pool->display->shm, pool->fd, new_size);
+
+      pool->size = new_size;
+    }
+
+  g_array_insert_val (pool->ranges, i, ((ShmPoolRange) { offset, size }));
+  *offset_out = offset;
+
+  return TRUE;
+}
+
+GdkWaylandShmPool *
+_gdk_wayland_shm_pool_new (GdkWaylandDisplay *display)
+{
+  GdkWaylandShmPool *pool;
+
+  pool = g_new0 (GdkWaylandShmPool, 1);
+  pool->display = display;
+  pool->fd = -1;
+  pool->ranges = g_array_new (FALSE, FALSE, sizeof (ShmPoolRange));
+
+  return pool;
+}
+
+/* Surfaces created from the pool may outlive it, the
+ * memory is released once the last of them is gone.
+ */
+void
+_gdk_wayland_shm_pool_free (GdkWaylandShmPool *pool)
+{
+  if (pool->ranges->len > 0)
+    {
+      pool->destroyed = TRUE;
+      return;
+    }
+
+  shm_pool_destroy_backing (pool);
+  g_array_unref (pool->ranges);
+  g_free (pool);
+}
+
+cairo_surface_t *
+_gdk_wayland_shm_pool_create_surface (GdkWaylandShmPool *pool,
+                                      int                width,
+                                      int                height,
+                                      guint              scale)
+{
+  GdkWaylandCairoSurfaceData *data;
+  cairo_surface_t *surface;
+  cairo_status_t status;
+  size_t size, page_size, offset;
+  int stride;
+
+  g_return_val_if_fail (!pool->destroyed, NULL);
+
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
+  page_size = sysconf (_SC_PAGESIZE);
+  size = ((size_t) height * scale * stride + page_size - 1) & ~(page_size - 1);
+
+  data = g_new0 (GdkWaylandCairoSurfaceData, 1);
+  data->display = pool->display;
+  data->scale = scale;
+
+  if (shm_pool_reserve (pool, size, &offset))
+    {
+      data->buf = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, pool->fd, offset);
+      if (data->buf == MAP_FAILED)
+        {
+          g_critical (G_STRLOC ": mmap'ping shared memory file failed: %m");
+          shm_pool_release (pool, offset);
+          data->buf = NULL;
+        }
+      else
+        {
+          data->buf_length = size;
+          data->shared_pool = pool;
+          data->offset = offset;
+          data->buffer = wl_shm_pool_create_buffer (pool->pool, offset,
+                                                    width * scale, height * scale,
+                                                    stride, WL_SHM_FORMAT_ARGB8888);
+        }
+    }
+
+  surface = cairo_image_surface_create_for_data (data->buf,
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 width * scale,
+                                                 height * scale,
+                                                 stride);
+
+  cairo_surface_set_user_data (surface, &gdk_wayland_shm_surface_cairo_key,
+                               data, gdk_wayland_cairo_surface_destroy);
+
+  cairo_surface_set_device_scale (surface, scale, scale);
+
+  status = cairo_surface_status (surface);
+  if (status != CAIRO_STATUS_SUCCESS)
+    {
+      g_critical (G_STRLOC ": Unable to create Cairo image surface: %s",
+                  cairo_status_to_string (status));
+    }
+
+  return surface;
+}
+
 typedef enum
 {
   GSD_FONT_ANTIALIASING_MODE_NONE,
@@ -41,6 +41,7 @@
 #include "gdkinternals.h"
 
 #define WL_SURFACE_HAS_BUFFER_SCALE 3
+#define WL_SURFACE_HAS_DAMAGE_BUFFER 4
 #define WL_POINTER_HAS_FRAME 5
 
 /* the magic mime type we use for local DND operations.
@@ -180,6 +181,15 @@ cairo_surface_t * _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *di
 struct wl_buffer *_gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface);
 gboolean _gdk_wayland_is_shm_surface (cairo_surface_t *surface);
 
+typedef struct _GdkWaylandShmPool GdkWaylandShmPool;
+
+GdkWaylandShmPool *_gdk_wayland_shm_pool_new            (GdkWaylandDisplay *display);
+void               _gdk_wayland_shm_pool_free           (GdkWaylandShmPool *pool);
+cairo_surface_t *  _gdk_wayland_shm_pool_create_surface (GdkWaylandShmPool *pool,
+                                                         int                width,
+                                                         int                height,
+                                                         guint              scale);
+
 EGLSurface gdk_wayland_surface_get_egl_surface (GdkSurface *surface,
                                                EGLConfig config);
 EGLSurface gdk_wayland_surface_get_dummy_egl_surface (GdkSurface *surface,
@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 #include <netinet/in.h>
 #include <unistd.h>
@@ -120,6 +121,7 @@ struct _GdkWaylandSurface
   GdkSeat *grab_input_seat;
 
   gint64 pending_frame_counter;
+  GList *presentation_feedbacks;
   guint32 scale;
 
   int shadow_left;
@@ -503,6 +505,164 @@ finish_pending_relayout (GdkSurface *surface)
   thaw_popup_toplevel_state (surface);
 }
 
+static void
+complete_frame_timings (GdkFrameClock   *clock,
+                        GdkFrameTimings *timings)
+{
+  timings->complete = TRUE;
+
+#ifdef G_ENABLE_DEBUG
+  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
+    _gdk_frame_clock_debug_print_timings (clock, timings);
+#endif
+
+  if (GDK_PROFILER_IS_RUNNING)
+    _gdk_frame_clock_add_timings_to_profiler (clock, timings);
+}
+
+typedef struct
+{
+  GdkSurface *surface;
+  struct wp_presentation_feedback *feedback;
+  gint64 frame_counter;
+  guint32 frame_time; /* from the frame callback, if it came first */
+  guint have_frame_time : 1;
+} PresentationFeedback;
+
+static void
+presentation_feedback_free (PresentationFeedback *data)
+{
+  wp_presentation_feedback_destroy (data->feedback);
+  g_free (data);
+}
+
+static PresentationFeedback *
+find_presentation_feedback (GdkWaylandSurface *impl,
+                            gint64             frame_counter)
+{
+  GList *l;
+
+  for (l = impl->presentation_feedbacks; l; l = l->next)
+    {
+      PresentationFeedback *data = l->data;
+
+      if (data->frame_counter == frame_counter)
+        return data;
+    }
+
+  return NULL;
+}
+
+static void
+finish_presentation_feedback (PresentationFeedback *data,
+                              gint64                presentation_time,
+                              gint64                refresh_interval)
+{
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (data->surface);
+  GdkFrameClock *clock = gdk_surface_get_frame_clock (data->surface);
+  GdkFrameTimings *timings;
+  gboolean have_frame_time;
+  guint32 frame_time;
+
+  timings = gdk_frame_clock_get_timings (clock, data->frame_counter);
+  have_frame_time = data->have_frame_time;
+  frame_time = data->frame_time;
+
+  impl->presentation_feedbacks = g_list_remove (impl->presentation_feedbacks, data);
+  presentation_feedback_free (data);
+
+  if (timings == NULL || timings->complete)
+    return;
+
+  /* Without a usable presentation time, the frame callback has to
+   * complete the timings the way it does without wp_presentation.
+   */
+  if (presentation_time == 0 && !have_frame_time)
+    return;
+
+  if (refresh_interval != 0)
+    timings->refresh_interval = refresh_interval;
+  else if (timings->refresh_interval == 0)
+    timings->refresh_interval = 16667;
+
+  if (presentation_time != 0)
+    timings->presentation_time = presentation_time;
+  else
+    fill_presentation_time_from_frame_time (timings, frame_time);
+
+  complete_frame_timings (clock, timings);
+}
+
+static void
+presentation_feedback_sync_output (void                            *data,
+                                   struct wp_presentation_feedback *feedback,
+                                   struct wl_output                *output)
+{
+}
+
+static void
+presentation_feedback_presented (void                            *data,
+                                 struct wp_presentation_feedback *feedback,
+                                 uint32_t                         tv_sec_hi,
+                                 uint32_t                         tv_sec_lo,
+                                 uint32_t                         tv_nsec,
+                                 uint32_t                         refresh,
+                                 uint32_t                         seq_hi,
+                                 uint32_t                         seq_lo,
+                                 uint32_t                         flags)
+{
+  PresentationFeedback *feedback_data = data;
+  GdkWaylandDisplay *display_wayland =
+    GDK_WAYLAND_DISPLAY (gdk_surface_get_display (feedback_data->surface));
+  gint64 presentation_time = 0;
+
+  /* Presentation times are only comparable to frame times if the
+   * compositor reports them in the clock g_get_monotonic_time() uses.
+   */
+  if (display_wayland->presentation_clock_id == CLOCK_MONOTONIC)
+    presentation_time = (((gint64) tv_sec_hi << 32) + tv_sec_lo) * G_USEC_PER_SEC + tv_nsec / 1000;
+
+  finish_presentation_feedback (feedback_data, presentation_time, refresh / 1000);
+}
+
+static void
+presentation_feedback_discarded (void                            *data,
+                                 struct wp_presentation_feedback *feedback)
+{
+  finish_presentation_feedback (data, 0, 0);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+  presentation_feedback_sync_output,
+  presentation_feedback_presented,
+  presentation_feedback_discarded
+};
+
+static void
+request_presentation_feedback (GdkSurface *surface,
+                               gint64      frame_counter)
+{
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+  GdkWaylandDisplay *display_wayland =
+    GDK_WAYLAND_DISPLAY (gdk_surface_get_display (surface));
+  PresentationFeedback *data;
+
+  if (display_wayland->presentation == NULL)
+    return;
+
+  data = g_new0 (PresentationFeedback, 1);
+  data->surface = surface;
+  data->frame_counter = frame_counter;
+  data->feedback = wp_presentation_feedback (display_wayland->presentation,
+                                             impl->display_server.wl_surface);
+  wl_proxy_set_queue ((struct wl_proxy *) data->feedback, NULL);
+  wp_presentation_feedback_add_listener (data->feedback,
+                                         &presentation_feedback_listener,
+                                         data);
+
+  impl->presentation_feedbacks = g_list_prepend (impl->presentation_feedbacks, data);
+}
+
 static void
 frame_callback (void               *data,
                 struct wl_callback *callback,
@@ -513,6 +673,7 @@ frame_callback (void               *data,
   GdkWaylandDisplay *display_wayland =
     GDK_WAYLAND_DISPLAY (gdk_surface_get_display (surface));
   GdkFrameClock *clock = gdk_surface_get_frame_clock (surface);
+  PresentationFeedback *feedback;
   GdkFrameTimings *timings;
 
   gdk_profiler_add_mark (GDK_PROFILER_CURRENT_TIME, 0, "wayland", "frame event");
@@ -552,6 +713,21 @@ frame_callback (void               *data,
   if (timings == NULL)
     return;
 
+  if (timings->complete)
+    return;
+
+  /* The presentation feedback carries the exact presentation time and
+   * refresh interval, so leave completing the timings to it. Keep the
+   * frame time in case the feedback's clock turns out to be unusable.
+   */
+  feedback = find_presentation_feedback (impl, timings->frame_counter);
+  if (feedback)
+    {
+      feedback->frame_time = time;
+      feedback->have_frame_time = TRUE;
+      return;
+    }
+
   timings->refresh_interval = 16667; /* default to 1/60th of a second */
   if (impl->display_server.outputs)
     {
@@ -566,15 +742,7 @@ frame_callback (void               *data,
 
   fill_presentation_time_from_frame_time (timings, time);
 
-  timings->complete = TRUE;
-
-#ifdef G_ENABLE_DEBUG
-  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
-    _gdk_frame_clock_debug_print_timings (clock, timings);
-#endif
-
-  if (GDK_PROFILER_IS_RUNNING)
-    _gdk_frame_clock_add_timings_to_profiler (clock, timings);
+  complete_frame_timings (clock, timings);
 }
 
 static const struct wl_callback_listener frame_listener = {
@@ -684,6 +852,8 @@ gdk_wayland_surface_request_frame (GdkSurface *surface)
   wl_callback_add_listener (callback, &frame_listener, surface);
   impl->pending_frame_counter = gdk_frame_clock_get_frame_counter (clock);
   impl->awaiting_frame = TRUE;
+
+  request_presentation_feedback (surface, impl->pending_frame_counter);
 }
 
 gboolean
@@ -881,11 +1051,20 @@ gdk_wayland_surface_attach_image (GdkSurface           *surface,
   if (display->compositor_version >= WL_SURFACE_HAS_BUFFER_SCALE)
     wl_surface_set_buffer_scale (impl->display_server.wl_surface, impl->scale);
 
+  /* Damage in buffer coordinates avoids the compositor having to
+   * round the damage up to whole surface coordinates, and is not
+   * affected by the pending buffer offset.
+   */
   n = cairo_region_num_rectangles (damage);
   for (i = 0; i < n; i++)
     {
       cairo_region_get_rectangle (damage, i, &rect);
-      wl_surface_damage (impl->display_server.wl_surface, rect.x, rect.y, rect.width, rect.height);
+      if (display->compositor_version >= WL_SURFACE_HAS_DAMAGE_BUFFER)
+        wl_surface_damage_buffer (impl->display_server.wl_surface,
+                                  rect.x * impl->scale, rect.y * impl->scale,
+                                  rect.width * impl->scale, rect.height * impl->scale);
+      else
+        wl_surface_damage (impl->display_server.wl_surface, rect.x, rect.y, rect.width, rect.height);
     }
 }
 
@@ -953,6 +1132,8 @@ gdk_wayland_surface_finalize (GObject *object)
 
   impl = GDK_WAYLAND_SURFACE (object);
 
+  g_list_free_full (impl->presentation_feedbacks, (GDestroyNotify) presentation_feedback_free);
+
   if (gdk_wayland_surface_is_exported (impl))
     gdk_wayland_toplevel_unexport_handle (GDK_TOPLEVEL (impl));
 
@@ -2944,6 +3125,9 @@ gdk_wayland_surface_hide_surface (GdkSurface *surface)
           impl->application.was_set = FALSE;
         }
 
+      g_list_free_full (impl->presentation_feedbacks, (GDestroyNotify) presentation_feedback_free);
+      impl->presentation_feedbacks = NULL;
+
       wl_surface_destroy (impl->display_server.wl_surface);
       impl->display_server.wl_surface = NULL;
 
@@ -22,6 +22,7 @@
 
 #include "gdkcairocontext-x11.h"
 
+#include "gdkdisplay-x11.h"
 #include "gdkprivate-x11.h"
 
 #include "gdkcairo.h"
@@ -30,8 +31,200 @@
 
 #include <X11/Xlib.h>
 
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
 G_DEFINE_TYPE (GdkX11CairoContext, gdk_x11_cairo_context, GDK_TYPE_CAIRO_CONTEXT)
 
+#ifdef HAVE_XSHM
+static void
+gdk_x11_cairo_context_free_shm_image (GdkX11CairoContext *self)
+{
+  GdkDisplay *display;
+
+  if (self->shm_image == NULL)
+    return;
+
+  display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+
+  XShmDetach (GDK_DISPLAY_XDISPLAY (display), &self->shm_info);
+  XSync (GDK_DISPLAY_XDISPLAY (display), False);
+
+  self->shm_image->data = NULL;
+  XDestroyImage (self->shm_image);
+  self->shm_image = NULL;
+
+  shmdt (self->shm_info.shmaddr);
+  self->shm_pending = FALSE;
+}
+
+static gboolean
+gdk_x11_cairo_context_ensure_shm_image (GdkX11CairoContext *self,
+                                        int                 width,
+                                        int                 height)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (display);
+  Display *xdisplay = GDK_DISPLAY_XDISPLAY (display);
+  Visual *visual;
+  int depth;
+  XImage *image;
+
+  if (!display_x11->have_shm)
+    return FALSE;
+
+  if (self->shm_image)
+    {
+      if (self->shm_image->width == width && self->shm_image->height == height)
+        return TRUE;
+
+      gdk_x11_cairo_context_free_shm_image (self);
+    }
+
+  /* Only use the image path if cairo can draw into the image directly */
+  visual = gdk_x11_display_get_window_visual (display_x11);
+  depth = gdk_x11_display_get_window_depth (display_x11);
+  if ((depth != 24 && depth != 32) ||
+      visual->red_mask != 0xff0000 ||
+      visual->green_mask != 0xff00 ||
+      visual->blue_mask != 0xff)
+    return FALSE;
+
+  image = XShmCreateImage (xdisplay, visual, depth, ZPixmap, NULL,
+                           &self->shm_info, width, height);
+  if (image == NULL)
+    return FALSE;
+
+  if (image->bits_per_pixel != 32 ||
+      image->byte_order != (G_BYTE_ORDER == G_LITTLE_ENDIAN ? LSBFirst : MSBFirst) ||
+      image->bytes_per_line != cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width))
+    {
+      XDestroyImage (image);
+      return FALSE;
+    }
+
+  self->shm_info.shmid = shmget (IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+  if (self->shm_info.shmid < 0)
+    {
+      XDestroyImage (image);
+      return FALSE;
+    }
+
+  self->shm_info.shmaddr = shmat (self->shm_info.shmid, NULL, 0);
+  if (self->shm_info.shmaddr == (char *) -1)
+    {
+      shmctl (self->shm_info.shmid, IPC_RMID, NULL);
+      XDestroyImage (image);
+      return FALSE;
+    }
+
+  image->data = self->shm_info.shmaddr;
+  self->shm_info.readOnly = False;
+
+  /* Attaching fails if the server is not on this machine, in that
+   * case don't try again for this display.
+   */
+  gdk_x11_display_error_trap_push (display);
+  XShmAttach (xdisplay, &self->shm_info);
+  XSync (xdisplay, False);
+  if (gdk_x11_display_error_trap_pop (display))
+    {
+      GDK_DISPLAY_NOTE (display, MISC, g_message ("MIT-SHM not usable, using Xlib drawing"));
+      display_x11->have_shm = FALSE;
+      shmdt (self->shm_info.shmaddr);
+      shmctl (self->shm_info.shmid, IPC_RMID, NULL);
+      image->data = NULL;
+      XDestroyImage (image);
+      return FALSE;
+    }
+
+  /* The segment goes away once both sides have detached */
+  shmctl (self->shm_info.shmid, IPC_RMID, NULL);
+
+  if (self->shm_gc == NULL)
+    self->shm_gc = XCreateGC (xdisplay, GDK_SURFACE_XID (gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self))), 0, NULL);
+
+  self->shm_image = image;
+
+  return TRUE;
+}
+
+static gboolean
+gdk_x11_cairo_context_begin_shm_frame (GdkX11CairoContext *self,
+                                       cairo_region_t     *region)
+{
+  GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  int scale = gdk_surface_get_scale_factor (surface);
+  cairo_t *cr;
+
+  if (!gdk_x11_cairo_context_ensure_shm_image (self,
+                                               gdk_surface_get_width (surface) * scale,
+                                               gdk_surface_get_height (surface) * scale))
+    return FALSE;
+
+  /* The server may still be reading the previous frame */
+  if (self->shm_pending)
+    {
+      XSync (GDK_DISPLAY_XDISPLAY (display), False);
+      self->shm_pending = FALSE;
+    }
+
+  self->paint_surface = cairo_image_surface_create_for_data ((guchar *) self->shm_image->data,
+                                                             self->shm_image->depth == 32
+                                                             ? CAIRO_FORMAT_ARGB32
+                                                             : CAIRO_FORMAT_RGB24,
+                                                             self->shm_image->width,
+                                                             self->shm_image->height,
+                                                             self->shm_image->bytes_per_line);
+  cairo_surface_set_device_scale (self->paint_surface, scale, scale);
+
+  /* clear the repaint area */
+  cr = cairo_create (self->paint_surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  gdk_cairo_region (cr, region);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  return TRUE;
+}
+
+static void
+gdk_x11_cairo_context_end_shm_frame (GdkX11CairoContext *self,
+                                     cairo_region_t     *painted)
+{
+  GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  int scale = gdk_surface_get_scale_factor (surface);
+  cairo_rectangle_int_t rect;
+  int i, n;
+
+  cairo_surface_flush (self->paint_surface);
+
+  /* Only upload what was painted */
+  n = cairo_region_num_rectangles (painted);
+  for (i = 0; i < n; i++)
+    {
+      cairo_region_get_rectangle (painted, i, &rect);
+      XShmPutImage (GDK_DISPLAY_XDISPLAY (display),
+                    GDK_SURFACE_XID (surface),
+                    self->shm_gc,
+                    self->shm_image,
+                    rect.x * scale, rect.y * scale,
+                    rect.x * scale, rect.y * scale,
+                    rect.width * scale, rect.height * scale,
+                    False);
+    }
+
+  XFlush (GDK_DISPLAY_XDISPLAY (display));
+  self->shm_pending = TRUE;
+
+  g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+}
+#endif
+
 static cairo_surface_t *
 create_cairo_surface_for_surface (GdkSurface *surface)
 {
@@ -64,6 +257,13 @@ gdk_x11_cairo_context_begin_frame (GdkDrawContext *draw_context,
   double sx, sy;
 
   surface = gdk_draw_context_get_surface (draw_context);
+
+#ifdef HAVE_XSHM
+  self->shm_frame = gdk_x11_cairo_context_begin_shm_frame (self, region);
+  if (self->shm_frame)
+    return;
+#endif
+
   cairo_region_get_extents (region, &clip_box);
 
   self->window_surface = create_cairo_surface_for_surface (surface);
@@ -84,6 +284,15 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
   cairo_t *cr;
 
+#ifdef HAVE_XSHM
+  if (self->shm_frame)
+    {
+      self->shm_frame = FALSE;
+      gdk_x11_cairo_context_end_shm_frame (self, painted);
+      return;
+    }
+#endif
+
   cr = cairo_create (self->window_surface);
 
   cairo_set_source_surface (cr, self->paint_surface, 0, 0);
@@ -109,12 +318,34 @@ gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
   return cairo_create (self->paint_surface);
 }
 
+static void
+gdk_x11_cairo_context_dispose (GObject *object)
+{
+#ifdef HAVE_XSHM
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (object);
+
+  gdk_x11_cairo_context_free_shm_image (self);
+  if (self->shm_gc)
+    {
+      GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+
+      XFreeGC (GDK_DISPLAY_XDISPLAY (display), self->shm_gc);
+      self->shm_gc = NULL;
+    }
+#endif
+
+  G_OBJECT_CLASS (gdk_x11_cairo_context_parent_class)->dispose (object);
+}
+
 static void
 gdk_x11_cairo_context_class_init (GdkX11CairoContextClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS (klass);
   GdkCairoContextClass *cairo_context_class = GDK_CAIRO_CONTEXT_CLASS (klass);
 
+  gobject_class->dispose = gdk_x11_cairo_context_dispose;
+
   draw_context_class->begin_frame = gdk_x11_cairo_context_begin_frame;
   draw_context_class->end_frame = gdk_x11_cairo_context_end_frame;
 
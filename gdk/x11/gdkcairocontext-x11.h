@@ -25,6 +25,12 @@
 
 #include "gdkcairocontextprivate.h"
 
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
 G_BEGIN_DECLS
 
 #define GDK_TYPE_X11_CAIRO_CONTEXT		(gdk_x11_cairo_context_get_type ())
@@ -43,6 +49,17 @@ struct _GdkX11CairoContext
 
   cairo_surface_t *window_surface;
   cairo_surface_t *paint_surface;
+
+#ifdef HAVE_XSHM
+  /* Image path: we draw into a shared memory image the size of
+   * the surface and upload the painted region with XShmPutImage
+   */
+  XShmSegmentInfo shm_info;
+  XImage *shm_image;
+  GC shm_gc;
+  guint shm_pending : 1;
+  guint shm_frame : 1; /* the current frame draws into shm_image */
+#endif
 };
 
 struct _GdkX11CairoContextClass
@@ -1595,6 +1595,12 @@ gdk_x11_display_open (const char *display_name)
   }
 #endif
 
+  display_x11->have_shm = FALSE;
+#ifdef HAVE_XSHM
+  if (XShmQueryExtension (display_x11->xdisplay))
+    display_x11->have_shm = TRUE;
+#endif
+
 #ifdef HAVE_XDAMAGE
   display_x11->have_damage = FALSE;
   if (XDamageQueryExtension (display_x11->xdisplay,
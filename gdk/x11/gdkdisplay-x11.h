@@ -117,6 +117,7 @@ struct _GdkX11Display
 
   /* Sets of atoms for DND */
   guint use_sync : 1;
+  guint have_shm : 1;
 
   guint have_shapes : 1;
   guint have_input_shapes : 1;
@@ -635,6 +635,152 @@ gtk_bitset_difference (GtkBitset       *self,
   roaring_bitmap_xor_inplace (&self->roaring, &other->roaring);
 }
 
+/* Adds the 65536 bits in @words to the values starting at @key << 16 */
+static void
+gtk_bitset_add_words (GtkBitset      *self,
+                      gint64          key,
+                      const uint64_t *words)
+{
+  roaring_bitmap_t *tmp;
+  bitset_container_t *bitset;
+  void *container;
+  uint8_t typecode;
+
+  if (key < 0 || key > 0xFFFF)
+    return;
+
+  bitset = bitset_container_create ();
+  memcpy (bitset->array, words, sizeof (uint64_t) * BITSET_CONTAINER_SIZE_IN_WORDS);
+  bitset->cardinality = bitset_container_compute_cardinality (bitset);
+  if (bitset->cardinality == 0)
+    {
+      bitset_container_free (bitset);
+      return;
+    }
+  else if (bitset->cardinality <= DEFAULT_MAX_SIZE)
+    {
+      container = array_container_from_bitset (bitset);
+      typecode = ARRAY_CONTAINER_TYPE_CODE;
+      bitset_container_free (bitset);
+    }
+  else
+    {
+      container = bitset;
+      typecode = BITSET_CONTAINER_TYPE_CODE;
+    }
+
+  tmp = roaring_bitmap_create ();
+  ra_append (&tmp->high_low_container, key, container, typecode);
+  roaring_bitmap_or_inplace (&self->roaring, tmp);
+  roaring_bitmap_free (tmp);
+}
+
+/* Adds all values of @source moved by @offset to @self, dropping
+ * the ones that end up outside the range of a guint.
+ * This works on whole containers, so it's a lot faster than adding
+ * the values one by one. All values in @self must be smaller than
+ * the moved values.
+ */
+static void
+gtk_bitset_add_offset (GtkBitset              *self,
+                       const roaring_bitmap_t *source,
+                       gint64                  offset)
+{
+  const roaring_array_t *ra = &source->high_low_container;
+  roaring_array_t *result = &self->roaring.high_low_container;
+  uint32_t *values = NULL;
+  uint64_t *words = NULL;
+  int32_t i;
+
+  for (i = 0; i < ra->size; i++)
+    {
+      const void *container;
+      uint8_t typecode;
+      gint64 base;
+
+      base = ((gint64) ra->keys[i] << 16) + offset;
+      if (base + 0xFFFF < 0)
+        continue;
+      if (base > G_MAXUINT)
+        break;
+
+      typecode = ra->typecodes[i];
+      container = container_unwrap_shared (ra->containers[i], &typecode);
+
+      if ((base & 0xFFFF) == 0 &&
+          (result->size == 0 || result->keys[result->size - 1] < (base >> 16)))
+        {
+          /* the container stays intact, it just gets a new key */
+          ra_append (result, base >> 16, container_clone (container, typecode), typecode);
+        }
+      else if (typecode == RUN_CONTAINER_TYPE_CODE)
+        {
+          const run_container_t *run = container;
+          int32_t j;
+
+          for (j = 0; j < run->n_runs; j++)
+            {
+              gint64 first = base + run->runs[j].value;
+              gint64 last = first + run->runs[j].length;
+
+              first = MAX (first, 0);
+              last = MIN (last, G_MAXUINT);
+              if (first <= last)
+                roaring_bitmap_add_range_closed (&self->roaring, first, last);
+            }
+        }
+      else if (typecode == BITSET_CONTAINER_TYPE_CODE)
+        {
+          const bitset_container_t *bitset = container;
+          gint64 key;
+          guint shift, word_shift, bit_shift;
+          int j;
+
+          /* shift the words into a buffer spanning 2 containers */
+          key = base >= 0 ? base >> 16 : - ((- base + 0xFFFF) >> 16);
+          shift = base - (key << 16);
+          word_shift = shift / 64;
+          bit_shift = shift % 64;
+
+          if (words == NULL)
+            words = g_new (uint64_t, 2 * BITSET_CONTAINER_SIZE_IN_WORDS + 1);
+          memset (words, 0, sizeof (uint64_t) * (2 * BITSET_CONTAINER_SIZE_IN_WORDS + 1));
+
+          for (j = 0; j < BITSET_CONTAINER_SIZE_IN_WORDS; j++)
+            {
+              words[j + word_shift] |= bitset->array[j] << bit_shift;
+              if (bit_shift)
+                words[j + word_shift + 1] |= bitset->array[j] >> (64 - bit_shift);
+            }
+
+          gtk_bitset_add_words (self, key, words);
+          gtk_bitset_add_words (self, key + 1, words + BITSET_CONTAINER_SIZE_IN_WORDS);
+        }
+      else
+        {
+          int j, n, n_values;
+
+          if (values == NULL)
+            values = g_new (uint32_t, 1 << 16);
+
+          n = container_to_uint32_array (values, container, typecode, 0);
+          n_values = 0;
+          for (j = 0; j < n; j++)
+            {
+              gint64 value = base + values[j];
+
+              if (value >= 0 && value <= G_MAXUINT)
+                values[n_values++] = value;
+            }
+
+          roaring_bitmap_add_many (&self->roaring, n_values, values);
+        }
+    }
+
+  g_free (values);
+  g_free (words);
+}
+
 /**
  * gtk_bitset_shift_left:
  * @self: a $GtkBitset
@@ -647,27 +793,19 @@ void
 gtk_bitset_shift_left (GtkBitset *self,
                        guint      amount)
 {
-  GtkBitset *original;
-  GtkBitsetIter iter;
-  guint value;
-  gboolean loop;
+  roaring_bitmap_t original;
 
   g_return_if_fail (self != NULL);
 
   if (amount == 0)
     return;
 
-  original = gtk_bitset_copy (self);
-  gtk_bitset_remove_all (self);
+  original = self->roaring;
+  ra_init (&self->roaring.high_low_container);
 
-  for (loop = gtk_bitset_iter_init_at (&iter, original, amount, &value);
-       loop;
-       loop = gtk_bitset_iter_next (&iter, &value))
-    {
-      gtk_bitset_add (self, value - amount);
-    }
+  gtk_bitset_add_offset (self, &original, - (gint64) amount);
 
-  gtk_bitset_unref (original);
+  ra_clear (&original.high_low_container);
 }
 
 /**
@@ -682,27 +820,19 @@ void
 gtk_bitset_shift_right (GtkBitset *self,
                         guint      amount)
 {
-  GtkBitset *original;
-  GtkBitsetIter iter;
-  guint value;
-  gboolean loop;
+  roaring_bitmap_t original;
 
   g_return_if_fail (self != NULL);
 
   if (amount == 0)
     return;
 
-  original = gtk_bitset_copy (self);
-  gtk_bitset_remove_all (self);
+  original = self->roaring;
+  ra_init (&self->roaring.high_low_container);
 
-  for (loop = gtk_bitset_iter_init_first (&iter, original, &value);
-       loop && value <= G_MAXUINT - amount;
-       loop = gtk_bitset_iter_next (&iter, &value))
-    {
-      gtk_bitset_add (self, value + amount);
-    }
+  gtk_bitset_add_offset (self, &original, amount);
 
-  gtk_bitset_unref (original);
+  ra_clear (&original.high_low_container);
 }
 
 /**
@@ -729,6 +859,8 @@ gtk_bitset_splice (GtkBitset *self,
                    guint      removed,
                    guint      added)
 {
+  roaring_bitmap_t *shift;
+
   g_return_if_fail (self != NULL);
   /* overflow */
   g_return_if_fail (position + removed >= position);
@@ -736,19 +868,241 @@ gtk_bitset_splice (GtkBitset *self,
 
   gtk_bitset_remove_range (self, position, removed);
 
-  if (removed != added)
+  /* nothing to move */
+  if (removed == added ||
+      gtk_bitset_is_empty (self) ||
+      gtk_bitset_get_maximum (self) < position)
+    return;
+
+  shift = roaring_bitmap_copy (&self->roaring);
+  roaring_bitmap_remove_range (shift, 0, position);
+  roaring_bitmap_remove_range_closed (&self->roaring, position, G_MAXUINT);
+  gtk_bitset_add_offset (self, shift, (gint64) added - (gint64) removed);
+  roaring_bitmap_free (shift);
+}
+
+G_STATIC_ASSERT (sizeof (guint) == sizeof (uint32_t));
+
+/**
+ * gtk_bitset_add_many:
+ * @self: a #GtkBitset
+ * @values: (array length=n_values): the values to add
+ * @n_values: number of values in @values
+ *
+ * Adds all @values to @self.
+ *
+ * This is a lot faster than calling gtk_bitset_add() for every
+ * value, in particular if @values is sorted.
+ **/
+void
+gtk_bitset_add_many (GtkBitset   *self,
+                     const guint *values,
+                     gsize        n_values)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (values != NULL || n_values == 0);
+
+  roaring_bitmap_add_many (&self->roaring, n_values, values);
+}
+
+/**
+ * gtk_bitset_remove_many:
+ * @self: a #GtkBitset
+ * @values: (array length=n_values): the values to remove
+ * @n_values: number of values in @values
+ *
+ * Removes all @values from @self.
+ *
+ * This is a lot faster than calling gtk_bitset_remove() for every
+ * value, in particular if @values is sorted.
+ **/
+void
+gtk_bitset_remove_many (GtkBitset   *self,
+                        const guint *values,
+                        gsize        n_values)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (values != NULL || n_values == 0);
+
+  roaring_bitmap_remove_many (&self->roaring, n_values, values);
+}
+
+/**
+ * gtk_bitset_optimize:
+ * @self: a #GtkBitset
+ *
+ * Compresses @self to use as little memory as possible.
+ *
+ * Ranges of consecutive values get stored as just their start and
+ * length, and unused memory is released. This makes many operations
+ * on large ranges faster, so it is a good idea to call this after
+ * large changes to a bitset that is kept around.
+ *
+ * Returns: %TRUE if @self now stores ranges of values
+ **/
+gboolean
+gtk_bitset_optimize (GtkBitset *self)
+{
+  gboolean result;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+
+  result = roaring_bitmap_run_optimize (&self->roaring);
+  roaring_bitmap_shrink_to_fit (&self->roaring);
+
+  return result;
+}
+
+typedef struct
+{
+  GtkBitsetRangeFunc func;
+  gpointer user_data;
+  gboolean has_range;
+  guint first;
+  guint last;
+} GtkBitsetRangeCollector;
+
+/* Joins adjacent ranges and reports the other ones */
+static gboolean
+gtk_bitset_range_collector_add (GtkBitsetRangeCollector *collector,
+                                guint                    first,
+                                guint                    last)
+{
+  if (collector->has_range)
     {
-      GtkBitset *shift = gtk_bitset_copy (self);
+      if (first == collector->last + 1)
+        {
+          collector->last = last;
+          return TRUE;
+        }
+
+      if (!collector->func (collector->first, collector->last, collector->user_data))
+        return FALSE;
+    }
 
-      gtk_bitset_remove_range (shift, 0, position);
-      gtk_bitset_remove_range_closed (self, position, G_MAXUINT);
-      if (added > removed)
-        gtk_bitset_shift_right (shift, added - removed);
-      else
-        gtk_bitset_shift_left (shift, removed - added);
-      gtk_bitset_union (self, shift);
-      gtk_bitset_unref (shift);
+  collector->has_range = TRUE;
+  collector->first = first;
+  collector->last = last;
+
+  return TRUE;
+}
+
+static gboolean
+gtk_bitset_range_collector_add_container (GtkBitsetRangeCollector *collector,
+                                          const void              *container,
+                                          uint8_t                  typecode,
+                                          guint                    base)
+{
+  int32_t i;
+
+  container = container_unwrap_shared (container, &typecode);
+
+  switch (typecode)
+    {
+    case RUN_CONTAINER_TYPE_CODE:
+      {
+        const run_container_t *run = container;
+
+        for (i = 0; i < run->n_runs; i++)
+          {
+            if (!gtk_bitset_range_collector_add (collector,
+                                                 base + run->runs[i].value,
+                                                 base + run->runs[i].value + run->runs[i].length))
+              return FALSE;
+          }
+      }
+      break;
+
+    case ARRAY_CONTAINER_TYPE_CODE:
+      {
+        const array_container_t *array = container;
+
+        for (i = 0; i < array->cardinality; i++)
+          {
+            if (!gtk_bitset_range_collector_add (collector,
+                                                 base + array->array[i],
+                                                 base + array->array[i]))
+              return FALSE;
+          }
+      }
+      break;
+
+    case BITSET_CONTAINER_TYPE_CODE:
+      {
+        const bitset_container_t *bitset = container;
+
+        for (i = 0; i < BITSET_CONTAINER_SIZE_IN_WORDS; i++)
+          {
+            uint64_t word = bitset->array[i];
+
+            while (word != 0)
+              {
+                int start, length;
+
+                start = __builtin_ctzll (word);
+                if (~(word >> start) == 0)
+                  length = 64 - start;
+                else
+                  length = __builtin_ctzll (~(word >> start));
+
+                if (!gtk_bitset_range_collector_add (collector,
+                                                     base + i * 64 + start,
+                                                     base + i * 64 + start + length - 1))
+                  return FALSE;
+
+                if (start + length == 64)
+                  break;
+                word &= ~((UINT64_C (1) << (start + length)) - 1);
+              }
+          }
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  return TRUE;
+}
+
+/**
+ * gtk_bitset_foreach_range:
+ * @self: a #GtkBitset
+ * @func: (scope call): the function to call
+ * @user_data: user data to pass to @func
+ *
+ * Calls @func for every range of consecutive values in @self,
+ * from the smallest to the largest values.
+ *
+ * This is a lot faster than iterating over every single value if
+ * @self contains large ranges of values.
+ **/
+void
+gtk_bitset_foreach_range (const GtkBitset    *self,
+                          GtkBitsetRangeFunc  func,
+                          gpointer            user_data)
+{
+  const roaring_array_t *ra;
+  GtkBitsetRangeCollector collector = { func, user_data, FALSE, 0, 0 };
+  int32_t i;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (func != NULL);
+
+  ra = &self->roaring.high_low_container;
+
+  for (i = 0; i < ra->size; i++)
+    {
+      if (!gtk_bitset_range_collector_add_container (&collector,
+                                                     ra->containers[i],
+                                                     ra->typecodes[i],
+                                                     (guint) ra->keys[i] << 16))
+        return;
     }
+
+  if (collector.has_range)
+    func (collector.first, collector.last, user_data);
 }
 
 G_STATIC_ASSERT (sizeof (GtkBitsetIter) >= sizeof (roaring_uint32_iterator_t));
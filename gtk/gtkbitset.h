@@ -129,6 +129,36 @@ void                    gtk_bitset_splice                       (GtkBitset
                                                                  guint                   position,
                                                                  guint                   removed,
                                                                  guint                   added);
+GDK_AVAILABLE_IN_ALL
+void                    gtk_bitset_add_many                     (GtkBitset              *self,
+                                                                 const guint            *values,
+                                                                 gsize                   n_values);
+GDK_AVAILABLE_IN_ALL
+void                    gtk_bitset_remove_many                  (GtkBitset              *self,
+                                                                 const guint            *values,
+                                                                 gsize                   n_values);
+GDK_AVAILABLE_IN_ALL
+gboolean                gtk_bitset_optimize                     (GtkBitset              *self);
+
+/**
+ * GtkBitsetRangeFunc:
+ * @first: the first value of the range
+ * @last: the last value of the range
+ * @user_data: user data passed to gtk_bitset_foreach_range()
+ *
+ * The type of the function called by gtk_bitset_foreach_range()
+ * for every range of consecutive values.
+ *
+ * Returns: %TRUE to continue with the next range, %FALSE to stop
+ */
+typedef gboolean (* GtkBitsetRangeFunc) (guint    first,
+                                         guint    last,
+                                         gpointer user_data);
+
+GDK_AVAILABLE_IN_ALL
+void                    gtk_bitset_foreach_range                (const GtkBitset        *self,
+                                                                 GtkBitsetRangeFunc      func,
+                                                                 gpointer                user_data);
 
 /**
  * GtkBitsetIter:
@@ -21,6 +21,7 @@
 
 #include "gtkboolfilter.h"
 
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
 
@@ -39,6 +40,7 @@ struct _GtkBoolFilter
 
   gboolean invert;
   GtkExpression *expression;
+  GtkExpressionCache *cache;
 };
 
 enum {
@@ -61,7 +63,7 @@ gtk_bool_filter_match (GtkFilter *filter,
   gboolean result;
 
   if (self->expression == NULL ||
-      !gtk_expression_evaluate (self->expression, item, &value))
+      !gtk_expression_cache_evaluate (self->cache, item, &value))
     return FALSE;
   result = g_value_get_boolean (&value);
 
@@ -137,6 +139,7 @@ gtk_bool_filter_dispose (GObject *object)
 {
   GtkBoolFilter *self = GTK_BOOL_FILTER (object);
 
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
 
   G_OBJECT_CLASS (gtk_bool_filter_parent_class)->dispose (object);
@@ -184,6 +187,7 @@ gtk_bool_filter_class_init (GtkBoolFilterClass *class)
 static void
 gtk_bool_filter_init (GtkBoolFilter *self)
 {
+  gtk_filter_set_thread_safe (GTK_FILTER (self), TRUE);
 }
 
 /**
@@ -245,10 +249,15 @@ gtk_bool_filter_set_expression (GtkBoolFilter *self,
   if (self->expression == expression)
     return;
 
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
   if (expression)
-    self->expression = gtk_expression_ref (expression);
+    {
+      self->expression = gtk_expression_ref (expression);
+      self->cache = gtk_expression_cache_new (expression);
+    }
 
+  gtk_filter_set_thread_safe (GTK_FILTER (self), gtk_expression_is_thread_safe (expression));
   gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_EXPRESSION]);
@@ -75,6 +75,9 @@
  * disabled with the #GtkColumnView:reorderable and #GtkColumnViewColumn:resizable
  * properties.
  *
+ * Column views with many columns can set #GtkColumnView:lazy-columns, so
+ * that cells are only created for the columns close to the visible area.
+ *
  * To learn more about the list widget framework, see the [overview](#ListWidget).
  *
  * # CSS nodes
@@ -171,6 +174,7 @@ struct _GtkColumnView
   guint show_column_separators : 1;
   guint in_column_resize : 1;
   guint in_column_reorder : 1;
+  guint lazy_columns : 1;
 
   int drag_pos;
   int drag_x;
@@ -204,6 +208,7 @@ enum
   PROP_SINGLE_CLICK_ACTIVATE,
   PROP_REORDERABLE,
   PROP_ENABLE_RUBBERBAND,
+  PROP_LAZY_COLUMNS,
 
   N_PROPS
 };
@@ -411,6 +416,47 @@ gtk_column_view_allocate_columns (GtkColumnView *self,
   return x;
 }
 
+/* With lazy columns, columns further than this fraction of the width
+ * outside the visible area don't have cells.
+ */
+#define COLUMNS_IN_VIEW_MARGIN 0.5
+
+/* This runs before the rows are allocated, so the cells created here
+ * are measured and allocated in the same frame.
+ */
+static void
+gtk_column_view_update_columns_in_view (GtkColumnView *self,
+                                        int            x,
+                                        int            width)
+{
+  guint i, n;
+  int start, end;
+
+  start = x - width * COLUMNS_IN_VIEW_MARGIN;
+  end = x + width + width * COLUMNS_IN_VIEW_MARGIN;
+
+  n = g_list_model_get_n_items (G_LIST_MODEL (self->columns));
+  for (i = 0; i < n; i++)
+    {
+      GtkColumnViewColumn *column;
+      int col_x, col_size;
+      gboolean in_view;
+
+      column = g_list_model_get_item (G_LIST_MODEL (self->columns), i);
+      gtk_column_view_column_get_allocation (column, &col_x, &col_size);
+
+      /* keep the column that is being dragged around */
+      in_view = !self->lazy_columns ||
+                (gtk_column_view_column_get_visible (column) &&
+                 ((self->in_column_reorder && i == self->drag_pos) ||
+                  (col_x + col_size > start && col_x < end)));
+
+      gtk_column_view_column_set_in_view (column, in_view);
+
+      g_object_unref (column);
+    }
+}
+
 static void
 gtk_column_view_allocate (GtkWidget *widget,
                           int        width,
@@ -422,6 +468,7 @@ gtk_column_view_allocate (GtkWidget *widget,
 
   x = gtk_adjustment_get_value (self->hadjustment);
   full_width = gtk_column_view_allocate_columns (self, width);
+  gtk_column_view_update_columns_in_view (self, x, width);
 
   gtk_widget_measure (self->header, GTK_ORIENTATION_VERTICAL, full_width, &min, &nat, NULL, NULL);
   if (gtk_scrollable_get_vscroll_policy (GTK_SCROLLABLE (self->listview)) == GTK_SCROLL_MINIMUM)
@@ -554,6 +601,10 @@ gtk_column_view_get_property (GObject    *object,
       g_value_set_boolean (value, gtk_column_view_get_enable_rubberband (self));
       break;
 
+    case PROP_LAZY_COLUMNS:
+      g_value_set_boolean (value, self->lazy_columns);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -637,6 +688,10 @@ gtk_column_view_set_property (GObject      *object,
       gtk_column_view_set_enable_rubberband (self, g_value_get_boolean (value));
       break;
 
+    case PROP_LAZY_COLUMNS:
+      gtk_column_view_set_lazy_columns (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -769,6 +824,18 @@ gtk_column_view_class_init (GtkColumnViewClass *klass)
                           FALSE,
                           G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkColumnView:lazy-columns:
+   *
+   * Only create cells for columns close to the visible area
+   */
+  properties[PROP_LAZY_COLUMNS] =
+    g_param_spec_boolean ("lazy-columns",
+                          P_("Lazy columns"),
+                          P_("Only create cells for columns close to the visible area"),
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 
   /**
@@ -1817,3 +1884,55 @@ gtk_column_view_get_enable_rubberband (GtkColumnView *self)
 
   return gtk_list_view_get_enable_rubberband (self->listview);
 }
+
+/**
+ * gtk_column_view_set_lazy_columns:
+ * @self: a #GtkColumnView
+ * @lazy_columns: %TRUE to only create cells for columns close to the
+ *     visible area
+ *
+ * Sets whether cells are only created for the columns that are close to
+ * the visible area.
+ *
+ * This is useful for column views with many columns. The cells of columns
+ * that are scrolled far out of view are removed and created again when the
+ * columns come back into view.
+ *
+ * Rows only measure the cells that exist, so if the cells of different
+ * columns have different heights, the height of a row can change while
+ * scrolling horizontally. Columns without a fixed width keep the width
+ * they had when they were last in view.
+ */
+void
+gtk_column_view_set_lazy_columns (GtkColumnView *self,
+                                  gboolean       lazy_columns)
+{
+  g_return_if_fail (GTK_IS_COLUMN_VIEW (self));
+
+  if (self->lazy_columns == lazy_columns)
+    return;
+
+  self->lazy_columns = lazy_columns;
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LAZY_COLUMNS]);
+}
+
+/**
+ * gtk_column_view_get_lazy_columns:
+ * @self: a #GtkColumnView
+ *
+ * Returns whether cells are only created for the columns that are close
+ * to the visible area.
+ *
+ * Returns: %TRUE if cells are only created for columns close to the
+ *     visible area
+ */
+gboolean
+gtk_column_view_get_lazy_columns (GtkColumnView *self)
+{
+  g_return_val_if_fail (GTK_IS_COLUMN_VIEW (self), FALSE);
+
+  return self->lazy_columns;
+}
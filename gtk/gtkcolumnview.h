@@ -113,6 +113,12 @@ void            gtk_column_view_set_enable_rubberband           (GtkColumnView
 GDK_AVAILABLE_IN_ALL
 gboolean        gtk_column_view_get_enable_rubberband           (GtkColumnView          *self);
 
+GDK_AVAILABLE_IN_ALL
+void            gtk_column_view_set_lazy_columns                (GtkColumnView          *self,
+                                                                 gboolean                lazy_columns);
+GDK_AVAILABLE_IN_ALL
+gboolean        gtk_column_view_get_lazy_columns                (GtkColumnView          *self);
+
 G_END_DECLS
 
 #endif  /* __GTK_COLUMN_VIEW_H__ */
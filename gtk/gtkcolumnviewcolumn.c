@@ -70,9 +70,14 @@ struct _GtkColumnViewColumn
 
   int fixed_width;
 
+  /* size used while the cells are torn down */
+  int cached_minimum;
+  int cached_natural;
+
   guint visible     : 1;
   guint resizable   : 1;
   guint expand      : 1;
+  guint in_view     : 1;
 
   GMenuModel *menu;
 
@@ -351,6 +356,9 @@ gtk_column_view_column_init (GtkColumnViewColumn *self)
   self->resizable = FALSE;
   self->expand = FALSE;
   self->fixed_width = -1;
+  self->in_view = TRUE;
+  self->cached_minimum = -1;
+  self->cached_natural = -1;
 }
 
 /**
@@ -447,6 +455,11 @@ gtk_column_view_column_measure (GtkColumnViewColumn *self,
       self->minimum_size_request  = self->fixed_width;
       self->natural_size_request  = self->fixed_width;
     }
+  else if (!self->in_view)
+    {
+      self->minimum_size_request  = self->cached_minimum;
+      self->natural_size_request  = self->cached_natural;
+    }
 
   if (self->minimum_size_request < 0)
     {
@@ -483,6 +496,46 @@ gtk_column_view_column_measure (GtkColumnViewColumn *self,
   *natural = self->natural_size_request;
 }
 
+static void gtk_column_view_column_create_cells (GtkColumnViewColumn *self);
+static void gtk_column_view_column_remove_cells (GtkColumnViewColumn *self);
+
+/* With GtkColumnView:lazy-columns, columns that are scrolled out of view
+ * remove their cells, so they don't need to be created, bound and measured.
+ * For that we need to know the column's width without measuring the cells.
+ */
+void
+gtk_column_view_column_set_in_view (GtkColumnViewColumn *self,
+                                    gboolean             in_view)
+{
+  if (self->in_view == in_view)
+    return;
+
+  if (!in_view && self->fixed_width < 0)
+    {
+      if (self->minimum_size_request < 0)
+        return;
+
+      self->cached_minimum = self->minimum_size_request;
+      self->cached_natural = self->natural_size_request;
+    }
+
+  self->in_view = in_view;
+
+  if (in_view)
+    {
+      if (self->view && gtk_widget_get_root (GTK_WIDGET (self->view)))
+        gtk_column_view_column_create_cells (self);
+    }
+  else
+    gtk_column_view_column_remove_cells (self);
+}
+
+gboolean
+gtk_column_view_column_get_in_view (GtkColumnViewColumn *self)
+{
+  return self->in_view;
+}
+
 void
 gtk_column_view_column_allocate (GtkColumnViewColumn *self,
                                  int                  offset,
@@ -504,13 +557,53 @@ gtk_column_view_column_get_allocation (GtkColumnViewColumn *self,
     *size = self->allocation_size;
 }
 
+/* Puts @cell into @row after the cells of the columns before @self.
+ * Columns that are out of view have no cells, so the position of the
+ * column can't be used as the position of the cell.
+ */
+static void
+gtk_column_view_column_place_cell (GtkColumnViewColumn *self,
+                                   GtkListItemWidget   *row,
+                                   GtkWidget           *cell)
+{
+  GListModel *columns;
+  GtkWidget *child, *sibling;
+  guint i, n;
+
+  columns = gtk_column_view_get_columns (self->view);
+  n = g_list_model_get_n_items (columns);
+  child = gtk_widget_get_first_child (GTK_WIDGET (row));
+  sibling = NULL;
+
+  for (i = 0; i < n; i++)
+    {
+      GtkColumnViewColumn *column = g_list_model_get_item (columns, i);
+
+      g_object_unref (column);
+      if (column == self)
+        break;
+
+      if (child == cell)
+        child = gtk_widget_get_next_sibling (child);
+
+      if (child && gtk_column_view_cell_get_column (GTK_COLUMN_VIEW_CELL (child)) == column)
+        {
+          sibling = child;
+          child = gtk_widget_get_next_sibling (child);
+        }
+    }
+
+  if (cell != sibling)
+    gtk_widget_insert_after (cell, GTK_WIDGET (row), sibling);
+}
+
 static void
 gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
 {
   GtkListView *list;
   GtkWidget *row;
 
-  if (self->first_cell)
+  if (self->first_cell || !self->in_view)
     return;
 
   list = gtk_column_view_get_list_view (GTK_COLUMN_VIEW (self->view));
@@ -526,7 +619,7 @@ gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
 
       list_item = GTK_LIST_ITEM_WIDGET (row);
       cell = gtk_column_view_cell_new (self);
-      gtk_list_item_widget_add_child (list_item, cell);
+      gtk_column_view_column_place_cell (self, list_item, cell);
       gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (cell),
                                    gtk_list_item_widget_get_position (list_item),
                                    gtk_list_item_widget_get_item (list_item),
@@ -609,6 +702,7 @@ gtk_column_view_column_set_column_view (GtkColumnViewColumn *self,
   gtk_column_view_column_remove_header (self);
 
   self->view = view;
+  self->in_view = TRUE;
 
   gtk_column_view_column_ensure_cells (self);
 
@@ -630,7 +724,7 @@ gtk_column_view_column_set_position (GtkColumnViewColumn *self,
       GtkListItemWidget *list_item;
 
       list_item = GTK_LIST_ITEM_WIDGET (gtk_widget_get_parent (GTK_WIDGET (cell)));
-      gtk_list_item_widget_reorder_child (list_item, GTK_WIDGET (cell), position);
+      gtk_column_view_column_place_cell (self, list_item, GTK_WIDGET (cell));
     }
 }
 
@@ -973,6 +1067,10 @@ gtk_column_view_column_get_resizable (GtkColumnViewColumn *self)
  *
  * Setting a fixed width overrides the automatically calculated
  * width. Interactive resizing also sets the “fixed-width” property.
+ *
+ * If #GtkColumnView:lazy-columns is set, columns that are scrolled out
+ * of view don't keep their cells. Without a fixed width, they keep the
+ * width they had when they were last visible.
  */
 void
 gtk_column_view_column_set_fixed_width (GtkColumnViewColumn *self,
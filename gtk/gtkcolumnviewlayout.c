@@ -36,6 +36,15 @@ struct _GtkColumnViewLayout
 
 G_DEFINE_TYPE (GtkColumnViewLayout, gtk_column_view_layout, GTK_TYPE_LAYOUT_MANAGER)
 
+static GtkColumnViewColumn *
+gtk_column_view_layout_get_column (GtkWidget *child)
+{
+  if (GTK_IS_COLUMN_VIEW_CELL (child))
+    return gtk_column_view_cell_get_column (GTK_COLUMN_VIEW_CELL (child));
+  else
+    return gtk_column_view_title_get_column (GTK_COLUMN_VIEW_TITLE (child));
+}
+
 static void
 gtk_column_view_layout_measure_along (GtkColumnViewLayout *self,
                                       GtkWidget           *widget,
@@ -46,21 +55,27 @@ gtk_column_view_layout_measure_along (GtkColumnViewLayout *self,
                                       int                 *natural_baseline)
 {
   GtkOrientation orientation = GTK_ORIENTATION_VERTICAL;
+  GListModel *columns;
   GtkWidget *child;
   guint i, n;
   GtkRequestedSize *sizes = NULL;
 
+  columns = gtk_column_view_get_columns (self->view);
+  n = g_list_model_get_n_items (columns);
   if (for_size > -1)
     {
-      n = g_list_model_get_n_items (gtk_column_view_get_columns (self->view));
       sizes = g_newa (GtkRequestedSize, n);
       gtk_column_view_distribute_width (self->view, for_size, sizes);
     }
 
+  /* Children are in the order of their columns, but columns that are
+   * out of view have no cells, so look for the column of each child.
+   */
   for (child = _gtk_widget_get_first_child (widget), i = 0;
        child != NULL;
-       child = _gtk_widget_get_next_sibling (child), i++)
+       child = _gtk_widget_get_next_sibling (child))
     {
+      int child_size = -1;
       int child_min = 0;
       int child_nat = 0;
       int child_min_baseline = -1;
@@ -69,8 +84,25 @@ gtk_column_view_layout_measure_along (GtkColumnViewLayout *self,
       if (!gtk_widget_should_layout (child))
         continue;
 
+      if (sizes)
+        {
+          GtkColumnViewColumn *column = gtk_column_view_layout_get_column (child);
+
+          for (; i < n; i++)
+            {
+              GtkColumnViewColumn *item = g_list_model_get_item (columns, i);
+
+              g_object_unref (item);
+              if (item == column)
+                {
+                  child_size = sizes[i].minimum_size;
+                  break;
+                }
+            }
+        }
+
       gtk_widget_measure (child, orientation,
-                          for_size > -1 ? sizes[i].minimum_size : -1,
+                          child_size,
                           &child_min, &child_nat,
                           &child_min_baseline, &child_nat_baseline);
 
@@ -133,16 +165,11 @@ gtk_column_view_layout_allocate (GtkLayoutManager *layout_manager,
       if (!gtk_widget_should_layout (child))
         continue;
 
+      column = gtk_column_view_layout_get_column (child);
       if (GTK_IS_COLUMN_VIEW_CELL (child))
-        {
-          column = gtk_column_view_cell_get_column (GTK_COLUMN_VIEW_CELL (child));
-          gtk_column_view_column_get_allocation (column, &col_x, &col_width);
-        }
+        gtk_column_view_column_get_allocation (column, &col_x, &col_width);
       else
-        {
-          column = gtk_column_view_title_get_column (GTK_COLUMN_VIEW_TITLE (child));
-          gtk_column_view_column_get_header_allocation (column, &col_x, &col_width);
-        }
+        gtk_column_view_column_get_header_allocation (column, &col_x, &col_width);
 
       gtk_widget_measure (child, GTK_ORIENTATION_HORIZONTAL, -1, &min, NULL, NULL, NULL);
 
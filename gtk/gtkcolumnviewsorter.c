@@ -23,8 +23,14 @@
 
 #include "gtkcolumnviewcolumnprivate.h"
 #include "gtkintl.h"
+#include "gtksorterprivate.h"
 #include "gtktypebuiltins.h"
 
+/* The maximum size of the cached keys per item. Columns whose keys
+ * don't fit anymore compare the items with their sorter instead.
+ */
+#define GTK_COLUMN_VIEW_SORT_KEYS_MAX_SIZE 64
+
 typedef struct
 {
   GtkColumnViewColumn *column;
@@ -53,6 +59,268 @@ struct _GtkColumnViewSorter
 
 G_DEFINE_TYPE (GtkColumnViewSorter, gtk_column_view_sorter, GTK_TYPE_SORTER)
 
+typedef struct _GtkColumnViewSortKey GtkColumnViewSortKey;
+typedef struct _GtkColumnViewSortKeys GtkColumnViewSortKeys;
+
+struct _GtkColumnViewSortKey
+{
+  gsize offset;
+  GtkSortKeys *keys; /* NULL if the sorter compares the items */
+  GtkSorter *sorter;
+  gboolean inverted;
+};
+
+/* The keys are kept in the order of the sorters, but the memory
+ * layout only depends on the set of columns. So changing the
+ * primary column or the sort direction keeps the keys compatible
+ * and GtkSortListModel can reuse the keys it already computed.
+ *
+ * Sorters are given keys in order of priority as long as they fit
+ * into GTK_COLUMN_VIEW_SORT_KEYS_MAX_SIZE. The remaining ones are
+ * rarely needed as tiebreakers, so they share a reference to the
+ * item and compare that.
+ */
+struct _GtkColumnViewSortKeys
+{
+  GtkSortKeys parent_keys;
+
+  gsize item_offset; /* G_MAXSIZE if no sorter compares the items */
+  guint n_keys;
+  GtkColumnViewSortKey keys[];
+};
+
+static void
+gtk_column_view_sort_keys_free (GtkSortKeys *keys)
+{
+  GtkColumnViewSortKeys *self = (GtkColumnViewSortKeys *) keys;
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    {
+      g_clear_pointer (&self->keys[i].keys, gtk_sort_keys_unref);
+      g_object_unref (self->keys[i].sorter);
+    }
+
+  g_slice_free1 (sizeof (GtkColumnViewSortKeys) + self->n_keys * sizeof (GtkColumnViewSortKey), self);
+}
+
+static int
+gtk_column_view_sort_keys_compare (gconstpointer a,
+                                   gconstpointer b,
+                                   gpointer      data)
+{
+  GtkColumnViewSortKeys *self = (GtkColumnViewSortKeys *) data;
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    {
+      GtkOrdering result;
+
+      if (self->keys[i].keys)
+        result = gtk_sort_keys_compare (self->keys[i].keys,
+                                        ((const char *) a) + self->keys[i].offset,
+                                        ((const char *) b) + self->keys[i].offset);
+      else
+        result = gtk_sorter_compare (self->keys[i].sorter,
+                                     *(gpointer *) (((const char *) a) + self->item_offset),
+                                     *(gpointer *) (((const char *) b) + self->item_offset));
+
+      if (result != GTK_ORDERING_EQUAL)
+        return self->keys[i].inverted ? - result : result;
+    }
+
+  return GTK_ORDERING_EQUAL;
+}
+
+static gboolean
+gtk_column_view_sort_keys_is_compatible (GtkSortKeys *keys,
+                                         GtkSortKeys *other)
+{
+  GtkColumnViewSortKeys *self = (GtkColumnViewSortKeys *) keys;
+  GtkColumnViewSortKeys *compare = (GtkColumnViewSortKeys *) other;
+  gsize i, j;
+
+  if (keys->klass != other->klass)
+    return FALSE;
+
+  if (self->n_keys != compare->n_keys ||
+      self->item_offset != compare->item_offset ||
+      keys->key_size != other->key_size)
+    return FALSE;
+
+  /* The order of the keys does not matter, only what is stored where */
+  for (i = 0; i < self->n_keys; i++)
+    {
+      if (self->keys[i].keys == NULL)
+        continue;
+
+      for (j = 0; j < compare->n_keys; j++)
+        {
+          if (compare->keys[j].keys != NULL &&
+              self->keys[i].offset == compare->keys[j].offset)
+            break;
+        }
+
+      if (j == compare->n_keys ||
+          !gtk_sort_keys_is_compatible (self->keys[i].keys, compare->keys[j].keys))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gtk_column_view_sort_keys_init_key (GtkSortKeys *keys,
+                                    gpointer     item,
+                                    gpointer     key_memory)
+{
+  GtkColumnViewSortKeys *self = (GtkColumnViewSortKeys *) keys;
+  char *key = (char *) key_memory;
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    {
+      if (self->keys[i].keys)
+        gtk_sort_keys_init_key (self->keys[i].keys, item, key + self->keys[i].offset);
+    }
+
+  if (self->item_offset != G_MAXSIZE)
+    *(gpointer *) (key + self->item_offset) = g_object_ref (item);
+}
+
+static void
+gtk_column_view_sort_keys_clear_key (GtkSortKeys *keys,
+                                     gpointer     key_memory)
+{
+  GtkColumnViewSortKeys *self = (GtkColumnViewSortKeys *) keys;
+  char *key = (char *) key_memory;
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    {
+      if (self->keys[i].keys)
+        gtk_sort_keys_clear_key (self->keys[i].keys, key + self->keys[i].offset);
+    }
+
+  if (self->item_offset != G_MAXSIZE)
+    g_object_unref (*(gpointer *) (key + self->item_offset));
+}
+
+static const GtkSortKeysClass GTK_COLUMN_VIEW_SORT_KEYS_CLASS =
+{
+  gtk_column_view_sort_keys_free,
+  gtk_column_view_sort_keys_compare,
+  gtk_column_view_sort_keys_is_compatible,
+  gtk_column_view_sort_keys_init_key,
+  gtk_column_view_sort_keys_clear_key,
+};
+
+static int
+compare_keys_by_column (gconstpointer a,
+                        gconstpointer b,
+                        gpointer      columns)
+{
+  GtkColumnViewColumn *ca = ((GtkColumnViewColumn **) columns)[*(const guint *) a];
+  GtkColumnViewColumn *cb = ((GtkColumnViewColumn **) columns)[*(const guint *) b];
+
+  if (ca == cb)
+    return 0;
+
+  return ca < cb ? -1 : 1;
+}
+
+static GtkSortKeys *
+gtk_column_view_sort_keys_new (GtkColumnViewSorter *self)
+{
+  GtkColumnViewSortKeys *result;
+  GtkSortKeys *keys;
+  GSequenceIter *iter;
+  GtkColumnViewColumn **columns;
+  guint *layout;
+  guint i, j, n_keys, n_cached;
+  gsize size;
+
+  n_keys = g_sequence_get_length (self->sorters);
+  if (n_keys == 0)
+    return gtk_sort_keys_new_equal ();
+
+  keys = gtk_sort_keys_alloc (&GTK_COLUMN_VIEW_SORT_KEYS_CLASS,
+                              sizeof (GtkColumnViewSortKeys) + n_keys * sizeof (GtkColumnViewSortKey),
+                              0, 1);
+  result = (GtkColumnViewSortKeys *) keys;
+  result->n_keys = n_keys;
+  result->item_offset = G_MAXSIZE;
+  keys->thread_safe = TRUE;
+
+  columns = g_newa (GtkColumnViewColumn *, n_keys);
+  layout = g_newa (guint, n_keys);
+  size = 0;
+  n_cached = 0;
+  for (iter = g_sequence_get_begin_iter (self->sorters), i = 0;
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter), i++)
+    {
+      Sorter *s = g_sequence_get (iter);
+      GtkSortKeys *sort_keys;
+
+      result->keys[i].sorter = g_object_ref (s->sorter);
+      result->keys[i].inverted = s->inverted;
+      columns[i] = s->column;
+
+      sort_keys = gtk_sorter_get_keys (s->sorter);
+      size = GTK_SORT_KEYS_ALIGN (size, gtk_sort_keys_get_key_align (sort_keys));
+      size += gtk_sort_keys_get_key_size (sort_keys);
+      /* The primary sorter always gets its keys. For the others,
+       * leave room for the item if later sorters need it.
+       */
+      if (i == 0 ||
+          (n_cached == i &&
+           (i + 1 == n_keys ? size : GTK_SORT_KEYS_ALIGN (size, G_ALIGNOF (gpointer)) + sizeof (gpointer))
+             <= GTK_COLUMN_VIEW_SORT_KEYS_MAX_SIZE))
+        {
+          result->keys[i].keys = sort_keys;
+          keys->thread_safe &= gtk_sort_keys_is_thread_safe (sort_keys);
+          layout[n_cached++] = i;
+        }
+      else
+        {
+          result->keys[i].keys = NULL;
+          gtk_sort_keys_unref (sort_keys);
+        }
+    }
+
+  /* Lay out the keys by column, not by priority */
+  g_qsort_with_data (layout, n_cached, sizeof (guint), compare_keys_by_column, columns);
+
+  for (j = 0; j < n_cached; j++)
+    {
+      i = layout[j];
+      result->keys[i].offset = GTK_SORT_KEYS_ALIGN (keys->key_size, gtk_sort_keys_get_key_align (result->keys[i].keys));
+      keys->key_size = result->keys[i].offset + gtk_sort_keys_get_key_size (result->keys[i].keys);
+      keys->key_align = MAX (keys->key_align, gtk_sort_keys_get_key_align (result->keys[i].keys));
+    }
+
+  if (n_cached < n_keys)
+    {
+      /* GtkSorters are only used from the main thread */
+      keys->thread_safe = FALSE;
+      result->item_offset = GTK_SORT_KEYS_ALIGN (keys->key_size, G_ALIGNOF (gpointer));
+      keys->key_size = result->item_offset + sizeof (gpointer);
+      keys->key_align = MAX (keys->key_align, G_ALIGNOF (gpointer));
+    }
+
+  return keys;
+}
+
+static void
+gtk_column_view_sorter_emit_changed (GtkColumnViewSorter *self,
+                                     GtkSorterChange      change)
+{
+  gtk_sorter_changed_with_keys (GTK_SORTER (self),
+                                change,
+                                gtk_column_view_sort_keys_new (self));
+}
+
 static GtkOrdering
 gtk_column_view_sorter_compare (GtkSorter *sorter,
                                 gpointer   item1,
@@ -155,7 +423,16 @@ gtk_column_view_sorter_new (void)
 static void
 gtk_column_view_sorter_changed_cb (GtkSorter *sorter, int change, gpointer data)
 {
-  gtk_sorter_changed (GTK_SORTER (data), GTK_SORTER_CHANGE_DIFFERENT);
+  GtkColumnViewSorter *self = data;
+
+  /* With other columns as tiebreakers, inverting one of them
+   * does not invert the whole order.
+   */
+  if (change != GTK_SORTER_CHANGE_INVERTED ||
+      g_sequence_get_length (self->sorters) > 1)
+    change = GTK_SORTER_CHANGE_DIFFERENT;
+
+  gtk_column_view_sorter_emit_changed (self, change);
 }
 
 static gboolean
@@ -186,6 +463,7 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
 {
   GSequenceIter *iter;
   GtkSorter *sorter;
+  GtkSorterChange change;
   Sorter *s, *first;
 
   g_return_val_if_fail (GTK_IS_COLUMN_VIEW_SORTER (self), FALSE);
@@ -202,6 +480,10 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
       if (first->column == column)
         {
           first->inverted = !first->inverted;
+          if (g_sequence_get_length (self->sorters) == 1)
+            change = GTK_SORTER_CHANGE_INVERTED;
+          else
+            change = GTK_SORTER_CHANGE_DIFFERENT;
           goto out;
         }
     }
@@ -217,13 +499,14 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
   s->inverted = FALSE;
  
   g_sequence_insert_before (iter, s);
+  change = GTK_SORTER_CHANGE_DIFFERENT;
 
   /* notify the previous first column to stop drawing an arrow */
   if (first)
     gtk_column_view_column_notify_sort (first->column);
 
 out:
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_emit_changed (self, change);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -239,7 +522,7 @@ gtk_column_view_sorter_remove_column (GtkColumnViewSorter *self,
 
   if (remove_column (self, column))
     {
-      gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+      gtk_column_view_sorter_emit_changed (self, GTK_SORTER_CHANGE_DIFFERENT);
       gtk_column_view_column_notify_sort (column);
       return TRUE;
     }
@@ -275,7 +558,7 @@ gtk_column_view_sorter_set_column (GtkColumnViewSorter *self,
  
   g_sequence_prepend (self->sorters, s);
 
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_emit_changed (self, GTK_SORTER_CHANGE_DIFFERENT);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -303,7 +586,7 @@ gtk_column_view_sorter_clear (GtkColumnViewSorter *self)
 
   g_sequence_remove_range (iter, g_sequence_get_end_iter (self->sorters));
 
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_emit_changed (self, GTK_SORTER_CHANGE_DIFFERENT);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -50,10 +50,28 @@
  * This means you do not need access to the #GtkDirectoryList but can access
  * the #GFile directly from the #GFileInfo when operating with a #GtkListView
  * or similar.
+ *
+ * If #GtkDirectoryList:recursive is set, the contents of all subdirectories
+ * are enumerated, too, and the list contains all the files below the given
+ * file.
  */
 
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
+/* upper limit when growing queries on fast filesystems */
+#define MAX_FILES_PER_QUERY (256 * FILES_PER_QUERY)
+/* we aim for a query to take about this long */
+#define QUERY_TIME (G_USEC_PER_SEC / 60)
+/* new files are announced at most once per frame */
+#define FLUSH_TIME (G_USEC_PER_SEC / 60)
+/* number of directories enumerated in parallel when recursing */
+#define MAX_ENUMERATIONS 4
+
+#define GDK_ARRAY_ELEMENT_TYPE GFileInfo *
+#define GDK_ARRAY_NAME file_infos
+#define GDK_ARRAY_TYPE_NAME FileInfos
+#define GDK_ARRAY_FREE_FUNC g_object_unref
+#include "gdk/gdkarrayimpl.c"
 
 enum {
   PROP_0,
@@ -63,6 +81,7 @@ enum {
   PROP_IO_PRIORITY,
   PROP_LOADING,
   PROP_MONITORED,
+  PROP_RECURSIVE,
   NUM_PROPERTIES
 };
 
@@ -74,11 +93,29 @@ struct _GtkDirectoryList
   GFile *file;
   GFileMonitor *monitor;
   gboolean monitored;
+  gboolean recursive;
   int io_priority;
 
   GCancellable *cancellable;
+  char *query_attributes; /* attributes we enumerate with */
+  GQueue pending_dirs; /* subdirectories waiting to be enumerated */
+  guint n_enumerations; /* number of running enumerations */
   GError *error; /* Error while loading */
-  GSequence *items; /* Use GPtrArray or GListStore here? */
+
+  FileInfos items;
+  FileInfos pending; /* loaded, but not yet announced */
+  gint64 last_flush;
+  guint flush_cb;
+};
+
+typedef struct _Enumeration Enumeration;
+
+struct _Enumeration
+{
+  GtkDirectoryList *self; /* invalid if cancelled */
+  gboolean toplevel;
+  guint n_per_query;
+  gint64 query_start;
 };
 
 struct _GtkDirectoryListClass
@@ -99,7 +136,7 @@ gtk_directory_list_get_n_items (GListModel *list)
 {
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (list);
 
-  return g_sequence_get_length (self->items);
+  return file_infos_get_size (&self->items);
 }
 
 static gpointer
@@ -107,14 +144,11 @@ gtk_directory_list_get_item (GListModel *list,
                              guint       position)
 {
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (list);
-  GSequenceIter *iter;
 
-  iter = g_sequence_get_iter_at_pos (self->items, position);
-
-  if (g_sequence_iter_is_end (iter))
+  if (position >= file_infos_get_size (&self->items))
     return NULL;
-  else
-    return g_object_ref (g_sequence_get (iter));
+
+  return g_object_ref (file_infos_get (&self->items, position));
 }
 
 static void
@@ -154,6 +188,10 @@ gtk_directory_list_set_property (GObject      *object,
       gtk_directory_list_set_monitored (self, g_value_get_boolean (value));
       break;
 
+    case PROP_RECURSIVE:
+      gtk_directory_list_set_recursive (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -194,6 +232,10 @@ gtk_directory_list_get_property (GObject     *object,
       g_value_set_boolean (value, gtk_directory_list_get_monitored (self));
       break;
 
+    case PROP_RECURSIVE:
+      g_value_set_boolean (value, gtk_directory_list_get_recursive (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -208,6 +250,9 @@ gtk_directory_list_stop_loading (GtkDirectoryList *self)
 
   g_cancellable_cancel (self->cancellable);
   g_clear_object (&self->cancellable);
+  g_clear_pointer (&self->query_attributes, g_free);
+  g_queue_clear_full (&self->pending_dirs, g_object_unref);
+  self->n_enumerations = 0;
   return TRUE;
 }
 
@@ -237,7 +282,9 @@ gtk_directory_list_dispose (GObject *object)
   g_clear_pointer (&self->attributes, g_free);
 
   g_clear_error (&self->error);
-  g_clear_pointer (&self->items, g_sequence_free);
+  g_clear_handle_id (&self->flush_cb, g_source_remove);
+  file_infos_clear (&self->items);
+  file_infos_clear (&self->pending);
 
   G_OBJECT_CLASS (gtk_directory_list_parent_class)->dispose (object);
 }
@@ -323,13 +370,27 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                             TRUE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDirectoryList:recursive:
+   *
+   * %TRUE if subdirectories are enumerated, too
+   */
+  properties[PROP_RECURSIVE] =
+      g_param_spec_boolean ("recursive",
+                            P_("recursive"),
+                            P_("TRUE if subdirectories are enumerated, too"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
 static void
 gtk_directory_list_init (GtkDirectoryList *self)
 {
-  self->items = g_sequence_new (g_object_unref);
+  file_infos_init (&self->items);
+  file_infos_init (&self->pending);
+  g_queue_init (&self->pending_dirs);
   self->io_priority = G_PRIORITY_DEFAULT;
   self->monitored = TRUE;
 }
@@ -356,16 +417,76 @@ gtk_directory_list_new (const char *attributes,
                        NULL);
 }
 
+static void
+gtk_directory_list_flush (GtkDirectoryList *self)
+{
+  guint position, n;
+
+  g_clear_handle_id (&self->flush_cb, g_source_remove);
+  self->last_flush = g_get_monotonic_time ();
+
+  n = file_infos_get_size (&self->pending);
+  if (n == 0)
+    return;
+
+  position = file_infos_get_size (&self->items);
+  file_infos_splice (&self->items, position, 0, FALSE, file_infos_get_data (&self->pending), n);
+  /* the references moved to self->items */
+  file_infos_splice (&self->pending, 0, n, TRUE, NULL, 0);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, n);
+}
+
+static gboolean
+gtk_directory_list_flush_cb (gpointer data)
+{
+  GtkDirectoryList *self = data;
+
+  self->flush_cb = 0;
+  gtk_directory_list_flush (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Emitting items-changed for every query causes a relayout of the
+ * list widgets each time, so we collect the files of all queries
+ * that arrive within one frame and announce them together.
+ */
+static void
+gtk_directory_list_queue_flush (GtkDirectoryList *self)
+{
+  gint64 elapsed;
+
+  if (self->flush_cb != 0)
+    return;
+
+  elapsed = g_get_monotonic_time () - self->last_flush;
+  if (elapsed >= FLUSH_TIME)
+    {
+      gtk_directory_list_flush (self);
+      return;
+    }
+
+  self->flush_cb = g_timeout_add_full (self->io_priority,
+                                       (FLUSH_TIME - elapsed) / 1000 + 1,
+                                       gtk_directory_list_flush_cb,
+                                       self,
+                                       NULL);
+  g_source_set_name_by_id (self->flush_cb, "[gtk] gtk_directory_list_flush_cb");
+}
+
 static void
 gtk_directory_list_clear_items (GtkDirectoryList *self)
 {
   guint n_items;
 
-  n_items = g_sequence_get_length (self->items);
+  g_clear_handle_id (&self->flush_cb, g_source_remove);
+  file_infos_set_size (&self->pending, 0);
+
+  n_items = file_infos_get_size (&self->items);
   if (n_items > 0)
     {
-      g_sequence_remove_range (g_sequence_get_begin_iter (self->items),
-                               g_sequence_get_end_iter (self->items));
+      file_infos_set_size (&self->items, 0);
 
       g_list_model_items_changed (G_LIST_MODEL (self), 0, n_items, 0);
     }
@@ -385,15 +506,97 @@ gtk_directory_list_enumerator_closed_cb (GObject      *source,
   g_file_enumerator_close_finish (G_FILE_ENUMERATOR (source), res, NULL);
 }
 
+static void gtk_directory_list_enumerate (GtkDirectoryList *self,
+                                          GFile            *dir,
+                                          gboolean          toplevel);
+
+static void
+gtk_directory_list_enumerate_pending (GtkDirectoryList *self)
+{
+  while (self->n_enumerations < MAX_ENUMERATIONS &&
+         !g_queue_is_empty (&self->pending_dirs))
+    {
+      GFile *dir = g_queue_pop_head (&self->pending_dirs);
+      gtk_directory_list_enumerate (self, dir, FALSE);
+      g_object_unref (dir);
+    }
+}
+
+static void
+gtk_directory_list_enumeration_done (Enumeration *enumeration,
+                                     GError      *error)
+{
+  GtkDirectoryList *self = enumeration->self;
+  gboolean toplevel = enumeration->toplevel;
+  GCancellable *cancellable;
+
+  g_slice_free (Enumeration, enumeration);
+  self->n_enumerations--;
+
+  /* Errors in subdirectories - usually missing permissions - are
+   * not fatal, we just skip those directories. */
+  if (error && toplevel)
+    self->error = error;
+  else
+    g_clear_error (&error);
+
+  gtk_directory_list_enumerate_pending (self);
+
+  if (self->n_enumerations > 0)
+    return;
+
+  /* handlers of items-changed might restart loading */
+  cancellable = g_object_ref (self->cancellable);
+  gtk_directory_list_flush (self);
+  if (g_cancellable_is_cancelled (cancellable))
+    {
+      g_object_unref (cancellable);
+      return;
+    }
+  g_object_unref (cancellable);
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  g_clear_object (&self->cancellable);
+  g_clear_pointer (&self->query_attributes, g_free);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
+
+  if (self->error)
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ERROR]);
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+static void gtk_directory_list_got_files_cb (GObject      *source,
+                                             GAsyncResult *res,
+                                             gpointer      user_data);
+
+static void
+gtk_directory_list_query_files (Enumeration     *enumeration,
+                                GFileEnumerator *enumerator)
+{
+  GtkDirectoryList *self = enumeration->self;
+
+  enumeration->query_start = g_get_monotonic_time ();
+  g_file_enumerator_next_files_async (enumerator,
+                                      enumeration->n_per_query,
+                                      self->io_priority,
+                                      self->cancellable,
+                                      gtk_directory_list_got_files_cb,
+                                      enumeration);
+}
+
 static void
 gtk_directory_list_got_files_cb (GObject      *source,
                                  GAsyncResult *res,
                                  gpointer      user_data)
 {
-  GtkDirectoryList *self = user_data; /* invalid if cancelled */
+  Enumeration *enumeration = user_data;
+  GtkDirectoryList *self = enumeration->self; /* invalid if cancelled */
   GFileEnumerator *enumerator = G_FILE_ENUMERATOR (source);
   GError *error = NULL;
   GList *l, *files;
+  gint64 elapsed;
   guint n;
 
   files = g_file_enumerator_next_files_finish (enumerator, res, &error);
@@ -403,6 +606,7 @@ gtk_directory_list_got_files_cb (GObject      *source,
       if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         {
           g_clear_error (&error);
+          g_slice_free (Enumeration, enumeration);
           return;
         }
 
@@ -412,18 +616,7 @@ gtk_directory_list_got_files_cb (GObject      *source,
                                      gtk_directory_list_enumerator_closed_cb,
                                      NULL);
 
-      g_object_freeze_notify (G_OBJECT (self));
-
-      g_clear_object (&self->cancellable);
-      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
-
-      if (error)
-        {
-          self->error = error;
-          g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ERROR]);
-        }
-
-      g_object_thaw_notify (G_OBJECT (self));
+      gtk_directory_list_enumeration_done (enumeration, error);
       return;
     }
 
@@ -436,21 +629,30 @@ gtk_directory_list_got_files_cb (GObject      *source,
       info = l->data;
       file = g_file_enumerator_get_child (enumerator, info);
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
+      /* don't follow symlinks, they can create loops */
+      if (self->recursive &&
+          g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+          !g_file_info_get_is_symlink (info))
+        g_queue_push_tail (&self->pending_dirs, g_object_ref (file));
       g_object_unref (file);
-      g_sequence_append (self->items, info);
+      file_infos_append (&self->pending, info);
       n++;
     }
   g_list_free (files);
 
-  g_file_enumerator_next_files_async (enumerator,
-                                      g_file_is_native (self->file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
-                                      self->io_priority,
-                                      self->cancellable,
-                                      gtk_directory_list_got_files_cb,
-                                      self);
+  /* Grow queries while the filesystem answers them quickly,
+   * shrink them again when it gets slow. */
+  elapsed = g_get_monotonic_time () - enumeration->query_start;
+  if (n == enumeration->n_per_query && elapsed < QUERY_TIME / 2)
+    enumeration->n_per_query = MIN (2 * enumeration->n_per_query, MAX_FILES_PER_QUERY);
+  else if (elapsed > 2 * QUERY_TIME)
+    enumeration->n_per_query = MAX (enumeration->n_per_query / 2, FILES_PER_QUERY);
+
+  gtk_directory_list_query_files (enumeration, enumerator);
 
-  if (n > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
+  gtk_directory_list_enumerate_pending (self);
+
+  gtk_directory_list_queue_flush (self);
 }
 
 static void
@@ -458,7 +660,7 @@ gtk_directory_list_got_enumerator_cb (GObject      *source,
                                       GAsyncResult *res,
                                       gpointer      user_data)
 {
-  GtkDirectoryList *self = user_data; /* invalid if cancelled */
+  Enumeration *enumeration = user_data;
   GFile *file = G_FILE (source);
   GFileEnumerator *enumerator;
   GError *error = NULL;
@@ -469,27 +671,40 @@ gtk_directory_list_got_enumerator_cb (GObject      *source,
       if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         {
           g_clear_error (&error);
+          g_slice_free (Enumeration, enumeration);
           return;
         }
 
-      g_object_freeze_notify (G_OBJECT (self));
-      self->error = error;
-      g_clear_object (&self->cancellable);
-      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
-      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ERROR]);
-      g_object_thaw_notify (G_OBJECT (self));
+      gtk_directory_list_enumeration_done (enumeration, error);
       return;
     }
 
-  g_file_enumerator_next_files_async (enumerator,
-                                      g_file_is_native (file) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
-                                      self->io_priority,
-                                      self->cancellable,
-                                      gtk_directory_list_got_files_cb,
-                                      self);
+  gtk_directory_list_query_files (enumeration, enumerator);
   g_object_unref (enumerator);
 }
 
+static void
+gtk_directory_list_enumerate (GtkDirectoryList *self,
+                              GFile            *dir,
+                              gboolean          toplevel)
+{
+  Enumeration *enumeration;
+
+  enumeration = g_slice_new0 (Enumeration);
+  enumeration->self = self;
+  enumeration->toplevel = toplevel;
+  enumeration->n_per_query = FILES_PER_QUERY;
+
+  self->n_enumerations++;
+  g_file_enumerate_children_async (dir,
+                                   self->query_attributes,
+                                   G_FILE_QUERY_INFO_NONE,
+                                   self->io_priority,
+                                   self->cancellable,
+                                   gtk_directory_list_got_enumerator_cb,
+                                   enumeration);
+}
+
 static void
 gtk_directory_list_start_loading (GtkDirectoryList *self)
 {
@@ -506,13 +721,17 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
     }
 
   self->cancellable = g_cancellable_new ();
-  g_file_enumerate_children_async (self->file,
-                                   self->attributes,
-                                   G_FILE_QUERY_INFO_NONE,
-                                   self->io_priority,
-                                   self->cancellable,
-                                   gtk_directory_list_got_enumerator_cb,
-                                   self);
+  /* we need to know which files are directories to recurse */
+  if (self->recursive && self->attributes)
+    self->query_attributes = g_strconcat (self->attributes, ",standard::type,standard::is-symlink", NULL);
+  else if (self->recursive)
+    self->query_attributes = g_strdup ("standard::type,standard::is-symlink");
+  else
+    self->query_attributes = g_strdup (self->attributes);
+  /* show the first files quickly */
+  self->last_flush = 0;
+
+  gtk_directory_list_enumerate (self, self->file, TRUE);
 
   if (!was_loading)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
@@ -526,16 +745,38 @@ got_new_file_info_cb (GObject      *source,
   GFile *file = G_FILE (source);
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (data);
   GFileInfo *info;
-  guint position;
 
   info = g_file_query_info_finish (file, res, NULL);
   if (!info)
     return;
 
   g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
-  position = g_sequence_get_length (self->items);
-  g_sequence_append (self->items, info);
-  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, 1);
+  file_infos_append (&self->pending, info);
+  gtk_directory_list_queue_flush (self);
+}
+
+static gboolean
+gtk_directory_list_find_file (GtkDirectoryList *self,
+                              GFile            *file,
+                              guint            *position)
+{
+  guint i;
+
+  /* the file might not have been announced yet */
+  gtk_directory_list_flush (self);
+
+  for (i = 0; i < file_infos_get_size (&self->items); i++)
+    {
+      GFileInfo *item = file_infos_get (&self->items, i);
+      GFile *f = G_FILE (g_file_info_get_attribute_object (item, "standard::file"));
+      if (g_file_equal (f, file))
+        {
+          *position = i;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
 }
 
 static void
@@ -546,7 +787,7 @@ got_existing_file_info_cb (GObject      *source,
   GFile *file = G_FILE (source);
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (data);
   GFileInfo *info;
-  GSequenceIter *iter;
+  guint position;
 
   info = g_file_query_info_finish (file, res, NULL);
   if (!info)
@@ -554,41 +795,27 @@ got_existing_file_info_cb (GObject      *source,
 
   g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
 
-  for (iter = g_sequence_get_begin_iter (self->items);
-       !g_sequence_iter_is_end (iter);
-       iter = g_sequence_iter_next (iter))
+  if (gtk_directory_list_find_file (self, file, &position))
     {
-      GFileInfo *item = g_sequence_get (iter);
-      GFile *f = G_FILE (g_file_info_get_attribute_object (item, "standard::file"));
-      if (g_file_equal (f, file))
-        {
-          guint position = g_sequence_iter_get_position (iter);
-          g_sequence_set (iter, g_object_ref (info));
-          g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
-          break;
-        }
+      GFileInfo **item = file_infos_index (&self->items, position);
+      g_object_unref (*item);
+      *item = info;
+      g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
     }
+  else
+    g_object_unref (info);
 }
 
 static void
 gtk_directory_list_remove_file (GtkDirectoryList *self,
                                 GFile            *file)
 {
-  GSequenceIter *iter;
+  guint position;
 
-  for (iter = g_sequence_get_begin_iter (self->items);
-       !g_sequence_iter_is_end (iter);
-       iter = g_sequence_iter_next (iter))
+  if (gtk_directory_list_find_file (self, file, &position))
     {
-      GFileInfo *item = g_sequence_get (iter);
-      GFile *f = G_FILE (g_file_info_get_attribute_object (item, "standard::file"));
-      if (g_file_equal (f, file))
-        {
-          guint position = g_sequence_iter_get_position (iter);
-          g_sequence_remove (iter);
-          g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
-          break;
-        }
+      file_infos_splice (&self->items, position, 1, FALSE, NULL, 0);
+      g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
     }
 }
 
@@ -889,3 +1116,55 @@ gtk_directory_list_get_monitored (GtkDirectoryList *self)
 
   return self->monitored;
 }
+
+/**
+ * gtk_directory_list_set_recursive:
+ * @self: a #GtkDirectoryList
+ * @recursive: %TRUE to enumerate subdirectories
+ *
+ * Sets whether the directory list will also enumerate the contents
+ * of all subdirectories. The files of all directories end up in
+ * a single flat list, use the "standard::file" attribute of the
+ * #GFileInfos to find out where they are located.
+ *
+ * Symbolic links to directories are not followed. Subdirectories
+ * that cannot be enumerated are skipped without setting
+ * #GtkDirectoryList:error.
+ *
+ * Only the toplevel directory is monitored for changes.
+ */
+void
+gtk_directory_list_set_recursive (GtkDirectoryList *self,
+                                  gboolean          recursive)
+{
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (self->recursive == recursive)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  self->recursive = recursive;
+
+  gtk_directory_list_start_loading (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_RECURSIVE]);
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * gtk_directory_list_get_recursive:
+ * @self: a #GtkDirectoryList
+ *
+ * Returns whether the directory list enumerates subdirectories.
+ *
+ * Returns: %TRUE if subdirectories are enumerated
+ */
+gboolean
+gtk_directory_list_get_recursive (GtkDirectoryList *self)
+{
+  g_return_val_if_fail (GTK_IS_DIRECTORY_LIST (self), FALSE);
+
+  return self->recursive;
+}
@@ -20,7 +20,7 @@
 
 #include "config.h"
 
-#include "gtkexpression.h"
+#include "gtkexpressionprivate.h"
 
 #include <gobject/gvaluecollector.h>
 
@@ -1802,6 +1802,40 @@ gtk_expression_is_static (GtkExpression *self)
   return GTK_EXPRESSION_GET_CLASS (self)->is_static (self);
 }
 
+/*<private>
+ * gtk_expression_is_thread_safe:
+ * @self: (nullable): a #GtkExpression
+ *
+ * Checks if @self can be evaluated from a thread other than the
+ * main thread. This is the case for chains of property lookups ending
+ * in a constant or the item itself, as long as the item isn't modified
+ * concurrently.
+ * Expressions that run closures or use objects are not thread-safe.
+ *
+ * Property getters are application code, so this only holds if the
+ * application guarantees that they are thread-safe. Only evaluate
+ * expressions from other threads where the application explicitly
+ * opted into that, like #GtkSortListModel:threaded.
+ *
+ * Returns: %TRUE if evaluating @self is thread-safe
+ **/
+gboolean
+gtk_expression_is_thread_safe (GtkExpression *self)
+{
+  while (self)
+    {
+      if (G_TYPE_CHECK_INSTANCE_TYPE (self, GTK_TYPE_CONSTANT_EXPRESSION))
+        return TRUE;
+
+      if (!G_TYPE_CHECK_INSTANCE_TYPE (self, GTK_TYPE_PROPERTY_EXPRESSION))
+        return FALSE;
+
+      self = gtk_property_expression_get_expression (self);
+    }
+
+  return TRUE;
+}
+
 static gboolean
 gtk_expression_watch_is_watching (GtkExpressionWatch *watch)
 {
@@ -2137,3 +2171,211 @@ gtk_expression_bind (GtkExpression *self,
 }
 
 /* }}} */
+
+/* {{{ GtkExpressionCache */
+
+/*< private >
+ * GtkExpressionCache:
+ *
+ * Remembers the results of evaluating an expression for items, so that
+ * sorters and filters that look at the same items over and over do not
+ * need to walk the expression every time.
+ *
+ * Every cached item is watched via gtk_expression_watch(), and its result
+ * is forgotten when the watch notifies. Items are not kept alive by the
+ * cache.
+ *
+ * Only chains of property lookups are cached, because for those the
+ * watch is guaranteed to notice all changes. Closures might depend on
+ * state that isn't visible to GTK. A single property lookup is cheaper
+ * than a cache lookup and watching the item, so it isn't cached either.
+ *
+ * The cache holds at most %GTK_EXPRESSION_CACHE_MAX_ENTRIES items. Once
+ * it is full, other items are evaluated without caching until cached
+ * items go away.
+ *
+ * The cache may only be used from the thread it was created in.
+ * Evaluations in other threads bypass it.
+ */
+#define GTK_EXPRESSION_CACHE_MAX_ENTRIES 65536
+
+struct _GtkExpressionCache
+{
+  GtkExpression *expression;
+  gboolean enabled;
+  GThread *thread;
+  GHashTable *entries; /* item => GtkExpressionCacheEntry */
+};
+
+typedef struct _GtkExpressionCacheEntry GtkExpressionCacheEntry;
+
+struct _GtkExpressionCacheEntry
+{
+  GtkExpressionCache *cache;
+  gpointer item;
+  GtkExpressionWatch *watch;
+  guint valid : 1;
+  guint result : 1;
+  GValue value;
+};
+
+static void
+gtk_expression_cache_entry_free (gpointer data)
+{
+  GtkExpressionCacheEntry *entry = data;
+
+  if (entry->result)
+    g_value_unset (&entry->value);
+
+  g_slice_free (GtkExpressionCacheEntry, entry);
+}
+
+static void
+gtk_expression_cache_entry_notify (gpointer data)
+{
+  GtkExpressionCacheEntry *entry = data;
+
+  if (entry->watch->this == NULL)
+    {
+      /* The item is being finalized. The watch will unwatch itself
+       * and free the entry afterwards. */
+      g_hash_table_remove (entry->cache->entries, entry->item);
+      return;
+    }
+
+  if (entry->result)
+    g_value_unset (&entry->value);
+  entry->valid = FALSE;
+  entry->result = FALSE;
+}
+
+static guint
+gtk_expression_get_property_depth (GtkExpression *expression)
+{
+  guint depth = 0;
+
+  while (expression && G_TYPE_CHECK_INSTANCE_TYPE (expression, GTK_TYPE_PROPERTY_EXPRESSION))
+    {
+      depth++;
+      expression = gtk_property_expression_get_expression (expression);
+    }
+
+  return depth;
+}
+
+/*< private >
+ * gtk_expression_cache_new:
+ * @expression: the expression to cache
+ *
+ * Creates a new cache for the results of @expression.
+ *
+ * Returns: (transfer full): a new #GtkExpressionCache
+ */
+GtkExpressionCache *
+gtk_expression_cache_new (GtkExpression *expression)
+{
+  GtkExpressionCache *self;
+
+  g_return_val_if_fail (GTK_IS_EXPRESSION (expression), NULL);
+
+  self = g_slice_new0 (GtkExpressionCache);
+  self->expression = gtk_expression_ref (expression);
+  self->enabled = gtk_expression_get_property_depth (expression) > 1 &&
+                  gtk_expression_is_thread_safe (expression);
+  self->thread = g_thread_self ();
+  self->entries = g_hash_table_new (NULL, NULL);
+
+  return self;
+}
+
+/*< private >
+ * gtk_expression_cache_free:
+ * @self: a #GtkExpressionCache
+ *
+ * Frees the cache and stops watching all items.
+ */
+void
+gtk_expression_cache_free (GtkExpressionCache *self)
+{
+  GHashTableIter iter;
+  gpointer entry;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->thread == g_thread_self ());
+
+  g_hash_table_iter_init (&iter, self->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &entry))
+    {
+      g_hash_table_iter_remove (&iter);
+      gtk_expression_watch_unwatch (((GtkExpressionCacheEntry *) entry)->watch);
+    }
+
+  g_hash_table_unref (self->entries);
+  gtk_expression_unref (self->expression);
+
+  g_slice_free (GtkExpressionCache, self);
+}
+
+/*< private >
+ * gtk_expression_cache_evaluate:
+ * @self: a #GtkExpressionCache
+ * @item: (type GObject) (nullable): the item to evaluate for
+ * @value: an empty #GValue
+ *
+ * Works like gtk_expression_evaluate(), but reuses the last result for
+ * @item if the expression cannot have changed since.
+ *
+ * Strings are not copied, so @value is only valid until @item changes.
+ * Unset it before returning to the main loop.
+ *
+ * Returns: %TRUE if the expression could be evaluated
+ */
+gboolean
+gtk_expression_cache_evaluate (GtkExpressionCache *self,
+                               gpointer            item,
+                               GValue             *value)
+{
+  GtkExpressionCacheEntry *entry;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  if (!self->enabled || !G_IS_OBJECT (item) || self->thread != g_thread_self ())
+    return gtk_expression_evaluate (self->expression, item, value);
+
+  entry = g_hash_table_lookup (self->entries, item);
+  if (entry == NULL)
+    {
+      if (g_hash_table_size (self->entries) >= GTK_EXPRESSION_CACHE_MAX_ENTRIES)
+        return gtk_expression_evaluate (self->expression, item, value);
+
+      entry = g_slice_new0 (GtkExpressionCacheEntry);
+      entry->cache = self;
+      entry->item = item;
+      entry->watch = gtk_expression_watch (self->expression,
+                                           item,
+                                           gtk_expression_cache_entry_notify,
+                                           entry,
+                                           gtk_expression_cache_entry_free);
+      g_hash_table_insert (self->entries, item, entry);
+    }
+
+  if (!entry->valid)
+    {
+      entry->result = gtk_expression_evaluate (self->expression, item, &entry->value);
+      entry->valid = TRUE;
+    }
+
+  if (!entry->result)
+    return FALSE;
+
+  g_value_init (value, G_VALUE_TYPE (&entry->value));
+  if (G_VALUE_HOLDS_STRING (&entry->value))
+    g_value_set_static_string (value, g_value_get_string (&entry->value));
+  else
+    g_value_copy (&entry->value, value);
+
+  return TRUE;
+}
+
+/* }}} */
@@ -0,0 +1,34 @@
+/*
+ * Copyright © 2020 Benjamin Otte
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_EXPRESSION_PRIVATE_H__
+#define __GTK_EXPRESSION_PRIVATE_H__
+
+#include <gtk/gtkexpression.h>
+
+gboolean                gtk_expression_is_thread_safe           (GtkExpression          *self);
+
+typedef struct _GtkExpressionCache GtkExpressionCache;
+
+GtkExpressionCache *    gtk_expression_cache_new                (GtkExpression          *expression);
+void                    gtk_expression_cache_free               (GtkExpressionCache     *self);
+gboolean                gtk_expression_cache_evaluate           (GtkExpressionCache     *self,
+                                                                 gpointer                item,
+                                                                 GValue                 *value);
+
+
+#endif /* __GTK_EXPRESSION_PRIVATE_H__ */
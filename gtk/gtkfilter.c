@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkfilter.h"
+#include "gtkfilterprivate.h"
 
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
@@ -55,7 +55,13 @@ enum {
   LAST_SIGNAL
 };
 
-G_DEFINE_TYPE (GtkFilter, gtk_filter, G_TYPE_OBJECT)
+typedef struct _GtkFilterPrivate GtkFilterPrivate;
+struct _GtkFilterPrivate
+{
+  gboolean thread_safe;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (GtkFilter, gtk_filter, G_TYPE_OBJECT)
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
@@ -180,3 +186,39 @@ gtk_filter_changed (GtkFilter       *self,
   g_signal_emit (self, signals[CHANGED], 0, change);
 }
 
+/*<private>
+ * gtk_filter_is_thread_safe:
+ * @self: a #GtkFilter
+ *
+ * Checks if gtk_filter_match() may be called for different items
+ * from multiple threads at once, as long as the filter doesn't change
+ * while that happens.
+ *
+ * Returns: %TRUE if matching is thread-safe
+ **/
+gboolean
+gtk_filter_is_thread_safe (GtkFilter *self)
+{
+  GtkFilterPrivate *priv = gtk_filter_get_instance_private (self);
+
+  return priv->thread_safe;
+}
+
+/*<private>
+ * gtk_filter_set_thread_safe:
+ * @self: a #GtkFilter
+ * @thread_safe: if gtk_filter_match() is thread-safe
+ *
+ * Declares whether @self can match items from multiple threads.
+ * Filters must update this before emitting #GtkFilter::changed.
+ *
+ * Filters are not thread-safe by default.
+ **/
+void
+gtk_filter_set_thread_safe (GtkFilter *self,
+                            gboolean   thread_safe)
+{
+  GtkFilterPrivate *priv = gtk_filter_get_instance_private (self);
+
+  priv->thread_safe = thread_safe;
+}
@@ -22,8 +22,19 @@
 #include "gtkfilterlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
+#include "gtkthreadpoolprivate.h"
+
+/* Minimum number of pending items before filtering is split into
+ * chunks that are matched on a thread pool.
+ *
+ * This only happens for threaded models with thread-safe filters.
+ */
+#define GTK_FILTER_PARALLEL_MIN (2048)
+#define GTK_FILTER_CHUNK_SIZE (512)
+#define GTK_FILTER_MIN_CHUNK_SIZE (32)
 
 /**
  * SECTION:gtkfilterlistmodel
@@ -39,6 +50,9 @@
  * The model can be set up to do incremental searching, so that
  * filtering long lists doesn't block the UI. See
  * gtk_filter_list_model_set_incremental() for details.
+ *
+ * For filters that support it, filtering can also be spread over
+ * multiple threads. See gtk_filter_list_model_set_threaded().
  */
 
 enum {
@@ -47,9 +61,12 @@ enum {
   PROP_INCREMENTAL,
   PROP_MODEL,
   PROP_PENDING,
+  PROP_THREADED,
   NUM_PROPERTIES
 };
 
+typedef struct _GtkFilterJob GtkFilterJob;
+
 struct _GtkFilterListModel
 {
   GObject parent_instance;
@@ -58,6 +75,7 @@ struct _GtkFilterListModel
   GtkFilter *filter;
   GtkFilterMatch strictness;
   gboolean incremental;
+  gboolean threaded;
 
   GtkBitset *matches; /* NULL if strictness != GTK_FILTER_MATCH_SOME */
   GtkBitset *pending; /* not yet filtered items or NULL if all filtered */
@@ -71,6 +89,129 @@ struct _GtkFilterListModelClass
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
+/* A GtkFilterJob matches a set of items, split into chunks. Chunks are
+ * processed by the thread pool and by the main thread, whichever gets
+ * to them first.
+ *
+ * The items are fetched from the model on the main thread and the
+ * main thread waits for the job to finish, so the filter can't
+ * change while it is matching in other threads. Filters free their
+ * state when they change, so the job can't outlive the call.
+ *
+ * The main thread only waits for the chunks other threads started
+ * when it ran out of chunks itself. Chunks get smaller towards the
+ * end of the job to keep that wait short.
+ */
+struct _GtkFilterJob
+{
+  int ref_count;
+
+  GtkFilter *filter;
+  gpointer *items;
+  guint *positions;
+  guint n_items;
+  guint n_threads; /* including the main thread */
+  int next_item; /* atomic */
+
+  GMutex lock;
+  GCond cond;
+  GtkBitset *matches; /* protected by lock */
+  guint n_done; /* protected by lock */
+};
+
+static GtkFilterJob *
+gtk_filter_job_ref (GtkFilterJob *job)
+{
+  g_atomic_int_inc (&job->ref_count);
+
+  return job;
+}
+
+/* The contents are released by the main thread once the job is done,
+ * so that items are never finalized in a thread.
+ */
+static void
+gtk_filter_job_unref (GtkFilterJob *job)
+{
+  if (!g_atomic_int_dec_and_test (&job->ref_count))
+    return;
+
+  g_mutex_clear (&job->lock);
+  g_cond_clear (&job->cond);
+  g_slice_free (GtkFilterJob, job);
+}
+
+/* Claims the next chunk of items. Every chunk is a fraction of the
+ * remaining items, so the last chunks are small.
+ */
+static gboolean
+gtk_filter_job_claim (GtkFilterJob *job,
+                      guint        *start,
+                      guint        *end)
+{
+  guint first, size;
+
+  do
+    {
+      first = g_atomic_int_get (&job->next_item);
+      if (first >= job->n_items)
+        return FALSE;
+
+      size = (job->n_items - first) / (2 * job->n_threads);
+      size = CLAMP (size, GTK_FILTER_MIN_CHUNK_SIZE, GTK_FILTER_CHUNK_SIZE);
+      size = MIN (size, job->n_items - first);
+    }
+  while (!g_atomic_int_compare_and_exchange (&job->next_item, first, first + size));
+
+  *start = first;
+  *end = first + size;
+
+  return TRUE;
+}
+
+static void
+gtk_filter_job_run (GtkFilterJob *job)
+{
+  guint found[GTK_FILTER_CHUNK_SIZE];
+  guint i, start, end, n_found;
+
+  while (gtk_filter_job_claim (job, &start, &end))
+    {
+      n_found = 0;
+
+      for (i = start; i < end; i++)
+        {
+          if (gtk_filter_match (job->filter, job->items[i]))
+            found[n_found++] = job->positions[i];
+        }
+
+      g_mutex_lock (&job->lock);
+      gtk_bitset_add_many (job->matches, found, n_found);
+      job->n_done += end - start;
+      if (job->n_done == job->n_items)
+        g_cond_broadcast (&job->cond);
+      g_mutex_unlock (&job->lock);
+    }
+}
+
+static void
+gtk_filter_job_thread (gpointer data)
+{
+  GtkFilterJob *job = data;
+
+  gtk_filter_job_run (job);
+  gtk_filter_job_unref (job);
+}
+
+static void
+gtk_filter_job_wait (GtkFilterJob *job)
+{
+  g_mutex_lock (&job->lock);
+  while (job->n_done < job->n_items)
+    g_cond_wait (&job->cond, &job->lock);
+  g_mutex_unlock (&job->lock);
+}
+
 static GType
 gtk_filter_list_model_get_item_type (GListModel *list)
 {
@@ -156,12 +297,81 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   return visible;
 }
 
+static gboolean
+gtk_filter_list_model_should_thread (GtkFilterListModel *self)
+{
+  return self->threaded &&
+         gtk_filter_is_thread_safe (self->filter) &&
+         gtk_bitset_get_size (self->pending) >= GTK_FILTER_PARALLEL_MIN &&
+         g_get_num_processors () > 1;
+}
+
+/* Matches the first @n_items pending items on the thread pool and
+ * merges the results once all of them are done.
+ */
+static void
+gtk_filter_list_model_run_filter_threaded (GtkFilterListModel *self,
+                                           guint               n_items)
+{
+  GtkFilterJob *job;
+  GtkBitsetIter iter;
+  guint i, pos, n_threads;
+  gboolean more;
+
+  job = g_slice_new0 (GtkFilterJob);
+  job->ref_count = 1;
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->cond);
+  job->filter = g_object_ref (self->filter);
+  job->n_items = MIN (n_items, gtk_bitset_get_size (self->pending));
+  job->items = g_new (gpointer, job->n_items);
+  job->positions = g_new (guint, job->n_items);
+  job->matches = gtk_bitset_new_empty ();
+
+  for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
+       i < job->n_items;
+       i++, more = gtk_bitset_iter_next (&iter, &pos))
+    {
+      g_assert (more);
+      job->items[i] = g_list_model_get_item (self->model, pos);
+      job->positions[i] = pos;
+    }
+
+  n_threads = MIN (job->n_items / GTK_FILTER_CHUNK_SIZE, gtk_thread_pool_get_max_threads ());
+  job->n_threads = n_threads + 1;
+  for (i = 0; i < n_threads; i++)
+    gtk_thread_pool_push (gtk_filter_job_thread, gtk_filter_job_ref (job));
+
+  gtk_filter_job_run (job);
+  gtk_filter_job_wait (job);
+
+  gtk_bitset_union (self->matches, job->matches);
+  gtk_bitset_unref (job->matches);
+
+  if (job->n_items < gtk_bitset_get_size (self->pending))
+    gtk_bitset_remove_range_closed (self->pending, 0, job->positions[job->n_items - 1]);
+  else
+    {
+      g_clear_pointer (&self->pending, gtk_bitset_unref);
+      gtk_bitset_optimize (self->matches);
+    }
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+
+  for (i = 0; i < job->n_items; i++)
+    g_object_unref (job->items[i]);
+  g_free (job->items);
+  g_free (job->positions);
+  g_object_unref (job->filter);
+  gtk_filter_job_unref (job);
+}
+
 static void
 gtk_filter_list_model_run_filter (GtkFilterListModel *self,
                                   guint               n_steps)
 {
+  guint found[GTK_FILTER_CHUNK_SIZE];
   GtkBitsetIter iter;
-  guint i, pos;
+  guint i, pos, n_found;
   gboolean more;
 
   g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
@@ -169,18 +379,42 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   if (self->pending == NULL)
     return;
 
+  if (gtk_filter_list_model_should_thread (self))
+    {
+      guint n_threads = g_get_num_processors ();
+
+      /* do one step per thread, so incremental filtering makes
+       * the same progress per step on every thread
+       */
+      gtk_filter_list_model_run_filter_threaded (self, n_steps > G_MAXUINT / n_threads ? G_MAXUINT : n_steps * n_threads);
+      return;
+    }
+
+  n_found = 0;
   for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
        i < n_steps && more;
        i++, more = gtk_bitset_iter_next (&iter, &pos))
     {
-      if (gtk_filter_list_model_run_filter_on_item (self, pos))
-        gtk_bitset_add (self->matches, pos);
+      if (!gtk_filter_list_model_run_filter_on_item (self, pos))
+        continue;
+
+      found[n_found++] = pos;
+      if (n_found == G_N_ELEMENTS (found))
+        {
+          gtk_bitset_add_many (self->matches, found, n_found);
+          n_found = 0;
+        }
     }
+  gtk_bitset_add_many (self->matches, found, n_found);
 
   if (more)
     gtk_bitset_remove_range_closed (self->pending, 0, pos - 1);
   else
-    g_clear_pointer (&self->pending, gtk_bitset_unref);
+    {
+      g_clear_pointer (&self->pending, gtk_bitset_unref);
+      /* keep the final result compact */
+      gtk_bitset_optimize (self->matches);
+    }
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
 
   return;
@@ -342,6 +576,10 @@ gtk_filter_list_model_set_property (GObject      *object,
       gtk_filter_list_model_set_model (self, g_value_get_object (value));
       break;
 
+    case PROP_THREADED:
+      gtk_filter_list_model_set_threaded (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -374,6 +612,10 @@ gtk_filter_list_model_get_property (GObject     *object,
       g_value_set_uint (value, gtk_filter_list_model_get_pending (self));
       break;
 
+    case PROP_THREADED:
+      g_value_set_boolean (value, self->threaded);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -603,6 +845,21 @@ gtk_filter_list_model_class_init (GtkFilterListModelClass *class)
                          0, G_MAXUINT, 0,
                          GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkFilterListModel:threaded:
+   *
+   * If the model may match items on multiple threads
+   *
+   * Setting this guarantees that the property getters of the items
+   * are thread-safe, see gtk_filter_list_model_set_threaded().
+   */
+  properties[PROP_THREADED] =
+      g_param_spec_boolean ("threaded",
+                            P_("Threaded"),
+                            P_("Match items on multiple threads"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -834,6 +1091,60 @@ gtk_filter_list_model_get_incremental (GtkFilterListModel *self)
   return self->incremental;
 }
 
+/**
+ * gtk_filter_list_model_set_threaded:
+ * @self: a #GtkFilterListModel
+ * @threaded: %TRUE to allow matching on multiple threads
+ *
+ * Allows the model to match large numbers of items on multiple
+ * threads at once.
+ *
+ * This is only done for filters that don't run application callbacks
+ * themselves, which are the filters provided by GTK that look at
+ * properties of the items. #GtkCustomFilter and filters using closures
+ * are always run on the main thread.
+ *
+ * The property getters of the items are called from other threads
+ * though, so by enabling this, you guarantee that they are thread-safe
+ * and that the items are not modified while they are filtered.
+ *
+ * The main thread matches items, too, and waits for the other threads
+ * to finish before returning. When incremental filtering is enabled,
+ * every step matches a batch of items per thread.
+ *
+ * By default, filtering is done on the main thread only.
+ **/
+void
+gtk_filter_list_model_set_threaded (GtkFilterListModel *self,
+                                    gboolean            threaded)
+{
+  g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
+
+  if (self->threaded == threaded)
+    return;
+
+  self->threaded = threaded;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_THREADED]);
+}
+
+/**
+ * gtk_filter_list_model_get_threaded:
+ * @self: a #GtkFilterListModel
+ *
+ * Returns whether matching on multiple threads was enabled via
+ * gtk_filter_list_model_set_threaded().
+ *
+ * Returns: %TRUE if threaded filtering is enabled
+ **/
+gboolean
+gtk_filter_list_model_get_threaded (GtkFilterListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_FILTER_LIST_MODEL (self), FALSE);
+
+  return self->threaded;
+}
+
 /**
  * gtk_filter_list_model_get_pending:
  * @self: a #GtkFilterListModel
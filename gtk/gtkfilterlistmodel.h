@@ -56,6 +56,11 @@ void                    gtk_filter_list_model_set_incremental   (GtkFilterListMo
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_filter_list_model_get_incremental   (GtkFilterListModel     *self);
 GDK_AVAILABLE_IN_ALL
+void                    gtk_filter_list_model_set_threaded      (GtkFilterListModel     *self,
+                                                                 gboolean                threaded);
+GDK_AVAILABLE_IN_ALL
+gboolean                gtk_filter_list_model_get_threaded      (GtkFilterListModel     *self);
+GDK_AVAILABLE_IN_ALL
 guint                   gtk_filter_list_model_get_pending       (GtkFilterListModel     *self);
 
 
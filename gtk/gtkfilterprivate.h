@@ -0,0 +1,30 @@
+/*
+ * Copyright © 2020 Benjamin Otte
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_FILTER_PRIVATE_H__
+#define __GTK_FILTER_PRIVATE_H__
+
+#include <gtk/gtkfilter.h>
+
+#include "gtk/gtkexpressionprivate.h"
+
+gboolean                gtk_filter_is_thread_safe               (GtkFilter              *self);
+void                    gtk_filter_set_thread_safe              (GtkFilter              *self,
+                                                                 gboolean                thread_safe);
+
+
+#endif /* __GTK_FILTER_PRIVATE_H__ */
@@ -38,6 +38,15 @@
  * list of lists and concatenates them into a single list.
  */
 
+/* The models are kept in a tree, which handles changes well.
+ * When many items are looked up without anything changing, we also
+ * build a table of the models and their offsets, which is faster
+ * to search. Every change throws the table away again.
+ * It is built after n_models / TABLE_LOOKUP_RATIO lookups, so that
+ * building it is paid for by the faster lookups. */
+#define TABLE_LOOKUP_RATIO 4
+#define TABLE_MIN_LOOKUPS 64
+
 enum {
   PROP_0,
   PROP_MODEL,
@@ -65,6 +74,11 @@ struct _GtkFlattenListModel
 
   GListModel *model;
   GtkRbTree *items; /* NULL if model == NULL */
+
+  FlattenNode **table_nodes; /* NULL if no table */
+  guint *table_offsets; /* n_table + 1 entries */
+  guint n_table;
+  guint n_lookups; /* since the last change */
 };
 
 struct _GtkFlattenListModelClass
@@ -152,6 +166,84 @@ gtk_flatten_list_model_get_nth_model (GtkRbTree *tree,
   return node;
 }
 
+static void
+gtk_flatten_list_model_clear_table (GtkFlattenListModel *self)
+{
+  g_clear_pointer (&self->table_nodes, g_free);
+  g_clear_pointer (&self->table_offsets, g_free);
+  self->n_table = 0;
+  self->n_lookups = 0;
+}
+
+static void
+gtk_flatten_list_model_build_table (GtkFlattenListModel *self)
+{
+  FlattenAugment *aug;
+  FlattenNode *node;
+  guint i, offset;
+
+  aug = gtk_rb_tree_get_augment (self->items, gtk_rb_tree_get_root (self->items));
+  self->n_table = aug->n_models;
+  self->table_nodes = g_new (FlattenNode *, self->n_table);
+  self->table_offsets = g_new (guint, self->n_table + 1);
+
+  offset = 0;
+  for (node = gtk_rb_tree_get_first (self->items), i = 0;
+       node != NULL;
+       node = gtk_rb_tree_node_get_next (node), i++)
+    {
+      self->table_nodes[i] = node;
+      self->table_offsets[i] = offset;
+      offset += g_list_model_get_n_items (node->model);
+    }
+  self->table_offsets[i] = offset;
+}
+
+static FlattenNode *
+gtk_flatten_list_model_lookup (GtkFlattenListModel *self,
+                               guint                position,
+                               guint               *model_position)
+{
+  guint lo, hi;
+
+  if (self->table_nodes == NULL)
+    {
+      FlattenNode *root = gtk_rb_tree_get_root (self->items);
+      FlattenAugment *aug;
+
+      if (root == NULL)
+        return NULL;
+
+      aug = gtk_rb_tree_get_augment (self->items, root);
+      self->n_lookups++;
+      if (self->n_lookups < MAX (aug->n_models / TABLE_LOOKUP_RATIO, TABLE_MIN_LOOKUPS))
+        return gtk_flatten_list_model_get_nth (self->items, position, model_position);
+
+      gtk_flatten_list_model_build_table (self);
+    }
+
+  if (position >= self->table_offsets[self->n_table])
+    return NULL;
+
+  /* find the last model starting at or before position,
+   * skipping empty models */
+  lo = 0;
+  hi = self->n_table;
+  while (hi - lo > 1)
+    {
+      guint mid = (lo + hi) / 2;
+      if (self->table_offsets[mid] <= position)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  if (model_position)
+    *model_position = position - self->table_offsets[lo];
+
+  return self->table_nodes[lo];
+}
+
 static GType
 gtk_flatten_list_model_get_item_type (GListModel *list)
 {
@@ -187,7 +279,7 @@ gtk_flatten_list_model_get_item (GListModel *list,
   if (!self->items)
     return NULL;
 
-  node = gtk_flatten_list_model_get_nth (self->items, position, &model_pos);
+  node = gtk_flatten_list_model_lookup (self, position, &model_pos);
   if (node == NULL)
     return NULL;
 
@@ -216,6 +308,7 @@ gtk_flatten_list_model_items_changed_cb (GListModel          *model,
   GtkFlattenListModel *self = node->list;
   guint real_position;
 
+  gtk_flatten_list_model_clear_table (self);
   gtk_rb_tree_node_mark_dirty (node);
   real_position = position;
 
@@ -356,6 +449,8 @@ gtk_flatten_list_model_model_items_changed_cb (GListModel          *model,
   FlattenNode *node;
   guint i, real_position, real_removed, real_added;
 
+  gtk_flatten_list_model_clear_table (self);
+
   node = gtk_flatten_list_model_get_nth_model (self->items, position, &real_position);
 
   real_removed = 0;
@@ -381,6 +476,7 @@ gtk_flatten_list_clear_model (GtkFlattenListModel *self)
       g_signal_handlers_disconnect_by_func (self->model, gtk_flatten_list_model_model_items_changed_cb, self);
       g_clear_object (&self->model);
       g_clear_pointer (&self->items, gtk_rb_tree_unref);
+      gtk_flatten_list_model_clear_table (self);
     }
 }
 
@@ -525,7 +621,7 @@ gtk_flatten_list_model_get_model_for_item (GtkFlattenListModel *self,
   if (!self->items)
     return NULL;
 
-  node = gtk_flatten_list_model_get_nth (self->items, position, NULL);
+  node = gtk_flatten_list_model_lookup (self, position, NULL);
   if (node == NULL)
     return NULL;
 
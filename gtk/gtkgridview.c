@@ -27,6 +27,7 @@
 #include "gtklistitemfactory.h"
 #include "gtklistitemmanagerprivate.h"
 #include "gtkmain.h"
+#include "gtkmarshalers.h"
 #include "gtkprivate.h"
 #include "gtksingleselection.h"
 #include "gtkwidgetprivate.h"
@@ -43,6 +44,11 @@
 
 #define DEFAULT_MAX_COLUMNS (7)
 
+/* How many pages ahead of the visible area GtkGridView::prefetch
+ * asks for.
+ */
+#define GTK_GRID_VIEW_PREFETCH_PAGES (1)
+
 /**
  * SECTION:gtkgridview
  * @title: GtkGridView
@@ -55,6 +61,14 @@
  * and shows them in a grid. The orientation of the grid view determines if the
  * grid reflows vertically or horizontally.
  *
+ * For grids with lots of items that all have the same size, like thumbnails in
+ * a photo library, set #GtkGridView:uniform-cells. The grid view then measures
+ * a single item (or uses the size set with gtk_grid_view_set_cell_size()) and
+ * computes the position of all other items from it, which keeps scrolling fast
+ * no matter how many items there are. The GtkGridView::prefetch signal tells
+ * the application which items are about to become visible, so it can start
+ * loading their contents ahead of time.
+ *
  * GtkGridView allows the user to select items according to the selection
  * characteristics of the model. For models that allow multiple selected items,
  * it is possible to turn on _rubberband selection_, using
@@ -98,6 +112,17 @@ struct _GtkGridView
   guint n_columns;
   int unknown_row_height;
   double column_width;
+
+  gboolean uniform_cells;
+  gboolean uniform_rows; /* all rows are unknown_row_height high */
+  int cell_width;
+  int cell_height;
+
+  int prefetch_offset;
+  gboolean prefetch_backwards;
+  guint prefetch_position;
+  guint prefetch_n_items;
+  guint prefetch_idle;
 };
 
 struct _GtkGridViewClass
@@ -126,12 +151,16 @@ enum
   PROP_MODEL,
   PROP_SINGLE_CLICK_ACTIVATE,
   PROP_ENABLE_RUBBERBAND,
+  PROP_UNIFORM_CELLS,
+  PROP_CELL_WIDTH,
+  PROP_CELL_HEIGHT,
 
   N_PROPS
 };
 
 enum {
   ACTIVATE,
+  PREFETCH,
   LAST_SIGNAL
 };
 
@@ -227,6 +256,25 @@ gtk_grid_view_get_cell_at_y (GtkGridView *self,
   Cell *cell, *tmp;
   guint pos;
 
+  /* With uniform rows, they can be computed without walking the tree */
+  if (self->uniform_rows && self->unknown_row_height > 0 && y >= 0)
+    {
+      pos = (y / self->unknown_row_height) * self->n_columns;
+      if (pos >= gtk_list_base_get_n_items (GTK_LIST_BASE (self)))
+        cell = NULL;
+      else
+        cell = gtk_list_item_manager_get_nth (self->item_manager, pos, NULL);
+
+      if (position)
+        *position = cell ? pos : 0;
+      if (offset)
+        *offset = cell ? y % self->unknown_row_height : 0;
+      if (size)
+        *size = cell ? self->unknown_row_height : 0;
+
+      return cell;
+    }
+
   cell = gtk_list_item_manager_get_root (self->item_manager);
   pos = 0;
 
@@ -323,6 +371,18 @@ gtk_grid_view_get_allocation_along (GtkListBase *base,
   Cell *cell, *tmp;
   int y;
 
+  if (self->uniform_rows && self->unknown_row_height > 0)
+    {
+      gboolean valid = pos < gtk_list_base_get_n_items (base);
+
+      if (offset)
+        *offset = valid ? (pos / self->n_columns) * self->unknown_row_height : 0;
+      if (size)
+        *size = valid ? self->unknown_row_height : 0;
+
+      return valid;
+    }
+
   cell = gtk_list_item_manager_get_root (self->item_manager);
   y = 0;
   pos -= pos % self->n_columns;
@@ -547,6 +607,44 @@ gtk_grid_view_get_unknown_row_size (GtkGridView *self,
   return g_array_index (heights, int, heights->len / 2);
 }
 
+/* Measures the size of all cells when they are uniform, either from
+ * the size set by the application or from the first available cell.
+ */
+static void
+gtk_grid_view_measure_uniform_cell (GtkGridView    *self,
+                                    GtkOrientation  orientation,
+                                    int             for_size,
+                                    int            *minimum,
+                                    int            *natural)
+{
+  Cell *cell;
+  int size;
+
+  size = orientation == GTK_ORIENTATION_HORIZONTAL ? self->cell_width : self->cell_height;
+  if (size >= 0)
+    {
+      *minimum = size;
+      *natural = size;
+      return;
+    }
+
+  for (cell = gtk_list_item_manager_get_first (self->item_manager);
+       cell != NULL;
+       cell = gtk_rb_tree_node_get_next (cell))
+    {
+      if (cell->parent.widget)
+        {
+          gtk_widget_measure (cell->parent.widget,
+                              orientation, for_size,
+                              minimum, natural, NULL, NULL);
+          return;
+        }
+    }
+
+  *minimum = 0;
+  *natural = 0;
+}
+
 static void
 gtk_grid_view_measure_column_size (GtkGridView *self,
                                    int         *minimum,
@@ -560,6 +658,12 @@ gtk_grid_view_measure_column_size (GtkGridView *self,
   nat = 0;
   opposite = gtk_list_base_get_opposite_orientation (GTK_LIST_BASE (self));
 
+  if (self->uniform_cells)
+    {
+      gtk_grid_view_measure_uniform_cell (self, opposite, -1, minimum, natural);
+      return;
+    }
+
   for (cell = gtk_list_item_manager_get_first (self->item_manager);
        cell != NULL;
        cell = gtk_rb_tree_node_get_next (cell))
@@ -629,7 +733,6 @@ gtk_grid_view_measure_list (GtkWidget *widget,
   guint i;
 
   scroll_policy = gtk_list_base_get_scroll_policy (GTK_LIST_BASE (self), gtk_list_base_get_orientation (GTK_LIST_BASE (self)));
-  heights = g_array_new (FALSE, FALSE, sizeof (int));
   n_unknown = 0;
   height = 0;
 
@@ -638,6 +741,22 @@ gtk_grid_view_measure_list (GtkWidget *widget,
   n_columns = gtk_grid_view_compute_n_columns (self, for_size, col_min, col_nat);
   column_size = for_size / n_columns;
 
+  if (self->uniform_cells)
+    {
+      gtk_grid_view_measure_uniform_cell (self,
+                                          gtk_list_base_get_orientation (GTK_LIST_BASE (self)),
+                                          column_size,
+                                          &child_min, &child_nat);
+      row_height = scroll_policy == GTK_SCROLL_MINIMUM ? child_min : child_nat;
+      i = gtk_list_base_get_n_items (GTK_LIST_BASE (self));
+      height = (i + n_columns - 1) / n_columns * row_height;
+
+      *minimum = height;
+      *natural = height;
+      return;
+    }
+
+  heights = g_array_new (FALSE, FALSE, sizeof (int));
   i = 0;
   row_height = 0;
   measured = FALSE;
@@ -736,6 +855,113 @@ gtk_grid_view_compute_total_height (GtkGridView *self)
   return aug->size;
 }
 
+/* With uniform cells, every row is as high as a single cell and
+ * its height is assigned to the cell the row starts in.
+ */
+static void
+gtk_grid_view_size_uniform_rows (GtkGridView         *self,
+                                 GtkScrollablePolicy  scroll_policy,
+                                 int                  min_row_height)
+{
+  Cell *cell;
+  int min, nat;
+  guint pos, n_rows;
+
+  gtk_grid_view_measure_uniform_cell (self,
+                                      gtk_list_base_get_orientation (GTK_LIST_BASE (self)),
+                                      self->column_width,
+                                      &min, &nat);
+  if (scroll_policy == GTK_SCROLL_MINIMUM)
+    self->unknown_row_height = MAX (min, min_row_height);
+  else
+    self->unknown_row_height = MAX (nat, min_row_height);
+
+  pos = 0;
+  for (cell = gtk_list_item_manager_get_first (self->item_manager);
+       cell != NULL;
+       cell = gtk_rb_tree_node_get_next (cell))
+    {
+      n_rows = (pos + cell->parent.n_items + self->n_columns - 1) / self->n_columns
+             - (pos + self->n_columns - 1) / self->n_columns;
+      cell_set_size (cell, n_rows * self->unknown_row_height);
+      pos += cell->parent.n_items;
+    }
+
+  /* Rows of height 0 can't be found by their position, walk the
+   * tree for them.
+   */
+  self->uniform_rows = self->unknown_row_height > 0;
+}
+
+static gboolean
+gtk_grid_view_prefetch_cb (gpointer data)
+{
+  GtkGridView *self = data;
+
+  self->prefetch_idle = 0;
+
+  if (self->prefetch_n_items > 0)
+    g_signal_emit (self, signals[PREFETCH], 0, self->prefetch_position, self->prefetch_n_items);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Computes the items that will become visible next when scrolling
+ * on in the current direction and queues GtkGridView::prefetch for
+ * them if they changed.
+ */
+static void
+gtk_grid_view_update_prefetch (GtkGridView *self,
+                               int          offset,
+                               int          page_size)
+{
+  guint start, end, n_items;
+  int from, to;
+
+  n_items = gtk_list_base_get_n_items (GTK_LIST_BASE (self));
+  if (n_items == 0 || page_size <= 0)
+    return;
+
+  if (offset != self->prefetch_offset)
+    self->prefetch_backwards = offset < self->prefetch_offset;
+  self->prefetch_offset = offset;
+
+  if (self->prefetch_backwards)
+    {
+      from = offset - GTK_GRID_VIEW_PREFETCH_PAGES * page_size;
+      to = offset;
+    }
+  else
+    {
+      from = offset + page_size;
+      to = from + GTK_GRID_VIEW_PREFETCH_PAGES * page_size;
+    }
+
+  if (to <= 0 ||
+      !gtk_grid_view_get_cell_at_y (self, MAX (from, 0), &start, NULL, NULL))
+    {
+      start = 0;
+      end = 0;
+    }
+  else if (!gtk_grid_view_get_cell_at_y (self, to - 1, &end, NULL, NULL))
+    end = n_items;
+  else
+    end = MIN (end + self->n_columns, n_items);
+
+  if (start == self->prefetch_position &&
+      end - start == self->prefetch_n_items)
+    return;
+
+  self->prefetch_position = start;
+  self->prefetch_n_items = end - start;
+
+  if (self->prefetch_n_items == 0 || self->prefetch_idle != 0)
+    return;
+
+  self->prefetch_idle = g_idle_add (gtk_grid_view_prefetch_cb, self);
+  g_source_set_name_by_id (self->prefetch_idle, "[gtk] gtk_grid_view_prefetch_cb");
+}
+
 static void
 gtk_grid_view_size_allocate (GtkWidget *widget,
                              int        width,
@@ -762,6 +988,7 @@ gtk_grid_view_size_allocate (GtkWidget *widget,
     return;
 
   /* step 1: determine width of the list */
+  self->uniform_rows = FALSE;
   gtk_grid_view_measure_column_size (self, &col_min, &col_nat);
   self->n_columns = gtk_grid_view_compute_n_columns (self, 
                                                      orientation == GTK_ORIENTATION_VERTICAL ? width : height,
@@ -769,84 +996,92 @@ gtk_grid_view_size_allocate (GtkWidget *widget,
   self->column_width = (orientation == GTK_ORIENTATION_VERTICAL ? width : height) / self->n_columns;
   self->column_width = MAX (self->column_width, col_min);
 
-  /* step 2: determine height of known rows */
-  heights = g_array_new (FALSE, FALSE, sizeof (int));
-
-  i = 0;
-  row_height = 0;
-  start = NULL;
-  for (cell = gtk_list_item_manager_get_first (self->item_manager);
-       cell != NULL;
-       cell = gtk_rb_tree_node_get_next (cell))
+  if (self->uniform_cells)
     {
-      if (i == 0)
-        start = cell;
-      
-      if (cell->parent.widget)
-        {
-          int min, nat, size;
-          gtk_widget_measure (cell->parent.widget,
-                              gtk_list_base_get_orientation (GTK_LIST_BASE (self)),
-                              self->column_width,
-                              &min, &nat, NULL, NULL);
-          if (scroll_policy == GTK_SCROLL_MINIMUM)
-            size = min;
-          else
-            size = nat;
-          size = MAX (size, min_row_height);
-          g_array_append_val (heights, size);
-          row_height = MAX (row_height, size);
-        }
-      cell_set_size (cell, 0);
-      i += cell->parent.n_items;
-
-      if (i >= self->n_columns)
-        {
-          i %= self->n_columns;
-
-          cell_set_size (start, start->size + row_height);
-          start = cell;
-          row_height = 0;
-        }
+      /* step 2: all rows have the same height */
+      gtk_grid_view_size_uniform_rows (self, scroll_policy, min_row_height);
     }
-  if (i > 0)
-    cell_set_size (start, start->size + row_height);
-
-  /* step 3: determine height of rows with only unknown items */
-  self->unknown_row_height = gtk_grid_view_get_unknown_row_size (self, heights);
-  g_array_free (heights, TRUE);
-
-  i = 0;
-  known = FALSE;
-  for (start = cell = gtk_list_item_manager_get_first (self->item_manager);
-       cell != NULL;
-       cell = gtk_rb_tree_node_get_next (cell))
+  else
     {
-      if (i == 0)
-        start = cell;
+      /* step 2: determine height of known rows */
+      heights = g_array_new (FALSE, FALSE, sizeof (int));
+
+      i = 0;
+      row_height = 0;
+      start = NULL;
+      for (cell = gtk_list_item_manager_get_first (self->item_manager);
+           cell != NULL;
+           cell = gtk_rb_tree_node_get_next (cell))
+        {
+          if (i == 0)
+            start = cell;
 
-      if (cell->parent.widget)
-        known = TRUE;
+          if (cell->parent.widget)
+            {
+              int min, nat, size;
+              gtk_widget_measure (cell->parent.widget,
+                                  gtk_list_base_get_orientation (GTK_LIST_BASE (self)),
+                                  self->column_width,
+                                  &min, &nat, NULL, NULL);
+              if (scroll_policy == GTK_SCROLL_MINIMUM)
+                size = min;
+              else
+                size = nat;
+              size = MAX (size, min_row_height);
+              g_array_append_val (heights, size);
+              row_height = MAX (row_height, size);
+            }
+          cell_set_size (cell, 0);
+          i += cell->parent.n_items;
 
-      i += cell->parent.n_items;
-      if (i >= self->n_columns)
+          if (i >= self->n_columns)
+            {
+              i %= self->n_columns;
+
+              cell_set_size (start, start->size + row_height);
+              start = cell;
+              row_height = 0;
+            }
+        }
+      if (i > 0)
+        cell_set_size (start, start->size + row_height);
+
+      /* step 3: determine height of rows with only unknown items */
+      self->unknown_row_height = gtk_grid_view_get_unknown_row_size (self, heights);
+      g_array_free (heights, TRUE);
+
+      i = 0;
+      known = FALSE;
+      for (start = cell = gtk_list_item_manager_get_first (self->item_manager);
+           cell != NULL;
+           cell = gtk_rb_tree_node_get_next (cell))
         {
-          if (!known)
-            cell_set_size (start, start->size + self->unknown_row_height);
+          if (i == 0)
+            start = cell;
 
-          i -= self->n_columns;
-          known = FALSE;
+          if (cell->parent.widget)
+            known = TRUE;
 
+          i += cell->parent.n_items;
           if (i >= self->n_columns)
             {
-              cell_set_size (cell, cell->size + self->unknown_row_height * (i / self->n_columns));
-              i %= self->n_columns;
+              if (!known)
+                cell_set_size (start, start->size + self->unknown_row_height);
+
+              i -= self->n_columns;
+              known = FALSE;
+
+              if (i >= self->n_columns)
+                {
+                  cell_set_size (cell, cell->size + self->unknown_row_height * (i / self->n_columns));
+                  i %= self->n_columns;
+                }
+              start = cell;
             }
-          start = cell;
         }
+      if (i > 0 && !known)
+        cell_set_size (start, start->size + self->unknown_row_height);
     }
-  if (i > 0 && !known)
-    cell_set_size (start, start->size + self->unknown_row_height);
 
   /* step 4: update the adjustments */
   gtk_list_base_update_adjustments (GTK_LIST_BASE (self),
@@ -856,6 +1091,8 @@ gtk_grid_view_size_allocate (GtkWidget *widget,
                                     gtk_widget_get_size (widget, orientation),
                                     &x, &y);
 
+  gtk_grid_view_update_prefetch (self, y, gtk_widget_get_size (widget, orientation));
+
   /* step 5: run the size_allocate loop */
   x = -x;
   y = -y;
@@ -870,6 +1107,17 @@ gtk_grid_view_size_allocate (GtkWidget *widget,
         {
           row_height += cell->size;
 
+          /* Uniform cells were not measured above, but widgets
+           * must be measured before they get allocated.
+           */
+          if (self->uniform_cells)
+            {
+              int min;
+              gtk_widget_measure (cell->parent.widget,
+                                  orientation, self->column_width,
+                                  &min, NULL, NULL, NULL);
+            }
+
           gtk_list_base_size_allocate_child (GTK_LIST_BASE (self),
                                              cell->parent.widget,
                                              x + ceil (self->column_width * i),
@@ -921,6 +1169,7 @@ gtk_grid_view_dispose (GObject *object)
   GtkGridView *self = GTK_GRID_VIEW (object);
 
   self->item_manager = NULL;
+  g_clear_handle_id (&self->prefetch_idle, g_source_remove);
 
   G_OBJECT_CLASS (gtk_grid_view_parent_class)->dispose (object);
 }
@@ -959,6 +1208,18 @@ gtk_grid_view_get_property (GObject    *object,
       g_value_set_boolean (value, gtk_list_base_get_enable_rubberband (GTK_LIST_BASE (self)));
       break;
 
+    case PROP_UNIFORM_CELLS:
+      g_value_set_boolean (value, self->uniform_cells);
+      break;
+
+    case PROP_CELL_WIDTH:
+      g_value_set_int (value, self->cell_width);
+      break;
+
+    case PROP_CELL_HEIGHT:
+      g_value_set_int (value, self->cell_height);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -999,6 +1260,18 @@ gtk_grid_view_set_property (GObject      *object,
       gtk_grid_view_set_enable_rubberband (self, g_value_get_boolean (value));
       break;
 
+    case PROP_UNIFORM_CELLS:
+      gtk_grid_view_set_uniform_cells (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_CELL_WIDTH:
+      gtk_grid_view_set_cell_size (self, g_value_get_int (value), self->cell_height);
+      break;
+
+    case PROP_CELL_HEIGHT:
+      gtk_grid_view_set_cell_size (self, self->cell_width, g_value_get_int (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -1125,6 +1398,47 @@ gtk_grid_view_class_init (GtkGridViewClass *klass)
                           FALSE,
                           G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkGridView:uniform-cells:
+   *
+   * Whether all cells have the same size
+   *
+   * If this is set, the grid view only measures a single cell and
+   * computes the layout of all other cells from it.
+   */
+  properties[PROP_UNIFORM_CELLS] =
+    g_param_spec_boolean ("uniform-cells",
+                          P_("Uniform cells"),
+                          P_("Whether all cells have the same size"),
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GtkGridView:cell-width:
+   *
+   * Width of all cells if GtkGridView:uniform-cells is set, or -1 to
+   * measure it
+   */
+  properties[PROP_CELL_WIDTH] =
+    g_param_spec_int ("cell-width",
+                      P_("Cell width"),
+                      P_("Width of uniform cells, or -1 to measure it"),
+                      -1, G_MAXINT, -1,
+                      G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GtkGridView:cell-height:
+   *
+   * Height of all cells if GtkGridView:uniform-cells is set, or -1 to
+   * measure it
+   */
+  properties[PROP_CELL_HEIGHT] =
+    g_param_spec_int ("cell-height",
+                      P_("Cell height"),
+                      P_("Height of uniform cells, or -1 to measure it"),
+                      -1, G_MAXINT, -1,
+                      G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 
   /**
@@ -1151,6 +1465,32 @@ gtk_grid_view_class_init (GtkGridViewClass *klass)
                               G_TYPE_FROM_CLASS (gobject_class),
                               g_cclosure_marshal_VOID__UINTv);
 
+  /**
+   * GtkGridView::prefetch:
+   * @self: The #GtkGridView
+   * @position: position of the first item
+   * @n_items: number of items
+   *
+   * The ::prefetch signal is emitted when the items in the given range
+   * are likely to become visible soon, because they are next to the
+   * visible area in the direction the grid view is being scrolled.
+   *
+   * Applications can use this to start loading expensive contents,
+   * like thumbnails, for those items before their widgets are bound.
+   */
+  signals[PREFETCH] =
+    g_signal_new (I_("prefetch"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _gtk_marshal_VOID__UINT_UINT,
+                  G_TYPE_NONE, 2,
+                  G_TYPE_UINT, G_TYPE_UINT);
+  g_signal_set_va_marshaller (signals[PREFETCH],
+                              G_TYPE_FROM_CLASS (gobject_class),
+                              _gtk_marshal_VOID__UINT_UINTv);
+
   /**
    * GtkGridView|list.activate-item:
    * @position: position of item to activate
@@ -1175,6 +1515,8 @@ gtk_grid_view_init (GtkGridView *self)
   self->min_columns = 1;
   self->max_columns = DEFAULT_MAX_COLUMNS;
   self->n_columns = 1;
+  self->cell_width = -1;
+  self->cell_height = -1;
 
   gtk_list_base_set_anchor_max_widgets (GTK_LIST_BASE (self),
                                         self->max_columns * GTK_GRID_VIEW_MAX_VISIBLE_ROWS,
@@ -1464,3 +1806,118 @@ gtk_grid_view_get_enable_rubberband (GtkGridView *self)
 
   return gtk_list_base_get_enable_rubberband (GTK_LIST_BASE (self));
 }
+
+/**
+ * gtk_grid_view_set_uniform_cells:
+ * @self: a #GtkGridView
+ * @uniform_cells: %TRUE if all cells have the same size
+ *
+ * Sets whether all cells in @self have the same size.
+ *
+ * With uniform cells, the grid view measures only a single cell, or
+ * uses the size set with gtk_grid_view_set_cell_size(), and computes
+ * the positions of all items from it. This makes scrolling through
+ * grids with a very large number of items much faster.
+ */
+void
+gtk_grid_view_set_uniform_cells (GtkGridView *self,
+                                 gboolean     uniform_cells)
+{
+  g_return_if_fail (GTK_IS_GRID_VIEW (self));
+
+  uniform_cells = !!uniform_cells;
+  if (self->uniform_cells == uniform_cells)
+    return;
+
+  self->uniform_cells = uniform_cells;
+  /* the row height is only known after the next allocation */
+  self->uniform_rows = FALSE;
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_UNIFORM_CELLS]);
+}
+
+/**
+ * gtk_grid_view_get_uniform_cells:
+ * @self: a #GtkGridView
+ *
+ * Returns whether all cells are assumed to have the same size.
+ *
+ * Returns: %TRUE if cells are uniform
+ */
+gboolean
+gtk_grid_view_get_uniform_cells (GtkGridView *self)
+{
+  g_return_val_if_fail (GTK_IS_GRID_VIEW (self), FALSE);
+
+  return self->uniform_cells;
+}
+
+/**
+ * gtk_grid_view_set_cell_size:
+ * @self: a #GtkGridView
+ * @width: width of all cells, or -1 to measure it
+ * @height: height of all cells, or -1 to measure it
+ *
+ * Sets the size of all cells when #GtkGridView:uniform-cells is set,
+ * so that no cell needs to be measured for it.
+ *
+ * The size has no effect unless #GtkGridView:uniform-cells is %TRUE.
+ */
+void
+gtk_grid_view_set_cell_size (GtkGridView *self,
+                             int          width,
+                             int          height)
+{
+  g_return_if_fail (GTK_IS_GRID_VIEW (self));
+  g_return_if_fail (width >= -1);
+  g_return_if_fail (height >= -1);
+
+  if (self->cell_width == width && self->cell_height == height)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  if (self->cell_width != width)
+    {
+      self->cell_width = width;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CELL_WIDTH]);
+    }
+
+  if (self->cell_height != height)
+    {
+      self->cell_height = height;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CELL_HEIGHT]);
+    }
+
+  if (self->uniform_cells)
+    {
+      self->uniform_rows = FALSE;
+      gtk_widget_queue_resize (GTK_WIDGET (self));
+    }
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * gtk_grid_view_get_cell_size:
+ * @self: a #GtkGridView
+ * @width: (out) (optional): return location for the cell width
+ * @height: (out) (optional): return location for the cell height
+ *
+ * Gets the size of cells set with gtk_grid_view_set_cell_size().
+ * A value of -1 means the size is measured.
+ */
+void
+gtk_grid_view_get_cell_size (GtkGridView *self,
+                             int         *width,
+                             int         *height)
+{
+  g_return_if_fail (GTK_IS_GRID_VIEW (self));
+
+  if (width)
+    *width = self->cell_width;
+  if (height)
+    *height = self->cell_height;
+}
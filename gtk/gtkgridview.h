@@ -85,6 +85,20 @@ void            gtk_grid_view_set_single_click_activate         (GtkGridView
 GDK_AVAILABLE_IN_ALL
 gboolean        gtk_grid_view_get_single_click_activate         (GtkGridView            *self);
 
+GDK_AVAILABLE_IN_ALL
+void            gtk_grid_view_set_uniform_cells                 (GtkGridView            *self,
+                                                                 gboolean                uniform_cells);
+GDK_AVAILABLE_IN_ALL
+gboolean        gtk_grid_view_get_uniform_cells                 (GtkGridView            *self);
+GDK_AVAILABLE_IN_ALL
+void            gtk_grid_view_set_cell_size                     (GtkGridView            *self,
+                                                                 int                     width,
+                                                                 int                     height);
+GDK_AVAILABLE_IN_ALL
+void            gtk_grid_view_get_cell_size                     (GtkGridView            *self,
+                                                                 int                    *width,
+                                                                 int                    *height);
+
 
 G_END_DECLS
 
@@ -21,10 +21,12 @@
 
 #include "gtklistitemmanagerprivate.h"
 
+#include "gtkcssnodeprivate.h"
 #include "gtklistitemwidgetprivate.h"
 #include "gtkwidgetprivate.h"
 
 #define GTK_LIST_VIEW_MAX_LIST_ITEMS 200
+#define GTK_LIST_ITEM_MANAGER_DEFAULT_POOL_SIZE 50
 
 struct _GtkListItemManager
 {
@@ -39,6 +41,12 @@ struct _GtkListItemManager
 
   GtkRbTree *items;
   GSList *trackers;
+
+  /* Released widgets that are still set up with the factory,
+   * kept around as hidden children to be rebound */
+  GSList *pool;
+  guint n_pool;
+  guint pool_size;
 };
 
 struct _GtkListItemManagerClass
@@ -787,12 +795,21 @@ gtk_list_item_manager_clear_model (GtkListItemManager *self)
   g_clear_object (&self->model);
 }
 
+static void
+gtk_list_item_manager_clear_pool (GtkListItemManager *self)
+{
+  g_slist_free_full (self->pool, (GDestroyNotify) gtk_widget_unparent);
+  self->pool = NULL;
+  self->n_pool = 0;
+}
+
 static void
 gtk_list_item_manager_dispose (GObject *object)
 {
   GtkListItemManager *self = GTK_LIST_ITEM_MANAGER (object);
 
   gtk_list_item_manager_clear_model (self);
+  gtk_list_item_manager_clear_pool (self);
 
   g_clear_object (&self->factory);
 
@@ -812,6 +829,7 @@ gtk_list_item_manager_class_init (GtkListItemManagerClass *klass)
 static void
 gtk_list_item_manager_init (GtkListItemManager *self)
 {
+  self->pool_size = GTK_LIST_ITEM_MANAGER_DEFAULT_POOL_SIZE;
 }
 
 void
@@ -832,6 +850,9 @@ gtk_list_item_manager_set_factory (GtkListItemManager *self,
 
   g_set_object (&self->factory, factory);
 
+  /* Pooled widgets were set up by the old factory */
+  gtk_list_item_manager_clear_pool (self);
+
   gtk_list_item_manager_add_items (self, 0, n_items);
 
   gtk_list_item_manager_ensure_items (self, NULL, G_MAXUINT);
@@ -925,6 +946,25 @@ gtk_list_item_manager_acquire_list_item (GtkListItemManager *self,
   g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), NULL);
   g_return_val_if_fail (prev_sibling == NULL || GTK_IS_WIDGET (prev_sibling), NULL);
 
+  if (self->pool)
+    {
+      result = self->pool->data;
+      self->pool = g_slist_delete_link (self->pool, self->pool);
+      self->n_pool--;
+
+      gtk_widget_set_child_visible (result, TRUE);
+      gtk_css_node_set_visible (gtk_widget_get_css_node (result), gtk_widget_get_visible (result));
+      gtk_list_item_widget_set_single_click_activate (GTK_LIST_ITEM_WIDGET (result), self->single_click_activate);
+      item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+      selected = gtk_selection_model_is_selected (self->model, position);
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (result), position, item, selected);
+      g_object_unref (item);
+      gtk_widget_insert_after (result, self->widget, prev_sibling);
+      gtk_widget_queue_resize (result);
+
+      return result;
+    }
+
   result = gtk_list_item_widget_new (self->factory,
                                      self->item_css_name,
                                      self->item_role);
@@ -1077,6 +1117,28 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
       return;
     }
 
+  /* Keep the widget set up, so that it can be rebound instead of
+   * running the factory's setup again for a new widget. The focus
+   * widget is not kept, it must not end up hidden.
+   */
+  if (self->n_pool < self->pool_size &&
+      gtk_widget_get_focus_child (item) == NULL &&
+      !gtk_widget_has_focus (item))
+    {
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (item), GTK_INVALID_LIST_POSITION, NULL, FALSE);
+      gtk_widget_unset_state_flags (item, GTK_STATE_FLAG_PRELIGHT | GTK_STATE_FLAG_ACTIVE);
+      gtk_widget_set_child_visible (item, FALSE);
+      /* Keep it out of the way of the widgets in use: behind them in
+       * the list of children and hidden from structural CSS selectors.
+       */
+      gtk_css_node_set_visible (gtk_widget_get_css_node (item), FALSE);
+      gtk_widget_insert_before (item, self->widget, NULL);
+
+      self->pool = g_slist_prepend (self->pool, item);
+      self->n_pool++;
+      return;
+    }
+
   gtk_widget_unparent (item);
 }
 
@@ -1107,6 +1169,41 @@ gtk_list_item_manager_get_single_click_activate (GtkListItemManager   *self)
   return self->single_click_activate;
 }
 
+/*
+ * gtk_list_item_manager_set_pool_size:
+ * @self: a #GtkListItemManager
+ * @pool_size: the maximum number of released widgets to keep
+ *
+ * Sets how many released list item widgets are kept around to be
+ * reused by gtk_list_item_manager_acquire_list_item(). Pooled widgets
+ * stay set up with the factory, so reusing them only needs a rebind.
+ *
+ * A size of 0 disables the pool.
+ **/
+void
+gtk_list_item_manager_set_pool_size (GtkListItemManager *self,
+                                     guint               pool_size)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
+
+  self->pool_size = pool_size;
+
+  while (self->n_pool > pool_size)
+    {
+      gtk_widget_unparent (self->pool->data);
+      self->pool = g_slist_delete_link (self->pool, self->pool);
+      self->n_pool--;
+    }
+}
+
+guint
+gtk_list_item_manager_get_pool_size (GtkListItemManager *self)
+{
+  g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), 0);
+
+  return self->pool_size;
+}
+
 GtkListItemTracker *
 gtk_list_item_tracker_new (GtkListItemManager *self)
 {
@@ -94,6 +94,9 @@ void                    gtk_list_item_manager_set_single_click_activate
                                                                  gboolean                single_click_activate);
 gboolean                gtk_list_item_manager_get_single_click_activate
                                                                 (GtkListItemManager     *self);
+void                    gtk_list_item_manager_set_pool_size     (GtkListItemManager     *self,
+                                                                 guint                   pool_size);
+guint                   gtk_list_item_manager_get_pool_size     (GtkListItemManager     *self);
 
 GtkListItemTracker *    gtk_list_item_tracker_new               (GtkListItemManager     *self);
 void                    gtk_list_item_tracker_free              (GtkListItemManager     *self,
@@ -573,7 +573,7 @@ gtk_list_item_widget_set_factory (GtkListItemWidget  *self,
   if (priv->factory)
     {
       if (priv->list_item)
-        gtk_list_item_factory_teardown (factory, self);
+        gtk_list_item_factory_teardown (priv->factory, self);
       g_clear_object (&priv->factory);
     }
 
@@ -25,6 +25,7 @@
 #include "gtkintl.h"
 #include "gtklistbaseprivate.h"
 #include "gtklistitemmanagerprivate.h"
+#include "gtklistitemwidgetprivate.h"
 #include "gtkmain.h"
 #include "gtkprivate.h"
 #include "gtkrbtreeprivate.h"
@@ -40,6 +41,14 @@
 /* Extra items to keep above + below every tracker */
 #define GTK_LIST_VIEW_EXTRA_ITEMS 2
 
+/* Maximum number of rows without a widget that get measured
+ * in idle time to improve the height estimate for those rows.
+ */
+#define GTK_LIST_VIEW_MAX_SAMPLES 256
+
+/* Time in microseconds to spend measuring rows per idle iteration */
+#define GTK_LIST_VIEW_SAMPLE_TIME 2000
+
 /**
  * SECTION:gtklistview
  * @title: GtkListView
@@ -149,6 +158,7 @@ struct _ListRow
 {
   GtkListItemManagerItem parent;
   guint height; /* per row */
+  gboolean measured; /* height was measured, not estimated */
 };
 
 struct _ListRowAugment
@@ -452,6 +462,149 @@ gtk_list_view_move_focus_across (GtkListBase *base,
   return pos;
 }
 
+/* Rows without a widget get the average height of all rows measured
+ * so far. Unlike the heights of the rows that happen to be on screen,
+ * this average changes slowly while scrolling, so the scrollbar does
+ * not jump around.
+ * When it does change, the rows above the anchor change their size,
+ * but gtk_list_base_update_adjustments() computes the scroll offset
+ * from the anchor, so the visible rows stay in place.
+ */
+static guint
+gtk_list_view_get_estimated_row_height (GtkListView *self)
+{
+  if (self->estimate_count == 0)
+    return 0;
+
+  return (self->estimate_sum + self->estimate_count / 2) / self->estimate_count;
+}
+
+static void
+gtk_list_view_clear_measure (GtkListView *self)
+{
+  g_clear_handle_id (&self->measure_idle, g_source_remove);
+  g_clear_pointer (&self->measure_widget, gtk_widget_unparent);
+}
+
+static void
+gtk_list_view_reset_estimate (GtkListView *self)
+{
+  ListRow *row;
+
+  g_clear_handle_id (&self->measure_idle, g_source_remove);
+  /* don't keep an item of an old model alive */
+  if (self->measure_widget)
+    gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (self->measure_widget),
+                                 GTK_INVALID_LIST_POSITION,
+                                 NULL,
+                                 FALSE);
+  self->estimate_sum = 0;
+  self->estimate_count = 0;
+  self->n_samples = 0;
+
+  for (row = gtk_list_item_manager_get_first (self->item_manager);
+       row != NULL;
+       row = gtk_rb_tree_node_get_next (row))
+    {
+      row->measured = FALSE;
+    }
+}
+
+static gboolean
+gtk_list_view_measure_idle (gpointer data)
+{
+  GtkListView *self = data;
+  GtkSelectionModel *model;
+  GtkOrientation orientation;
+  GtkScrollablePolicy scroll_policy;
+  guint n_items, old_estimate;
+  gint64 end_time;
+
+  model = gtk_list_item_manager_get_model (self->item_manager);
+  n_items = gtk_list_base_get_n_items (GTK_LIST_BASE (self));
+  if (model == NULL || n_items == 0)
+    {
+      self->measure_idle = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  orientation = gtk_list_base_get_orientation (GTK_LIST_BASE (self));
+  scroll_policy = gtk_list_base_get_scroll_policy (GTK_LIST_BASE (self), orientation);
+
+  if (self->measure_widget == NULL)
+    {
+      GtkListBaseClass *base_class = GTK_LIST_BASE_GET_CLASS (self);
+
+      self->measure_widget = gtk_list_item_widget_new (gtk_list_item_manager_get_factory (self->item_manager),
+                                                       base_class->list_item_name,
+                                                       base_class->list_item_role);
+      gtk_widget_set_child_visible (self->measure_widget, FALSE);
+      gtk_widget_set_parent (self->measure_widget, GTK_WIDGET (self));
+    }
+
+  old_estimate = gtk_list_view_get_estimated_row_height (self);
+  end_time = g_get_monotonic_time () + GTK_LIST_VIEW_SAMPLE_TIME;
+
+  while (self->n_samples < GTK_LIST_VIEW_MAX_SAMPLES &&
+         g_get_monotonic_time () < end_time)
+    {
+      ListRow *row;
+      gpointer item;
+      guint pos;
+      int min, nat;
+
+      /* spread the samples evenly over the whole list */
+      pos = ((guint64) (guint32) (self->n_samples * 2654435769u) * n_items) >> 32;
+      self->n_samples++;
+
+      row = gtk_list_item_manager_get_nth (self->item_manager, pos, NULL);
+      if (row == NULL || row->parent.widget != NULL)
+        continue;
+
+      item = g_list_model_get_item (G_LIST_MODEL (model), pos);
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (self->measure_widget),
+                                   pos,
+                                   item,
+                                   gtk_selection_model_is_selected (model, pos));
+      g_object_unref (item);
+
+      gtk_widget_measure (self->measure_widget, orientation,
+                          self->estimate_width,
+                          &min, &nat, NULL, NULL);
+      self->estimate_sum += scroll_policy == GTK_SCROLL_MINIMUM ? min : nat;
+      self->estimate_count++;
+    }
+
+  /* The model may change before the next iteration, so don't
+   * keep the last item bound.
+   */
+  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (self->measure_widget),
+                               GTK_INVALID_LIST_POSITION,
+                               NULL,
+                               FALSE);
+
+  if (gtk_list_view_get_estimated_row_height (self) != old_estimate)
+    gtk_widget_queue_allocate (GTK_WIDGET (self));
+
+  if (self->n_samples < GTK_LIST_VIEW_MAX_SAMPLES)
+    return G_SOURCE_CONTINUE;
+
+  self->measure_idle = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_list_view_queue_measure (GtkListView *self)
+{
+  if (self->measure_idle != 0 ||
+      self->n_samples >= GTK_LIST_VIEW_MAX_SAMPLES ||
+      gtk_list_item_manager_get_factory (self->item_manager) == NULL)
+    return;
+
+  self->measure_idle = g_idle_add (gtk_list_view_measure_idle, self);
+  g_source_set_name_by_id (self->measure_idle, "[gtk] gtk_list_view_measure_idle");
+}
+
 static int
 compare_ints (gconstpointer first,
                gconstpointer second)
@@ -583,8 +736,8 @@ gtk_list_view_size_allocate (GtkWidget *widget,
 {
   GtkListView *self = GTK_LIST_VIEW (widget);
   ListRow *row;
-  GArray *heights;
   int min, nat, row_height;
+  gboolean has_unknown;
   int x, y;
   GtkOrientation orientation, opposite_orientation;
   GtkScrollablePolicy scroll_policy, opposite_scroll_policy;
@@ -608,9 +761,16 @@ gtk_list_view_size_allocate (GtkWidget *widget,
   else
     self->list_width = MAX (nat, self->list_width);
 
-  /* step 2: determine height of known list items */
-  heights = g_array_new (FALSE, FALSE, sizeof (int));
+  /* heights measured for a different width are useless */
+  if (self->list_width != self->estimate_width ||
+      orientation != self->estimate_orientation)
+    {
+      gtk_list_view_reset_estimate (self);
+      self->estimate_width = self->list_width;
+      self->estimate_orientation = orientation;
+    }
 
+  /* step 2: determine height of known list items */
   for (row = gtk_list_item_manager_get_first (self->item_manager);
        row != NULL;
        row = gtk_rb_tree_node_get_next (row))
@@ -625,17 +785,28 @@ gtk_list_view_size_allocate (GtkWidget *widget,
         row_height = min;
       else
         row_height = nat;
+
+      if (!row->measured)
+        {
+          self->estimate_sum += row_height;
+          self->estimate_count++;
+          row->measured = TRUE;
+        }
+      else
+        {
+          self->estimate_sum += row_height - (int) row->height;
+        }
+
       if (row->height != row_height)
         {
           row->height = row_height;
           gtk_rb_tree_node_mark_dirty (row);
         }
-      g_array_append_val (heights, row_height);
     }
 
   /* step 3: determine height of unknown items */
-  row_height = gtk_list_view_get_unknown_row_height (self, heights);
-  g_array_free (heights, TRUE);
+  row_height = gtk_list_view_get_estimated_row_height (self);
+  has_unknown = FALSE;
 
   for (row = gtk_list_item_manager_get_first (self->item_manager);
        row != NULL;
@@ -644,6 +815,14 @@ gtk_list_view_size_allocate (GtkWidget *widget,
       if (row->parent.widget)
         continue;
 
+      /* Rows keep their size after their widget went away, until
+       * they get merged with their neighbors.
+       */
+      if (row->measured && row->parent.n_items == 1)
+        continue;
+
+      has_unknown = TRUE;
+      row->measured = FALSE;
       if (row->height != row_height)
         {
           row->height = row_height;
@@ -651,6 +830,9 @@ gtk_list_view_size_allocate (GtkWidget *widget,
         }
     }
 
+  if (has_unknown)
+    gtk_list_view_queue_measure (self);
+
   /* step 3: update the adjustments */
   gtk_list_base_update_adjustments (GTK_LIST_BASE (self),
                                     self->list_width,
@@ -688,6 +870,7 @@ gtk_list_view_dispose (GObject *object)
 {
   GtkListView *self = GTK_LIST_VIEW (object);
 
+  gtk_list_view_clear_measure (self);
   self->item_manager = NULL;
 
   G_OBJECT_CLASS (gtk_list_view_parent_class)->dispose (object);
@@ -920,6 +1103,8 @@ gtk_list_view_init (GtkListView *self)
                                         GTK_LIST_VIEW_MAX_LIST_ITEMS,
                                         GTK_LIST_VIEW_EXTRA_ITEMS);
 
+  self->estimate_width = -1;
+
   gtk_widget_add_css_class (GTK_WIDGET (self), "view");
 }
 
@@ -994,6 +1179,8 @@ gtk_list_view_set_model (GtkListView       *self,
   if (!gtk_list_base_set_model (GTK_LIST_BASE (self), model))
     return;
 
+  gtk_list_view_reset_estimate (self);
+
   gtk_accessible_update_property (GTK_ACCESSIBLE (self),
                                   GTK_ACCESSIBLE_PROPERTY_MULTI_SELECTABLE, GTK_IS_MULTI_SELECTION (model),
                                   -1);
@@ -1036,6 +1223,9 @@ gtk_list_view_set_factory (GtkListView        *self,
 
   gtk_list_item_manager_set_factory (self->item_manager, factory);
 
+  gtk_list_view_clear_measure (self);
+  gtk_list_view_reset_estimate (self);
+
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FACTORY]);
 }
 
@@ -33,6 +33,17 @@ struct _GtkListView
   gboolean show_separators;
 
   int list_width;
+
+  /* Running estimate for the height of rows that have no widget */
+  gint64 estimate_sum;
+  guint estimate_count;
+  int estimate_width;
+  GtkOrientation estimate_orientation;
+
+  /* Hidden list item to measure rows without widgets in idle time */
+  GtkWidget *measure_widget;
+  guint measure_idle;
+  guint n_samples;
 };
 
 struct _GtkListViewClass
@@ -60,6 +60,15 @@
  * they are no longer needed and recreate them if necessary.
  */
 
+/* Items are tracked in a tree of ranges, which handles changes well.
+ * When many items are looked up without the model changing, we switch
+ * to an array indexed by position, which is a lot faster to look up.
+ * The first change switches back to the tree.
+ * We switch to the array after n_items / DENSE_LOOKUP_RATIO lookups,
+ * so that building it is paid for by the faster lookups. */
+#define DENSE_LOOKUP_RATIO 8
+#define DENSE_MIN_LOOKUPS 64
+
 enum {
   PROP_0,
   PROP_HAS_MAP,
@@ -90,7 +99,10 @@ struct _GtkMapListModel
   gpointer user_data;
   GDestroyNotify user_destroy;
 
-  GtkRbTree *items; /* NULL if map_func == NULL */
+  GtkRbTree *items; /* NULL if map_func == NULL, empty if dense is used */
+  gpointer *dense; /* mapped items by position or NULL */
+  guint n_dense;
+  guint n_lookups; /* since the last change */
 };
 
 struct _GtkMapListModelClass
@@ -140,6 +152,88 @@ gtk_map_list_model_get_nth (GtkRbTree *tree,
   return node;
 }
 
+static void
+gtk_map_list_model_clear_dense (GtkMapListModel *self)
+{
+  guint i;
+
+  if (self->dense == NULL)
+    return;
+
+  for (i = 0; i < self->n_dense; i++)
+    {
+      if (self->dense[i])
+        g_object_remove_weak_pointer (self->dense[i], &self->dense[i]);
+    }
+
+  g_clear_pointer (&self->dense, g_free);
+  self->n_dense = 0;
+}
+
+static void
+gtk_map_list_model_make_dense (GtkMapListModel *self)
+{
+  MapNode *node;
+  guint pos;
+
+  self->n_dense = g_list_model_get_n_items (self->model);
+  self->dense = g_new0 (gpointer, self->n_dense);
+
+  pos = 0;
+  for (node = gtk_rb_tree_get_first (self->items);
+       node != NULL;
+       node = gtk_rb_tree_node_get_next (node))
+    {
+      if (node->item)
+        {
+          self->dense[pos] = node->item;
+          g_object_remove_weak_pointer (node->item, &node->item);
+          node->item = NULL;
+          g_object_add_weak_pointer (self->dense[pos], &self->dense[pos]);
+        }
+      pos += node->n_items;
+    }
+
+  gtk_rb_tree_remove_all (self->items);
+}
+
+static void
+gtk_map_list_model_make_sparse (GtkMapListModel *self)
+{
+  MapNode *node;
+  guint i;
+
+  self->n_lookups = 0;
+
+  if (self->dense == NULL)
+    return;
+
+  node = NULL;
+  for (i = 0; i < self->n_dense; i++)
+    {
+      if (self->dense[i])
+        {
+          node = gtk_rb_tree_insert_before (self->items, NULL);
+          node->n_items = 1;
+          node->item = self->dense[i];
+          g_object_remove_weak_pointer (self->dense[i], &self->dense[i]);
+          g_object_add_weak_pointer (node->item, &node->item);
+          gtk_rb_tree_node_mark_dirty (node);
+          node = NULL;
+        }
+      else
+        {
+          if (node == NULL)
+            node = gtk_rb_tree_insert_before (self->items, NULL);
+          node->n_items++;
+          gtk_rb_tree_node_mark_dirty (node);
+        }
+    }
+
+  g_clear_pointer (&self->dense, g_free);
+  self->n_dense = 0;
+}
+
 static GType
 gtk_map_list_model_get_item_type (GListModel *list)
 {
@@ -171,6 +265,30 @@ gtk_map_list_model_get_item (GListModel *list,
   if (self->items == NULL)
     return g_list_model_get_item (self->model, position);
 
+  if (self->dense == NULL)
+    {
+      guint n_items = g_list_model_get_n_items (self->model);
+
+      self->n_lookups++;
+      if (n_items > 0 &&
+          self->n_lookups >= MAX (n_items / DENSE_LOOKUP_RATIO, DENSE_MIN_LOOKUPS))
+        gtk_map_list_model_make_dense (self);
+    }
+
+  if (self->dense)
+    {
+      if (position >= self->n_dense)
+        return NULL;
+
+      if (self->dense[position])
+        return g_object_ref (self->dense[position]);
+
+      self->dense[position] = self->map_func (g_list_model_get_item (self->model, position), self->user_data);
+      g_object_add_weak_pointer (self->dense[position], &self->dense[position]);
+
+      return self->dense[position];
+    }
+
   node = gtk_map_list_model_get_nth (self->items, position, &offset);
   if (node == NULL)
     return NULL;
@@ -227,6 +345,8 @@ gtk_map_list_model_items_changed_cb (GListModel      *model,
       return;
     }
 
+  gtk_map_list_model_make_sparse (self);
+
   node = gtk_map_list_model_get_nth (self->items, position, &start);
   g_assert (start <= position);
 
@@ -339,6 +459,7 @@ gtk_map_list_model_dispose (GObject *object)
   self->map_func = NULL;
   self->user_data = NULL;
   self->user_destroy = NULL;
+  gtk_map_list_model_clear_dense (self);
   g_clear_pointer (&self->items, gtk_rb_tree_unref);
 
   G_OBJECT_CLASS (gtk_map_list_model_parent_class)->dispose (object);
@@ -456,6 +577,9 @@ gtk_map_list_model_clear_node (gpointer _node)
 static void
 gtk_map_list_model_init_items (GtkMapListModel *self)
 {
+  gtk_map_list_model_clear_dense (self);
+  self->n_lookups = 0;
+
   if (self->map_func && self->model)
     {
       guint n_items;
@@ -22,6 +22,7 @@
 #include "gtkmultifilter.h"
 
 #include "gtkbuildable.h"
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
 
@@ -123,11 +124,30 @@ G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GtkMultiFilter, gtk_multi_filter, GTK_TYPE_FIL
                                   G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_multi_filter_list_model_init)
                                   G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE, gtk_multi_filter_buildable_init))
 
+static void
+gtk_multi_filter_update_thread_safe (GtkMultiFilter *self)
+{
+  gboolean thread_safe = TRUE;
+  guint i;
+
+  for (i = 0; i < gtk_filters_get_size (&self->filters); i++)
+    {
+      if (!gtk_filter_is_thread_safe (gtk_filters_get (&self->filters, i)))
+        {
+          thread_safe = FALSE;
+          break;
+        }
+    }
+
+  gtk_filter_set_thread_safe (GTK_FILTER (self), thread_safe);
+}
+
 static void
 gtk_multi_filter_changed_cb (GtkFilter       *filter,
                              GtkFilterChange  change,
                              GtkMultiFilter  *self)
 {
+  gtk_multi_filter_update_thread_safe (self);
   gtk_filter_changed (GTK_FILTER (self), change);
 }
 
@@ -160,6 +180,7 @@ static void
 gtk_multi_filter_init (GtkMultiFilter *self)
 {
   gtk_filters_init (&self->filters);
+  gtk_filter_set_thread_safe (GTK_FILTER (self), TRUE);
 }
 
 /**
@@ -178,6 +199,7 @@ gtk_multi_filter_append (GtkMultiFilter *self,
 
   g_signal_connect (filter, "changed", G_CALLBACK (gtk_multi_filter_changed_cb), self);
   gtk_filters_append (&self->filters, filter);
+  gtk_multi_filter_update_thread_safe (self);
 
   gtk_filter_changed (GTK_FILTER (self),
                       GTK_MULTI_FILTER_GET_CLASS (self)->addition_change);
@@ -207,6 +229,7 @@ gtk_multi_filter_remove (GtkMultiFilter *self,
   filter = gtk_filters_get (&self->filters, position);
   g_signal_handlers_disconnect_by_func (filter, gtk_multi_filter_changed_cb, self);
   gtk_filters_splice (&self->filters, position, 1, FALSE, NULL, 0);
+  gtk_multi_filter_update_thread_safe (self);
 
   gtk_filter_changed (GTK_FILTER (self),
                       GTK_MULTI_FILTER_GET_CLASS (self)->removal_change);
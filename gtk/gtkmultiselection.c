@@ -25,6 +25,10 @@
 #include "gtkintl.h"
 #include "gtkselectionmodel.h"
 
+/* Selection changes spanning at least this many items
+ * compress the selection afterwards */
+#define GTK_MULTI_SELECTION_OPTIMIZE_SIZE 4096
+
 /**
  * SECTION:gtkmultiselection
  * @Short_description: A selection model that allows selecting multiple items
@@ -188,6 +192,12 @@ gtk_multi_selection_set_selection (GtkSelectionModel *model,
   /* actually do the change */
   gtk_multi_selection_toggle_selection (self, changes);
 
+  /* large changes like selecting everything usually leave large
+   * ranges behind that are cheaper to keep as runs
+   */
+  if (min <= max && max - min >= GTK_MULTI_SELECTION_OPTIMIZE_SIZE)
+    gtk_bitset_optimize (self->selected);
+
   gtk_bitset_unref (changes);
 
   if (min <= max)
@@ -220,6 +230,7 @@ gtk_multi_selection_items_changed_cb (GListModel        *model,
   GHashTableIter iter;
   gpointer item, pos_pointer;
   GHashTable *pending = NULL;
+  GArray *reselected = NULL;
   guint i;
 
   gtk_bitset_splice (self->selected, position, removed, added);
@@ -249,12 +260,15 @@ gtk_multi_selection_items_changed_cb (GListModel        *model,
         }
     }
 
+  if (pending != NULL)
+    reselected = g_array_new (FALSE, FALSE, sizeof (guint));
+
   for (i = position; pending != NULL && i < position + added; i++)
     {
       item = g_list_model_get_item (model, i);
       if (g_hash_table_contains (pending, item))
         {
-          gtk_bitset_add (self->selected, i);
+          g_array_append_val (reselected, i);
           g_hash_table_insert (self->items, item, GUINT_TO_POINTER (i));
           g_hash_table_remove (pending, item);
           if (g_hash_table_size (pending) == 0)
@@ -268,6 +282,12 @@ gtk_multi_selection_items_changed_cb (GListModel        *model,
 
   g_clear_pointer (&pending, g_hash_table_unref);
 
+  if (reselected != NULL)
+    {
+      gtk_bitset_add_many (self->selected, (guint *) reselected->data, reselected->len);
+      g_array_free (reselected, TRUE);
+    }
+
   g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
 }
 
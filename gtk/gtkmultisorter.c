@@ -173,9 +173,11 @@ gtk_multi_sort_keys_new (GtkMultiSorter *self)
   result = (GtkMultiSortKeys *) keys;
 
   result->n_keys = gtk_sorters_get_size (&self->sorters);
+  keys->thread_safe = TRUE;
   for (i = 0; i < result->n_keys; i++)
     {
       result->keys[i].keys = gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, i));
+      keys->thread_safe &= gtk_sort_keys_is_thread_safe (result->keys[i].keys);
       result->keys[i].offset = GTK_SORT_KEYS_ALIGN (keys->key_size, gtk_sort_keys_get_key_align (result->keys[i].keys));
       keys->key_size = result->keys[i].offset + gtk_sort_keys_get_key_size (result->keys[i].keys);
       keys->key_align = MAX (keys->key_align, gtk_sort_keys_get_key_align (result->keys[i].keys));
@@ -308,9 +310,10 @@ gtk_multi_sorter_changed_cb (GtkSorter       *sorter,
   {
     case GTK_SORTER_CHANGE_INVERTED:
       /* This could do a lot better with change handling, in particular in
-       * cases where self->n_sorters == 1 or if sorter == self->sorters[0]
+       * cases where sorter == self->sorters[0]
        */
-      change = GTK_SORTER_CHANGE_DIFFERENT;
+      if (gtk_sorters_get_size (&self->sorters) > 1)
+        change = GTK_SORTER_CHANGE_DIFFERENT;
       break;
 
     case GTK_SORTER_CHANGE_DIFFERENT:
@@ -45,6 +45,7 @@ struct _GtkNumericSorter
   GtkSortType sort_order;
 
   GtkExpression *expression;
+  GtkExpressionCache *cache;
 };
 
 enum {
@@ -329,6 +330,7 @@ gtk_numeric_sort_keys_new (GtkNumericSorter *self)
     }
 
   result->expression = gtk_expression_ref (self->expression);
+  result->keys.thread_safe = gtk_expression_is_thread_safe (self->expression);
 
   return (GtkSortKeys *) result;
 }
@@ -349,8 +351,8 @@ gtk_numeric_sorter_compare (GtkSorter *sorter,
   if (self->expression == NULL)
     return GTK_ORDERING_EQUAL;
 
-  res1 = gtk_expression_evaluate (self->expression, item1, &value1);
-  res2 = gtk_expression_evaluate (self->expression, item2, &value2);
+  res1 = gtk_expression_cache_evaluate (self->cache, item1, &value1);
+  res2 = gtk_expression_cache_evaluate (self->cache, item2, &value2);
 
   /* If items don't evaluate, order them at the end, so they aren't
    * in the way. */
@@ -522,6 +524,7 @@ gtk_numeric_sorter_dispose (GObject *object)
 {
   GtkNumericSorter *self = GTK_NUMERIC_SORTER (object);
 
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
 
   G_OBJECT_CLASS (gtk_numeric_sorter_parent_class)->dispose (object);
@@ -641,9 +644,13 @@ gtk_numeric_sorter_set_expression (GtkNumericSorter *self,
   if (self->expression == expression)
     return;
 
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
   if (expression)
-    self->expression = gtk_expression_ref (expression);
+    {
+      self->expression = gtk_expression_ref (expression);
+      self->cache = gtk_expression_cache_new (expression);
+    }
 
   gtk_sorter_changed_with_keys (GTK_SORTER (self),
                                 GTK_SORTER_CHANGE_DIFFERENT,
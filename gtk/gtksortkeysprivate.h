@@ -20,6 +20,7 @@
 
 #include <gdk/gdk.h>
 #include <gtk/gtkenums.h>
+#include "gtk/gtkexpressionprivate.h"
 #include <gtk/gtksorter.h>
 
 typedef struct _GtkSortKeys GtkSortKeys;
@@ -32,6 +33,11 @@ struct _GtkSortKeys
 
   gsize key_size;
   gsize key_align; /* must be power of 2 */
+
+  /* TRUE if init_key() and key_compare may be called from multiple
+   * threads at once, as long as the property getters of the items
+   * are thread-safe. Only threaded sort list models make use of it. */
+  gboolean thread_safe;
 };
 
 struct _GtkSortKeysClass
@@ -67,6 +73,7 @@ GCompareDataFunc        gtk_sort_keys_get_key_compare_func      (GtkSortKeys
 gboolean                gtk_sort_keys_is_compatible             (GtkSortKeys            *self,
                                                                  GtkSortKeys            *other);
 gboolean                gtk_sort_keys_needs_clear_key           (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_is_thread_safe            (GtkSortKeys            *self);
 
 #define GTK_SORT_KEYS_ALIGN(_size,_align) (((_size) + (_align) - 1) & ~((_align) - 1))
 static inline int
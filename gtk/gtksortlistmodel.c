@@ -24,7 +24,9 @@
 #include "gtkbitset.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
+#include "gtkrbtreeprivate.h"
 #include "gtksorterprivate.h"
+#include "gtkthreadpoolprivate.h"
 #include "timsort/gtktimsortprivate.h"
 
 /* The maximum amount of items to merge for a single merge step
@@ -52,6 +54,24 @@
  */
 #define GTK_SORT_STEP_TIME_US (1000) /* 1 millisecond */
 
+/* Minimum number of missing keys before key generation is split
+ * into chunks that run in parallel on a thread pool.
+ *
+ * This only happens for threaded models with thread-safe sort keys.
+ */
+#define GTK_SORT_PARALLEL_KEYS_MIN (4096)
+#define GTK_SORT_KEYS_CHUNK_SIZE (1024)
+
+/* Minimum number of items before a non-incremental sort of a
+ * threaded model with thread-safe sort keys is done on multiple threads.
+ */
+#define GTK_SORT_PARALLEL_MIN (65536)
+
+/* Maximum number of added plus removed items that are put into
+ * place one by one with binary searches instead of resorting.
+ */
+#define GTK_SORT_MAX_INCREMENTAL_CHANGE (64)
+
 /**
  * SECTION:gtksortlistmodel
  * @title: GtkSortListModel
@@ -70,17 +90,32 @@
  * If you run into performance issues with #GtkSortListModel, it
  * is strongly recommended that you write your own sorting list
  * model.
+ *
+ * For very large models that change frequently, the model can be
+ * created with #GtkSortListModel:indexed set, so that inserting and
+ * removing items does not need to move the whole list of sorted
+ * positions around.
+ *
+ * For sorters that support it, sorting can also be spread over
+ * multiple threads. See gtk_sort_list_model_set_threaded().
  */
 
 enum {
   PROP_0,
   PROP_INCREMENTAL,
+  PROP_INDEXED,
   PROP_MODEL,
   PROP_PENDING,
   PROP_SORTER,
+  PROP_THREADED,
   NUM_PROPERTIES
 };
 
+typedef struct _GtkSortKeysJob GtkSortKeysJob;
+typedef struct _SortItem SortItem;
+typedef struct _SortPosition SortPosition;
+typedef struct _SortAugment SortAugment;
+
 struct _GtkSortListModel
 {
   GObject parent_instance;
@@ -88,6 +123,7 @@ struct _GtkSortListModel
   GListModel *model;
   GtkSorter *sorter;
   gboolean incremental;
+  gboolean threaded;
 
   GtkTimSort sort; /* ongoing sort operation */
   guint sort_cb; /* 0 or current ongoing sort callback */
@@ -97,8 +133,35 @@ struct _GtkSortListModel
   gsize key_size;
   gpointer keys;
   GtkBitset *missing_keys;
+  GtkSortKeysJob *keys_job; /* parallel generation of missing_keys */
 
   gpointer *positions;
+  gboolean unsorted; /* keys were just created, positions have no known runs */
+
+  /* When indexed, a fully sorted model keeps its keys in trees
+   * instead of keys and positions
+   */
+  gboolean indexed;
+  GtkRbTree *item_tree; /* SortItems in model order, owning the keys */
+  GtkRbTree *position_tree; /* SortPositions in sorted order */
+  gsize key_offset; /* offset of the key in a SortItem */
+};
+
+struct _SortItem
+{
+  SortPosition *position;
+  guint index; /* only valid while flattening the tree */
+  /* key follows at key_offset */
+};
+
+struct _SortPosition
+{
+  SortItem *item;
+};
+
+struct _SortAugment
+{
+  guint n_items;
 };
 
 struct _GtkSortListModelClass
@@ -108,6 +171,108 @@ struct _GtkSortListModelClass
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
+/* A GtkSortKeysJob generates the keys for a set of items, split into
+ * chunks. Chunks are processed by the thread pool and by the main
+ * thread, whichever gets to them first.
+ *
+ * The items are fetched from the model on the main thread, only the
+ * key generation itself happens in the threads.
+ */
+struct _GtkSortKeysJob
+{
+  int ref_count;
+
+  GtkSortKeys *sort_keys;
+  gpointer *items;
+  gpointer *keys;
+  guint n_items;
+
+  guint n_chunks;
+  int next_chunk; /* atomic */
+  int n_done; /* atomic, number of items with keys */
+
+  GMutex lock;
+  GCond cond;
+  guint n_finished_chunks; /* protected by lock */
+};
+
+static GtkSortKeysJob *
+gtk_sort_keys_job_ref (GtkSortKeysJob *job)
+{
+  g_atomic_int_inc (&job->ref_count);
+
+  return job;
+}
+
+static void
+gtk_sort_keys_job_unref (GtkSortKeysJob *job)
+{
+  if (!g_atomic_int_dec_and_test (&job->ref_count))
+    return;
+
+  g_mutex_clear (&job->lock);
+  g_cond_clear (&job->cond);
+  g_slice_free (GtkSortKeysJob, job);
+}
+
+/* Processes chunks until none are left or @end_time is reached */
+static void
+gtk_sort_keys_job_run (GtkSortKeysJob *job,
+                       gint64          end_time)
+{
+  guint chunk, i, start, end;
+
+  while ((chunk = g_atomic_int_add (&job->next_chunk, 1)) < job->n_chunks)
+    {
+      start = chunk * GTK_SORT_KEYS_CHUNK_SIZE;
+      end = MIN (start + GTK_SORT_KEYS_CHUNK_SIZE, job->n_items);
+
+      for (i = start; i < end; i++)
+        gtk_sort_keys_init_key (job->sort_keys, job->items[i], job->keys[i]);
+
+      g_atomic_int_add (&job->n_done, end - start);
+
+      g_mutex_lock (&job->lock);
+      job->n_finished_chunks++;
+      if (job->n_finished_chunks == job->n_chunks)
+        g_cond_broadcast (&job->cond);
+      g_mutex_unlock (&job->lock);
+
+      if (g_get_monotonic_time () >= end_time)
+        break;
+    }
+}
+
+static void
+gtk_sort_keys_job_thread (gpointer data)
+{
+  GtkSortKeysJob *job = data;
+
+  gtk_sort_keys_job_run (job, G_MAXINT64);
+  gtk_sort_keys_job_unref (job);
+}
+
+/* Returns TRUE if all chunks are done */
+static gboolean
+gtk_sort_keys_job_wait (GtkSortKeysJob *job,
+                        gint64          end_time)
+{
+  gboolean done;
+
+  g_mutex_lock (&job->lock);
+  while (job->n_finished_chunks < job->n_chunks)
+    {
+      if (end_time == G_MAXINT64)
+        g_cond_wait (&job->cond, &job->lock);
+      else if (!g_cond_wait_until (&job->cond, &job->lock, end_time))
+        break;
+    }
+  done = job->n_finished_chunks == job->n_chunks;
+  g_mutex_unlock (&job->lock);
+
+  return done;
+}
+
 static guint
 pos_from_key (GtkSortListModel *self,
               gpointer          key)
@@ -126,6 +291,101 @@ key_from_pos (GtkSortListModel *self,
   return (char *) self->keys + self->key_size * pos;
 }
 
+static void
+sort_augment (GtkRbTree *tree,
+              gpointer   _aug,
+              gpointer   node,
+              gpointer   left,
+              gpointer   right)
+{
+  SortAugment *aug = _aug;
+
+  aug->n_items = 1;
+
+  if (left)
+    {
+      SortAugment *left_aug = gtk_rb_tree_get_augment (tree, left);
+      aug->n_items += left_aug->n_items;
+    }
+  if (right)
+    {
+      SortAugment *right_aug = gtk_rb_tree_get_augment (tree, right);
+      aug->n_items += right_aug->n_items;
+    }
+}
+
+static gpointer
+sort_tree_get_nth (GtkRbTree *tree,
+                   guint      position)
+{
+  gpointer node, tmp;
+
+  node = gtk_rb_tree_get_root (tree);
+
+  while (node)
+    {
+      tmp = gtk_rb_tree_node_get_left (node);
+      if (tmp)
+        {
+          SortAugment *aug = gtk_rb_tree_get_augment (tree, tmp);
+          if (position < aug->n_items)
+            {
+              node = tmp;
+              continue;
+            }
+          position -= aug->n_items;
+        }
+
+      if (position == 0)
+        return node;
+
+      position--;
+      node = gtk_rb_tree_node_get_right (node);
+    }
+
+  return NULL;
+}
+
+static guint
+sort_tree_get_index (GtkRbTree *tree,
+                     gpointer   node)
+{
+  gpointer left, parent;
+  guint result = 0;
+
+  left = gtk_rb_tree_node_get_left (node);
+  if (left)
+    {
+      SortAugment *aug = gtk_rb_tree_get_augment (tree, left);
+      result += aug->n_items;
+    }
+
+  for (;
+       (parent = gtk_rb_tree_node_get_parent (node)) != NULL;
+       node = parent)
+    {
+      left = gtk_rb_tree_node_get_left (parent);
+      if (left == node)
+        continue;
+
+      if (left)
+        {
+          SortAugment *aug = gtk_rb_tree_get_augment (tree, left);
+          result += aug->n_items;
+        }
+      result++;
+    }
+
+  return result;
+}
+
+static gpointer
+sort_item_get_key (GtkSortListModel *self,
+                   SortItem         *item)
+{
+  return (char *) item + self->key_offset;
+}
+
 static GType
 gtk_sort_list_model_get_item_type (GListModel *list)
 {
@@ -155,7 +415,12 @@ gtk_sort_list_model_get_item (GListModel *list,
   if (position >= self->n_items)
     return NULL;
 
-  if (self->positions)
+  if (self->position_tree)
+    {
+      SortPosition *pos = sort_tree_get_nth (self->position_tree, position);
+      position = sort_tree_get_index (self->item_tree, pos->item);
+    }
+  else if (self->positions)
     position = pos_from_key (self, self->positions[position]);
 
   return g_list_model_get_item (self->model, position);
@@ -178,10 +443,20 @@ gtk_sort_list_model_is_sorting (GtkSortListModel *self)
   return self->sort_cb != 0;
 }
 
+static void gtk_sort_list_model_finish_keys_job (GtkSortListModel *self);
+static void gtk_sort_list_model_flatten_tree (GtkSortListModel *self);
+
 static void
 gtk_sort_list_model_stop_sorting (GtkSortListModel *self,
                                   gsize            *runs)
 {
+  /* Everything that stops sorting works on the arrays */
+  gtk_sort_list_model_flatten_tree (self);
+
+  /* Threads may still write to the keys, so let them finish */
+  if (self->keys_job)
+    gtk_sort_list_model_finish_keys_job (self);
+
   if (self->sort_cb == 0)
     {
       if (runs)
@@ -200,6 +475,93 @@ gtk_sort_list_model_stop_sorting (GtkSortListModel *self,
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
 }
 
+static int
+sort_func (gconstpointer a,
+           gconstpointer b,
+           gpointer      data)
+{
+  gpointer *sa = (gpointer *) a;
+  gpointer *sb = (gpointer *) b;
+  int result;
+
+  result = gtk_sort_keys_compare (data, *sa, *sb);
+  if (result)
+    return result;
+
+  return *sa < *sb ? -1 : 1;
+}
+
+static gboolean
+gtk_sort_list_model_should_thread (GtkSortListModel *self)
+{
+  return self->threaded &&
+         gtk_sort_keys_is_thread_safe (self->sort_keys) &&
+         g_get_num_processors () > 1;
+}
+
+static gboolean
+gtk_sort_list_model_start_keys_job (GtkSortListModel *self)
+{
+  GtkSortKeysJob *job;
+  GtkBitsetIter iter;
+  guint i, pos, n_threads;
+
+  if (!gtk_sort_list_model_should_thread (self) ||
+      gtk_bitset_get_size (self->missing_keys) < GTK_SORT_PARALLEL_KEYS_MIN ||
+      g_get_num_processors () < 2)
+    return FALSE;
+
+  job = g_slice_new0 (GtkSortKeysJob);
+  job->ref_count = 1;
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->cond);
+  job->sort_keys = gtk_sort_keys_ref (self->sort_keys);
+  job->n_items = gtk_bitset_get_size (self->missing_keys);
+  job->items = g_new (gpointer, job->n_items);
+  job->keys = g_new (gpointer, job->n_items);
+  job->n_chunks = (job->n_items + GTK_SORT_KEYS_CHUNK_SIZE - 1) / GTK_SORT_KEYS_CHUNK_SIZE;
+
+  i = 0;
+  for (gtk_bitset_iter_init_first (&iter, self->missing_keys, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      job->items[i] = g_list_model_get_item (self->model, pos);
+      job->keys[i] = key_from_pos (self, pos);
+      i++;
+    }
+
+  n_threads = MIN (job->n_chunks, gtk_thread_pool_get_max_threads ());
+  for (i = 0; i < n_threads; i++)
+    gtk_thread_pool_push (gtk_sort_keys_job_thread, gtk_sort_keys_job_ref (job));
+
+  self->keys_job = job;
+
+  return TRUE;
+}
+
+static void
+gtk_sort_list_model_finish_keys_job (GtkSortListModel *self)
+{
+  GtkSortKeysJob *job = self->keys_job;
+  guint i;
+
+  gtk_sort_keys_job_run (job, G_MAXINT64);
+  gtk_sort_keys_job_wait (job, G_MAXINT64);
+
+  for (i = 0; i < job->n_items; i++)
+    g_object_unref (job->items[i]);
+  g_free (job->items);
+  g_free (job->keys);
+  gtk_sort_keys_unref (job->sort_keys);
+
+  /* the job covered all missing keys */
+  gtk_bitset_remove_all (self->missing_keys);
+
+  self->keys_job = NULL;
+  gtk_sort_keys_job_unref (job);
+}
+
 static gboolean
 gtk_sort_list_model_sort_step (GtkSortListModel *self,
                                gboolean          finish,
@@ -213,6 +575,27 @@ gtk_sort_list_model_sort_step (GtkSortListModel *self,
 
   end_time += GTK_SORT_STEP_TIME_US;
 
+  if (self->keys_job == NULL && !gtk_bitset_is_empty (self->missing_keys))
+    gtk_sort_list_model_start_keys_job (self);
+
+  if (self->keys_job)
+    {
+      if (!finish)
+        {
+          /* help out, but don't block for longer than a step */
+          gtk_sort_keys_job_run (self->keys_job, end_time);
+          if (!gtk_sort_keys_job_wait (self->keys_job, end_time))
+            {
+              *out_position = 0;
+              *out_n_items = 0;
+              return TRUE;
+            }
+        }
+
+      gtk_sort_list_model_finish_keys_job (self);
+      result = TRUE;
+    }
+
   if (!gtk_bitset_is_empty (self->missing_keys))
     {
       GtkBitsetIter iter;
@@ -241,6 +624,47 @@ gtk_sort_list_model_sort_step (GtkSortListModel *self,
   end_change = self->positions;
   start_change = self->positions + self->n_items;
 
+  if (finish &&
+      self->unsorted &&
+      self->n_items >= GTK_SORT_PARALLEL_MIN &&
+      gtk_sort_list_model_should_thread (self))
+    {
+      gpointer *old_positions;
+      guint start, end;
+
+      old_positions = g_memdup (self->positions, sizeof (gpointer) * self->n_items);
+
+      /* This leaves the array sorted, so the remaining steps only
+       * need to walk the runs once.
+       */
+      gtk_tim_sort_parallel (self->positions,
+                             self->n_items,
+                             sizeof (gpointer),
+                             sort_func,
+                             self->sort_keys,
+                             g_get_num_processors ());
+
+      for (start = 0; start < self->n_items; start++)
+        {
+          if (self->positions[start] != old_positions[start])
+            break;
+        }
+      for (end = self->n_items; end > start; end--)
+        {
+          if (self->positions[end - 1] != old_positions[end - 1])
+            break;
+        }
+      g_free (old_positions);
+
+      if (start < end)
+        {
+          start_change = self->positions + start;
+          end_change = self->positions + end;
+        }
+      result = TRUE;
+    }
+  self->unsorted = FALSE;
+
   while (gtk_tim_sort_step (&self->sort, &change))
     {
       result = TRUE;
@@ -283,25 +707,10 @@ gtk_sort_list_model_sort_cb (gpointer data)
     }
 
   gtk_sort_list_model_stop_sorting (self, NULL);
+  gtk_sort_list_model_build_tree (self);
   return G_SOURCE_REMOVE;
 }
 
-static int
-sort_func (gconstpointer a,
-           gconstpointer b,
-           gpointer      data)
-{
-  gpointer *sa = (gpointer *) a;
-  gpointer *sb = (gpointer *) b;
-  int result;
-
-  result = gtk_sort_keys_compare (data, *sa, *sb);
-  if (result)
-    return result;
-
-  return *sa < *sb ? -1 : 1;
-}
-
 static gboolean
 gtk_sort_list_model_start_sorting (GtkSortListModel *self,
                                    gsize            *runs)
@@ -436,6 +845,7 @@ gtk_sort_list_model_create_keys (GtkSortListModel *self)
   self->key_size = gtk_sort_keys_get_key_size (self->sort_keys);
   self->keys = g_malloc_n (self->n_items, self->key_size);
   self->missing_keys = gtk_bitset_new_range (0, self->n_items);
+  self->unsorted = TRUE;
 }
 
 static void
@@ -474,6 +884,7 @@ gtk_sort_list_model_update_items (GtkSortListModel *self,
   n_items = self->n_items;
   start = n_items;
   end = n_items;
+  self->unsorted = FALSE;
   
   /* first, move the keys over */
   old_keys = self->keys;
@@ -558,6 +969,337 @@ gtk_sort_list_model_update_items (GtkSortListModel *self,
   *unmodified_end = end;
 }
 
+/* Index of the first entry in positions[0..n_items) that doesn't sort before key */
+static guint
+gtk_sort_list_model_find_position (GtkSortListModel *self,
+                                   guint             n_items,
+                                   gpointer          key)
+{
+  guint lo = 0, hi = n_items;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (sort_func (&self->positions[mid], &key, self->sort_keys) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/* Fast path for small changes to a fully sorted model: find the
+ * sorted position of every removed and added item with a binary
+ * search and only emit the range that actually changed.
+ */
+static gboolean
+gtk_sort_list_model_try_update_small (GtkSortListModel *self,
+                                      guint             position,
+                                      guint             removed,
+                                      guint             added)
+{
+  guint i, idx, n_items, n_valid, start, end;
+  gsize threshold;
+  gssize shift;
+  char *old_keys;
+
+  if (removed + added > GTK_SORT_MAX_INCREMENTAL_CHANGE ||
+      self->sort_keys == NULL ||
+      self->key_size == 0 ||
+      gtk_sort_list_model_is_sorting (self) ||
+      !gtk_bitset_is_empty (self->missing_keys))
+    return FALSE;
+
+  n_items = self->n_items;
+  start = n_items;
+  end = n_items;
+
+  for (i = 0; i < removed; i++)
+    {
+      gpointer key = key_from_pos (self, position + i);
+      guint n = n_items - i;
+
+      idx = gtk_sort_list_model_find_position (self, n, key);
+      g_assert (self->positions[idx] == key);
+
+      start = MIN (start, idx);
+      end = MIN (end, n - idx - 1);
+
+      gtk_sort_keys_clear_key (self->sort_keys, key);
+      memmove (&self->positions[idx], &self->positions[idx + 1], sizeof (gpointer) * (n - idx - 1));
+    }
+
+  n_valid = n_items - removed;
+
+  /* move the keys over and fix up the positions pointing to them */
+  old_keys = self->keys;
+  if (removed > added)
+    {
+      memmove (key_from_pos (self, position + added),
+               key_from_pos (self, position + removed),
+               self->key_size * (n_items - position - removed));
+      self->keys = g_realloc_n (self->keys, n_valid + added, self->key_size);
+    }
+  else if (removed < added)
+    {
+      self->keys = g_realloc_n (self->keys, n_valid + added, self->key_size);
+      memmove (key_from_pos (self, position + added),
+               key_from_pos (self, position + removed),
+               self->key_size * (n_items - position - removed));
+      self->positions = g_renew (gpointer, self->positions, n_valid + added);
+    }
+
+  threshold = self->key_size * (position + removed);
+  shift = ((gssize) added - (gssize) removed) * (gssize) self->key_size;
+  if ((char *) self->keys != old_keys || (shift != 0 && position + removed < n_items))
+    {
+      for (i = 0; i < n_valid; i++)
+        {
+          gsize offset = (char *) self->positions[i] - old_keys;
+
+          if (offset >= threshold)
+            offset += shift;
+          self->positions[i] = (char *) self->keys + offset;
+        }
+    }
+
+  if (removed > added)
+    self->positions = g_renew (gpointer, self->positions, n_valid + added);
+
+  self->n_items = n_valid + added;
+
+  for (i = 0; i < added; i++)
+    {
+      gpointer key = key_from_pos (self, position + i);
+      gpointer item = g_list_model_get_item (self->model, position + i);
+      guint n = n_valid + i;
+
+      gtk_sort_keys_init_key (self->sort_keys, item, key);
+      g_object_unref (item);
+
+      idx = gtk_sort_list_model_find_position (self, n, key);
+
+      start = MIN (start, idx);
+      end = MIN (end, n - idx);
+
+      memmove (&self->positions[idx + 1], &self->positions[idx], sizeof (gpointer) * (n - idx));
+      self->positions[idx] = key;
+    }
+
+  g_list_model_items_changed (G_LIST_MODEL (self),
+                              start,
+                              n_items - start - end,
+                              self->n_items - start - end);
+
+  return TRUE;
+}
+
+/* Moves the keys of a fully sorted model into the trees.
+ *
+ * This is a no-op unless the model is indexed.
+ */
+static void
+gtk_sort_list_model_build_tree (GtkSortListModel *self)
+{
+  SortItem **items;
+  SortItem *item;
+  SortPosition *position;
+  guint i;
+
+  if (!self->indexed ||
+      self->item_tree != NULL ||
+      self->sort_keys == NULL ||
+      self->key_size == 0 ||
+      self->n_items == 0 ||
+      gtk_sort_list_model_is_sorting (self))
+    return;
+
+  g_assert (gtk_bitset_is_empty (self->missing_keys));
+
+  self->key_offset = GTK_SORT_KEYS_ALIGN (sizeof (SortItem), gtk_sort_keys_get_key_align (self->sort_keys));
+  self->item_tree = gtk_rb_tree_new_for_size (self->key_offset + self->key_size,
+                                              sizeof (SortAugment),
+                                              sort_augment,
+                                              NULL, NULL);
+  self->position_tree = gtk_rb_tree_new (SortPosition,
+                                         SortAugment,
+                                         sort_augment,
+                                         NULL, NULL);
+
+  items = g_new (SortItem *, self->n_items);
+  item = NULL;
+  for (i = 0; i < self->n_items; i++)
+    {
+      item = gtk_rb_tree_insert_after (self->item_tree, item);
+      memcpy (sort_item_get_key (self, item), key_from_pos (self, i), self->key_size);
+      items[i] = item;
+    }
+
+  position = NULL;
+  for (i = 0; i < self->n_items; i++)
+    {
+      position = gtk_rb_tree_insert_after (self->position_tree, position);
+      position->item = items[pos_from_key (self, self->positions[i])];
+      position->item->position = position;
+    }
+  g_free (items);
+
+  /* the keys are owned by the tree now */
+  g_clear_pointer (&self->positions, g_free);
+  g_clear_pointer (&self->keys, g_free);
+}
+
+/* Moves the keys back from the trees into keys and positions */
+static void
+gtk_sort_list_model_flatten_tree (GtkSortListModel *self)
+{
+  SortItem *item;
+  SortPosition *position;
+  guint i;
+
+  if (self->item_tree == NULL)
+    return;
+
+  g_assert (self->keys == NULL);
+  g_assert (self->positions == NULL);
+
+  self->keys = g_malloc_n (self->n_items, self->key_size);
+  self->positions = g_new (gpointer, self->n_items);
+
+  for (item = gtk_rb_tree_get_first (self->item_tree), i = 0;
+       item != NULL;
+       item = gtk_rb_tree_node_get_next (item), i++)
+    {
+      memcpy (key_from_pos (self, i), sort_item_get_key (self, item), self->key_size);
+      item->index = i;
+    }
+  g_assert (i == self->n_items);
+
+  for (position = gtk_rb_tree_get_first (self->position_tree), i = 0;
+       position != NULL;
+       position = gtk_rb_tree_node_get_next (position), i++)
+    {
+      self->positions[i] = key_from_pos (self, position->item->index);
+    }
+
+  g_clear_pointer (&self->item_tree, gtk_rb_tree_unref);
+  g_clear_pointer (&self->position_tree, gtk_rb_tree_unref);
+}
+
+/* Like sort_func(), ties are broken by position in the model */
+static int
+gtk_sort_list_model_compare_items (GtkSortListModel *self,
+                                   SortItem         *a,
+                                   SortItem         *b)
+{
+  int result;
+
+  result = gtk_sort_keys_compare (self->sort_keys,
+                                  sort_item_get_key (self, a),
+                                  sort_item_get_key (self, b));
+  if (result)
+    return result;
+
+  if (sort_tree_get_index (self->item_tree, a) < sort_tree_get_index (self->item_tree, b))
+    return -1;
+  else
+    return 1;
+}
+
+/* First position that doesn't sort before @item or %NULL if none */
+static SortPosition *
+gtk_sort_list_model_find_tree_position (GtkSortListModel *self,
+                                        SortItem         *item)
+{
+  SortPosition *node, *result;
+
+  result = NULL;
+  node = gtk_rb_tree_get_root (self->position_tree);
+
+  while (node)
+    {
+      if (gtk_sort_list_model_compare_items (self, node->item, item) < 0)
+        {
+          node = gtk_rb_tree_node_get_right (node);
+        }
+      else
+        {
+          result = node;
+          node = gtk_rb_tree_node_get_left (node);
+        }
+    }
+
+  return result;
+}
+
+/* The indexed version of gtk_sort_list_model_try_update_small().
+ * Every removed or added item costs O(log² n), no matter the size
+ * of the model.
+ */
+static gboolean
+gtk_sort_list_model_try_update_tree (GtkSortListModel *self,
+                                     guint             position,
+                                     guint             removed,
+                                     guint             added)
+{
+  guint i, idx, n_items, start, end;
+
+  if (removed + added > GTK_SORT_MAX_INCREMENTAL_CHANGE)
+    return FALSE;
+
+  n_items = self->n_items;
+  start = n_items;
+  end = n_items;
+
+  for (i = 0; i < removed; i++)
+    {
+      SortItem *item = sort_tree_get_nth (self->item_tree, position);
+      guint n = n_items - i;
+
+      idx = sort_tree_get_index (self->position_tree, item->position);
+
+      start = MIN (start, idx);
+      end = MIN (end, n - idx - 1);
+
+      gtk_sort_keys_clear_key (self->sort_keys, sort_item_get_key (self, item));
+      gtk_rb_tree_remove (self->position_tree, item->position);
+      gtk_rb_tree_remove (self->item_tree, item);
+    }
+
+  for (i = 0; i < added; i++)
+    {
+      SortItem *item;
+      gpointer object;
+      guint n = n_items - removed + i;
+
+      item = gtk_rb_tree_insert_before (self->item_tree,
+                                        sort_tree_get_nth (self->item_tree, position + i));
+      object = g_list_model_get_item (self->model, position + i);
+      gtk_sort_keys_init_key (self->sort_keys, object, sort_item_get_key (self, item));
+      g_object_unref (object);
+
+      item->position = gtk_rb_tree_insert_before (self->position_tree,
+                                                  gtk_sort_list_model_find_tree_position (self, item));
+      item->position->item = item;
+
+      idx = sort_tree_get_index (self->position_tree, item->position);
+
+      start = MIN (start, idx);
+      end = MIN (end, n - idx);
+    }
+
+  self->n_items = n_items - removed + added;
+
+  g_list_model_items_changed (G_LIST_MODEL (self),
+                              start,
+                              n_items - start - end,
+                              self->n_items - start - end);
+
+  return TRUE;
+}
+
 static void
 gtk_sort_list_model_items_changed_cb (GListModel       *model,
                                       guint             position,
@@ -579,6 +1321,16 @@ gtk_sort_list_model_items_changed_cb (GListModel       *model,
       return;
     }
 
+  if (self->item_tree &&
+      gtk_sort_list_model_try_update_tree (self, position, removed, added))
+    return;
+
+  if (gtk_sort_list_model_try_update_small (self, position, removed, added))
+    {
+      gtk_sort_list_model_build_tree (self);
+      return;
+    }
+
   was_sorting = gtk_sort_list_model_is_sorting (self);
   gtk_sort_list_model_stop_sorting (self, runs);
 
@@ -614,6 +1366,8 @@ gtk_sort_list_model_items_changed_cb (GListModel       *model,
         gtk_sort_list_model_start_sorting (self, runs);
     }
 
+  gtk_sort_list_model_build_tree (self);
+
   n_items = self->n_items - start - end;
   g_list_model_items_changed (G_LIST_MODEL (self), start, n_items - added + removed, n_items);
 }
@@ -632,6 +1386,10 @@ gtk_sort_list_model_set_property (GObject      *object,
       gtk_sort_list_model_set_incremental (self, g_value_get_boolean (value));
       break;
 
+    case PROP_INDEXED:
+      self->indexed = g_value_get_boolean (value);
+      break;
+
     case PROP_MODEL:
       gtk_sort_list_model_set_model (self, g_value_get_object (value));
       break;
@@ -640,6 +1398,10 @@ gtk_sort_list_model_set_property (GObject      *object,
       gtk_sort_list_model_set_sorter (self, g_value_get_object (value));
       break;
 
+    case PROP_THREADED:
+      gtk_sort_list_model_set_threaded (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -660,6 +1422,10 @@ gtk_sort_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->incremental);
       break;
 
+    case PROP_INDEXED:
+      g_value_set_boolean (value, self->indexed);
+      break;
+
     case PROP_MODEL:
       g_value_set_object (value, self->model);
       break;
@@ -672,12 +1438,64 @@ gtk_sort_list_model_get_property (GObject     *object,
       g_value_set_object (value, self->sorter);
       break;
 
+    case PROP_THREADED:
+      g_value_set_boolean (value, self->threaded);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
     }
 }
 
+static void
+reverse_positions (gpointer *positions,
+                   guint     start,
+                   guint     end)
+{
+  while (start < end)
+    {
+      gpointer tmp = positions[start];
+      positions[start] = positions[end];
+      positions[end] = tmp;
+      start++;
+      end--;
+    }
+}
+
+/* When a sorter reports that it got inverted, the new order is the
+ * reverse of the current one and reversing the positions is all that
+ * is needed. Items that compare equal stay in the order of the
+ * model though, so runs of those have to be reversed back.
+ *
+ * The sort that follows walks the result in one linear pass, so a
+ * wrong guess here only costs that pass.
+ */
+static gboolean
+gtk_sort_list_model_reverse (GtkSortListModel *self)
+{
+  guint i, j;
+
+  if (self->n_items < 2 ||
+      !gtk_bitset_is_empty (self->missing_keys) ||
+      sort_func (&self->positions[0], &self->positions[self->n_items - 1], self->sort_keys) <= 0)
+    return FALSE;
+
+  reverse_positions (self->positions, 0, self->n_items - 1);
+
+  for (i = 0; i < self->n_items; i = j + 1)
+    {
+      for (j = i; j + 1 < self->n_items; j++)
+        {
+          if (sort_func (&self->positions[j], &self->positions[j + 1], self->sort_keys) < 0)
+            break;
+        }
+      reverse_positions (self->positions, i, j);
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
                                        int               change,
@@ -687,6 +1505,9 @@ gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
 
   if (gtk_sort_list_model_should_sort (self))
     {
+      gboolean was_sorting = gtk_sort_list_model_is_sorting (self);
+      gboolean reversed = FALSE;
+
       gtk_sort_list_model_stop_sorting (self, NULL);
 
       if (self->sort_keys == NULL)
@@ -715,6 +1536,12 @@ gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
             {
               gtk_sort_keys_unref (self->sort_keys);
               self->sort_keys = new_keys;
+
+              /* The keys are still valid, so flipping the sort order
+               * needs neither new keys nor a full sort.
+               */
+              if (change == GTK_SORTER_CHANGE_INVERTED && !was_sorting)
+                reversed = gtk_sort_list_model_reverse (self);
             }
         }
 
@@ -722,12 +1549,20 @@ gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
         pos = n_items = 0;
       else
         gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
+
+      if (reversed)
+        {
+          pos = 0;
+          n_items = self->n_items;
+        }
     }
   else
     {
       gtk_sort_list_model_clear_items (self, &pos, &n_items);
     }
 
+  gtk_sort_list_model_build_tree (self);
+
   if (n_items > 0)
     g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
 }
@@ -786,6 +1621,22 @@ gtk_sort_list_model_class_init (GtkSortListModelClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkSortListModel:indexed:
+   *
+   * If the model should keep its sorted items in a balanced tree
+   *
+   * This makes adding and removing items cost O(log n) instead of O(n)
+   * at the expense of more memory and slower lookups, so it is only
+   * worth it for very large models that change often.
+   */
+  properties[PROP_INDEXED] =
+      g_param_spec_boolean ("indexed",
+                            P_("Indexed"),
+                            P_("Keep sorted items in a tree"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkSortListModel:model:
    *
@@ -822,6 +1673,21 @@ gtk_sort_list_model_class_init (GtkSortListModelClass *class)
                             GTK_TYPE_SORTER,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkSortListModel:threaded:
+   *
+   * If the model may sort items on multiple threads
+   *
+   * Setting this guarantees that the property getters of the items
+   * are thread-safe, see gtk_sort_list_model_set_threaded().
+   */
+  properties[PROP_THREADED] =
+      g_param_spec_boolean ("threaded",
+                            P_("Threaded"),
+                            P_("Sort items on multiple threads"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -896,6 +1762,7 @@ gtk_sort_list_model_set_model (GtkSortListModel *self,
           gtk_sort_list_model_create_items (self);
           if (!gtk_sort_list_model_start_sorting (self, NULL))
             gtk_sort_list_model_finish_sorting (self, &ignore1, &ignore2);
+          gtk_sort_list_model_build_tree (self);
         }
     }
   
@@ -1002,6 +1869,7 @@ gtk_sort_list_model_set_incremental (GtkSortListModel *self,
       guint pos, n_items;
 
       gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
+      gtk_sort_list_model_build_tree (self);
       if (n_items)
         g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
     }
@@ -1026,6 +1894,77 @@ gtk_sort_list_model_get_incremental (GtkSortListModel *self)
   return self->incremental;
 }
 
+/**
+ * gtk_sort_list_model_set_threaded:
+ * @self: a #GtkSortListModel
+ * @threaded: %TRUE to allow sorting on multiple threads
+ *
+ * Allows the model to generate sort keys for large numbers of items
+ * and to sort them on multiple threads at once.
+ *
+ * This is only done for sorters that don't run application callbacks
+ * themselves, which are the sorters provided by GTK that look at
+ * properties of the items. #GtkCustomSorter and sorters using closures
+ * are always run on the main thread.
+ *
+ * The property getters of the items are called from other threads
+ * though, so by enabling this, you guarantee that they are thread-safe
+ * and that the items are not modified while they are sorted.
+ *
+ * Items are only sorted on multiple threads when sorting from scratch
+ * without #GtkSortListModel:incremental, but keys are also generated
+ * on multiple threads when sorting incrementally.
+ *
+ * By default, sorting is done on the main thread only.
+ */
+void
+gtk_sort_list_model_set_threaded (GtkSortListModel *self,
+                                  gboolean          threaded)
+{
+  g_return_if_fail (GTK_IS_SORT_LIST_MODEL (self));
+
+  if (self->threaded == threaded)
+    return;
+
+  self->threaded = threaded;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_THREADED]);
+}
+
+/**
+ * gtk_sort_list_model_get_threaded:
+ * @self: a #GtkSortListModel
+ *
+ * Returns whether sorting on multiple threads was enabled via
+ * gtk_sort_list_model_set_threaded().
+ *
+ * Returns: %TRUE if threaded sorting is enabled
+ */
+gboolean
+gtk_sort_list_model_get_threaded (GtkSortListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_SORT_LIST_MODEL (self), FALSE);
+
+  return self->threaded;
+}
+
+/**
+ * gtk_sort_list_model_get_indexed:
+ * @self: a #GtkSortListModel
+ *
+ * Returns whether @self was created with #GtkSortListModel:indexed
+ * set.
+ *
+ * Returns: %TRUE if the sorted items are kept in a tree
+ */
+gboolean
+gtk_sort_list_model_get_indexed (GtkSortListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_SORT_LIST_MODEL (self), FALSE);
+
+  return self->indexed;
+}
+
 /**
  * gtk_sort_list_model_get_pending:
  * @self: a #GtkSortListModel
@@ -1064,7 +2003,12 @@ gtk_sort_list_model_get_pending (GtkSortListModel *self)
    * in use, and estimating this correctly is hard, so this will have
    * to be good enough.
    */
-  if (!gtk_bitset_is_empty (self->missing_keys))
+  if (self->keys_job)
+    {
+      return (self->n_items + gtk_bitset_get_size (self->missing_keys)
+              - g_atomic_int_get (&self->keys_job->n_done)) / 2;
+    }
+  else if (!gtk_bitset_is_empty (self->missing_keys))
     {
       return (self->n_items + gtk_bitset_get_size (self->missing_keys)) / 2;
     }
@@ -58,6 +58,15 @@ void                    gtk_sort_list_model_set_incremental     (GtkSortListMode
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_sort_list_model_get_incremental     (GtkSortListModel       *self);
 
+GDK_AVAILABLE_IN_ALL
+void                    gtk_sort_list_model_set_threaded        (GtkSortListModel       *self,
+                                                                 gboolean                threaded);
+GDK_AVAILABLE_IN_ALL
+gboolean                gtk_sort_list_model_get_threaded        (GtkSortListModel       *self);
+
+GDK_AVAILABLE_IN_ALL
+gboolean                gtk_sort_list_model_get_indexed         (GtkSortListModel       *self);
+
 GDK_AVAILABLE_IN_ALL
 guint                   gtk_sort_list_model_get_pending         (GtkSortListModel       *self);
 
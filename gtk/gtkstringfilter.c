@@ -21,9 +21,12 @@
 
 #include "gtkstringfilter.h"
 
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
 
+#include <string.h>
+
 /**
  * SECTION:gtkstringfilter
  * @Title: GtkStringFilter
@@ -34,7 +37,11 @@
  * are obtained from the items by evaluating a #GtkExpression.
  *
  * GtkStringFilter has several different modes of comparison - it
- * can match the whole string, just a prefix, or any substring.
+ * can match the whole string, just a prefix, any substring, the
+ * beginnings of words or the characters of the search in order.
+ *
+ * Use gtk_string_filter_get_score() to rank the matching items,
+ * for example with a #GtkCustomSorter.
  */
 
 struct _GtkStringFilter
@@ -43,11 +50,16 @@ struct _GtkStringFilter
 
   char *search;
   char *search_prepared;
+  gsize search_len; /* length of search_prepared */
+  char **search_words; /* search_prepared split into words */
+  guint64 search_chars; /* signature, see GtkStringFilterCache */
+  guint64 search_bigrams;
 
   gboolean ignore_case;
   GtkStringFilterMatchMode match_mode;
 
   GtkExpression *expression;
+  GtkExpressionCache *cache;
 };
 
 enum {
@@ -59,10 +71,52 @@ enum {
   NUM_PROPERTIES
 };
 
+/* Prepared strings are cached on the items, so that refiltering with
+ * a new search term does not need to normalize every string again.
+ *
+ * The cache remembers the string it was prepared from and how, and is
+ * only used if the expression still evaluates to that string with the
+ * same ignore-case setting. Otherwise it is replaced, so every item
+ * holds at most one cache, and changing the item, the expression or
+ * #GtkStringFilter:ignore-case drops the old one on the next match.
+ *
+ * At most %GTK_STRING_FILTER_MAX_CACHES items hold a cache at a time.
+ * Once that many exist, other items are matched without caching until
+ * cached items go away.
+ *
+ * Items may be matched in multiple threads at once, so the cache is
+ * reference counted and only taken from or put on the item with
+ * g_object_dup_qdata() and g_object_replace_qdata().
+ */
+#define GTK_STRING_FILTER_MAX_CACHES 65536
+
+typedef struct _GtkStringFilterCache GtkStringFilterCache;
+
+struct _GtkStringFilterCache
+{
+  gatomicrefcount ref_count;
+
+  char *source;
+  char *prepared; /* may be source if preparing changed nothing,
+                   * NULL if source is not valid UTF-8 */
+  gsize prepared_len;
+  gboolean ignore_case;
+
+  /* A signature of the bytes and pairs of bytes in prepared. If the
+   * search has bits set that aren't set here, the item can't match.
+   * This way most items get rejected without looking at the string.
+   */
+  guint64 chars;
+  guint64 bigrams;
+};
+
 G_DEFINE_TYPE (GtkStringFilter, gtk_string_filter, GTK_TYPE_FILTER)
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
+static GQuark cache_quark;
+static int n_attached_caches; /* atomic */
+
 static char *
 gtk_string_filter_prepare (GtkStringFilter *self,
                            const char      *s)
@@ -73,6 +127,15 @@ gtk_string_filter_prepare (GtkStringFilter *self,
   if (s == NULL || s[0] == '\0')
     return NULL;
 
+  /* normalization doesn't change ASCII and casefolding is tolower() */
+  if (g_str_is_ascii (s))
+    {
+      if (self->ignore_case)
+        return g_ascii_strdown (s, -1);
+      else
+        return g_strdup (s);
+    }
+
   tmp = g_utf8_normalize (s, -1, G_NORMALIZE_ALL);
 
   if (!self->ignore_case)
@@ -84,6 +147,334 @@ gtk_string_filter_prepare (GtkStringFilter *self,
   return result;
 }
 
+/* Words are separated by ASCII whitespace and punctuation */
+static inline gboolean
+is_word_char (char c)
+{
+  return (guchar) c >= 0x80 || g_ascii_isalnum (c);
+}
+
+static inline gboolean
+is_word_start (const char *s,
+               const char *p)
+{
+  return is_word_char (*p) && (p == s || !is_word_char (p[-1]));
+}
+
+#define CHAR_BIT_FOR(c) (G_GUINT64_CONSTANT (1) << ((guchar) (c) & 63))
+#define BIGRAM_BIT_FOR(a, b) (G_GUINT64_CONSTANT (1) << ((((guchar) (a) * 31) ^ (guchar) (b)) & 63))
+
+/* Word prefix and fuzzy matching ignore separators in the search,
+ * so only word characters are added for it.
+ */
+static void
+compute_signature (const char *s,
+                   gsize       len,
+                   gboolean    words_only,
+                   guint64    *chars,
+                   guint64    *bigrams)
+{
+  gsize i;
+
+  *chars = 0;
+  *bigrams = 0;
+
+  for (i = 0; i < len; i++)
+    {
+      if (words_only && !is_word_char (s[i]))
+        continue;
+
+      *chars |= CHAR_BIT_FOR (s[i]);
+      if (i + 1 < len && (!words_only || is_word_char (s[i + 1])))
+        *bigrams |= BIGRAM_BIT_FOR (s[i], s[i + 1]);
+    }
+}
+
+static char **
+split_words (const char *s)
+{
+  GPtrArray *words;
+  const char *start;
+
+  words = g_ptr_array_new ();
+
+  while (*s)
+    {
+      while (*s && !is_word_char (*s))
+        s++;
+      if (*s == '\0')
+        break;
+
+      start = s;
+      while (*s && is_word_char (*s))
+        s++;
+      g_ptr_array_add (words, g_strndup (start, s - start));
+    }
+
+  g_ptr_array_add (words, NULL);
+
+  return (char **) g_ptr_array_free (words, FALSE);
+}
+
+static void
+gtk_string_filter_update_search_prepared (GtkStringFilter *self)
+{
+  g_free (self->search_prepared);
+  g_clear_pointer (&self->search_words, g_strfreev);
+
+  self->search_prepared = gtk_string_filter_prepare (self, self->search);
+  if (self->search_prepared)
+    {
+      self->search_len = strlen (self->search_prepared);
+      self->search_words = split_words (self->search_prepared);
+      compute_signature (self->search_prepared, self->search_len, TRUE,
+                         &self->search_chars, &self->search_bigrams);
+    }
+  else
+    {
+      self->search_len = 0;
+      self->search_chars = 0;
+      self->search_bigrams = 0;
+    }
+}
+
+static gpointer
+gtk_string_filter_cache_ref (gpointer data,
+                             gpointer unused)
+{
+  GtkStringFilterCache *cache = data;
+
+  if (cache)
+    g_atomic_ref_count_inc (&cache->ref_count);
+
+  return cache;
+}
+
+static void
+gtk_string_filter_cache_unref (gpointer data)
+{
+  GtkStringFilterCache *cache = data;
+
+  if (!g_atomic_ref_count_dec (&cache->ref_count))
+    return;
+
+  if (cache->prepared != cache->source)
+    g_free (cache->prepared);
+  g_free (cache->source);
+  g_slice_free (GtkStringFilterCache, cache);
+}
+
+static GtkStringFilterCache *
+gtk_string_filter_cache_new (GtkStringFilter *self,
+                             const char      *s)
+{
+  GtkStringFilterCache *cache;
+
+  cache = g_slice_new (GtkStringFilterCache);
+  g_atomic_ref_count_init (&cache->ref_count);
+  cache->source = g_strdup (s);
+  cache->ignore_case = self->ignore_case;
+  cache->prepared = gtk_string_filter_prepare (self, s);
+
+  /* Invalid UTF-8 never matches */
+  if (cache->prepared == NULL)
+    {
+      cache->prepared_len = 0;
+      cache->chars = 0;
+      cache->bigrams = 0;
+      return cache;
+    }
+
+  cache->prepared_len = strlen (cache->prepared);
+
+  if (strcmp (cache->prepared, cache->source) == 0)
+    {
+      g_free (cache->prepared);
+      cache->prepared = cache->source;
+    }
+
+  compute_signature (cache->prepared, cache->prepared_len, FALSE,
+                     &cache->chars, &cache->bigrams);
+
+  return cache;
+}
+
+/* The destroy notify of caches on items */
+static void
+gtk_string_filter_cache_detach (gpointer data)
+{
+  g_atomic_int_add (&n_attached_caches, -1);
+  gtk_string_filter_cache_unref (data);
+}
+
+/* strstr() with known lengths.
+ *
+ * Candidates are found with memchr(), which the C library implements
+ * with vector instructions, and are checked at both ends before
+ * comparing the whole needle.
+ */
+static const char *
+gtk_string_filter_find (const char *haystack,
+                        gsize       haystack_len,
+                        const char *needle,
+                        gsize       needle_len)
+{
+  const char *s, *end;
+
+  if (needle_len == 0)
+    return haystack;
+  if (needle_len > haystack_len)
+    return NULL;
+
+  /* one past the last possible start of a match */
+  end = haystack + haystack_len - needle_len + 1;
+
+  for (s = haystack; s < end; s++)
+    {
+      s = memchr (s, needle[0], end - s);
+      if (s == NULL)
+        return NULL;
+
+      if (s[needle_len - 1] == needle[needle_len - 1] &&
+          memcmp (s + 1, needle + 1, needle_len - 1) == 0)
+        return s;
+    }
+
+  return NULL;
+}
+
+/* Finds the characters of the search in order, preferring the first
+ * occurrence of every character. Characters that start a word or
+ * follow the previous match score higher, and so do shorter strings.
+ */
+static guint
+gtk_string_filter_score_fuzzy (GtkStringFilter *self,
+                               const char      *s,
+                               gsize            len)
+{
+  const char *needle, *needle_end, *p, *end, *last;
+  guint score;
+
+  needle = self->search_prepared;
+  needle_end = needle + self->search_len;
+  p = s;
+  end = s + len;
+  last = NULL;
+  score = 0;
+
+  while (needle < needle_end)
+    {
+      gsize char_len = g_utf8_next_char (needle) - needle;
+
+      while (p + char_len <= end && memcmp (p, needle, char_len) != 0)
+        p = g_utf8_next_char (p);
+      if (p + char_len > end)
+        return 0;
+
+      score += 1;
+      if (p == last)
+        score += 4;
+      if (is_word_start (s, p))
+        score += 8;
+
+      p += char_len;
+      last = p;
+      needle += char_len;
+    }
+
+  return score * 16 + 15 - MIN (len - self->search_len, 15);
+}
+
+/* Every search word must start a word in @s. Words that match a
+ * whole word or come in the same order as in the search score higher.
+ */
+static guint
+gtk_string_filter_score_word_prefix (GtkStringFilter *self,
+                                     const char      *s,
+                                     gsize            len)
+{
+  const char *p, *end, *previous;
+  guint i, score;
+
+  end = s + len;
+  previous = s;
+  score = 1;
+
+  for (i = 0; self->search_words[i]; i++)
+    {
+      const char *word = self->search_words[i];
+      gsize word_len = strlen (word);
+
+      for (p = s; p + word_len <= end; p++)
+        {
+          if (is_word_start (s, p) && memcmp (p, word, word_len) == 0)
+            break;
+        }
+      if (p + word_len > end)
+        return 0;
+
+      score += 2;
+      if (p + word_len == end || !is_word_char (p[word_len]))
+        score += 2;
+      if (p >= previous)
+        score += 1;
+
+      previous = p + word_len;
+    }
+
+  return score;
+}
+
+/* Returns 0 if the item doesn't match */
+static guint
+gtk_string_filter_score_cache (GtkStringFilter      *self,
+                               GtkStringFilterCache *cache)
+{
+  const char *prepared = cache->prepared;
+  gsize prepared_len = cache->prepared_len;
+  const char *found;
+
+  if (prepared == NULL)
+    return 0;
+  if ((self->search_chars & ~cache->chars) != 0)
+    return 0;
+  if (self->match_mode != GTK_STRING_FILTER_MATCH_MODE_FUZZY &&
+      (self->search_bigrams & ~cache->bigrams) != 0)
+    return 0;
+
+  switch (self->match_mode)
+    {
+    case GTK_STRING_FILTER_MATCH_MODE_EXACT:
+      return prepared_len == self->search_len &&
+             memcmp (prepared, self->search_prepared, prepared_len) == 0;
+
+    case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
+      found = gtk_string_filter_find (prepared, prepared_len, self->search_prepared, self->search_len);
+      if (found == NULL)
+        return 0;
+      else if (found == prepared)
+        return 3;
+      else if (is_word_start (prepared, found))
+        return 2;
+      else
+        return 1;
+
+    case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
+      return prepared_len >= self->search_len &&
+             memcmp (prepared, self->search_prepared, self->search_len) == 0;
+
+    case GTK_STRING_FILTER_MATCH_MODE_FUZZY:
+      return gtk_string_filter_score_fuzzy (self, prepared, prepared_len);
+
+    case GTK_STRING_FILTER_MATCH_MODE_WORD_PREFIX:
+      return gtk_string_filter_score_word_prefix (self, prepared, prepared_len);
+
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+}
+
 /* This is necessary because code just looks at self->search otherwise
  * and that can be the empty string...
  */
@@ -93,50 +484,102 @@ gtk_string_filter_has_search (GtkStringFilter *self)
   return self->search_prepared != NULL;
 }
 
-static gboolean
-gtk_string_filter_match (GtkFilter *filter,
-                         gpointer   item)
+/* Without a search, no strings are looked at */
+static void
+gtk_string_filter_update_thread_safe (GtkStringFilter *self)
 {
-  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+  gtk_filter_set_thread_safe (GTK_FILTER (self),
+                              !gtk_string_filter_has_search (self) ||
+                              gtk_expression_is_thread_safe (self->expression));
+}
+
+static guint
+gtk_string_filter_score_item (GtkStringFilter *self,
+                              gpointer         item)
+{
+  GtkStringFilterCache *cache;
   GValue value = G_VALUE_INIT;
-  char *prepared;
   const char *s;
-  gboolean result;
-
-  if (!gtk_string_filter_has_search (self))
-    return TRUE;
+  guint score;
 
   if (self->expression == NULL ||
-      !gtk_expression_evaluate (self->expression, item, &value))
-    return FALSE;
+      !gtk_expression_cache_evaluate (self->cache, item, &value))
+    return 0;
   s = g_value_get_string (&value);
-  prepared = gtk_string_filter_prepare (self, s);
-  if (prepared == NULL)
-    return FALSE;
+  if (s == NULL || s[0] == '\0')
+    {
+      score = 0;
+    }
+  else if (G_IS_OBJECT (item))
+    {
+      GtkStringFilterCache *old_cache;
 
-  switch (self->match_mode)
+      old_cache = g_object_dup_qdata (item, cache_quark, gtk_string_filter_cache_ref, NULL);
+      if (old_cache &&
+          old_cache->ignore_case == self->ignore_case &&
+          strcmp (old_cache->source, s) == 0)
+        {
+          cache = old_cache;
+        }
+      else
+        {
+          cache = gtk_string_filter_cache_new (self, s);
+
+          if (old_cache == NULL &&
+              g_atomic_int_get (&n_attached_caches) >= GTK_STRING_FILTER_MAX_CACHES)
+            {
+              /* Too many items hold a cache, use this one only once */
+            }
+          else if (g_object_replace_qdata (item, cache_quark,
+                                           old_cache, gtk_string_filter_cache_ref (cache, NULL),
+                                           gtk_string_filter_cache_detach, NULL))
+            {
+              /* We now own the reference the item held on the old cache */
+              if (old_cache)
+                gtk_string_filter_cache_unref (old_cache);
+              else
+                g_atomic_int_inc (&n_attached_caches);
+            }
+          else
+            {
+              /* Another thread replaced the cache in the meantime,
+               * leave theirs in place.
+               */
+              gtk_string_filter_cache_unref (cache);
+            }
+
+          g_clear_pointer (&old_cache, gtk_string_filter_cache_unref);
+        }
+
+      score = gtk_string_filter_score_cache (self, cache);
+      gtk_string_filter_cache_unref (cache);
+    }
+  else
     {
-    case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-      result = strcmp (prepared, self->search_prepared) == 0;
-      break;
-    case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-      result = strstr (prepared, self->search_prepared) != NULL;
-      break;
-    case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
-      result = g_str_has_prefix (prepared, self->search_prepared);
-      break;
-    default:
-      g_assert_not_reached ();
+      cache = gtk_string_filter_cache_new (self, s);
+      score = gtk_string_filter_score_cache (self, cache);
+      gtk_string_filter_cache_unref (cache);
     }
 
 #if 0
-  g_print ("%s (%s) %s %s (%s)\n", s, prepared, result ? "==" : "!=", self->search, self->search_prepared);
+  g_print ("%s %s %s (%s)\n", s, score ? "==" : "!=", self->search, self->search_prepared);
 #endif
 
-  g_free (prepared);
   g_value_unset (&value);
 
-  return result;
+  return score;
+}
+
+static gboolean
+gtk_string_filter_match (GtkFilter *filter,
+                         gpointer   item)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+
+  if (!gtk_string_filter_has_search (self))
+    return TRUE;
+
+  return gtk_string_filter_score_item (self, item) > 0;
 }
 
 static GtkFilterMatch
@@ -224,6 +667,8 @@ gtk_string_filter_dispose (GObject *object)
 
   g_clear_pointer (&self->search, g_free);
   g_clear_pointer (&self->search_prepared, g_free);
+  g_clear_pointer (&self->search_words, g_strfreev);
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
 
   G_OBJECT_CLASS (gtk_string_filter_parent_class)->dispose (object);
@@ -292,6 +737,7 @@ gtk_string_filter_class_init (GtkStringFilterClass *class)
 
   g_object_class_install_properties (object_class, NUM_PROPERTIES, properties);
 
+  cache_quark = g_quark_from_static_string ("gtk-string-filter-cache");
 }
 
 static void
@@ -299,6 +745,7 @@ gtk_string_filter_init (GtkStringFilter *self)
 {
   self->ignore_case = TRUE;
   self->match_mode = GTK_STRING_FILTER_MATCH_MODE_SUBSTRING;
+  gtk_string_filter_update_thread_safe (self);
 }
 
 /**
@@ -343,6 +790,77 @@ gtk_string_filter_get_search (GtkStringFilter *self)
   return self->search;
 }
 
+/* Checks if the characters of @needle appear in @haystack in order */
+static gboolean
+is_subsequence (const char *needle,
+                const char *haystack)
+{
+  while (*needle)
+    {
+      gsize char_len = g_utf8_next_char (needle) - needle;
+
+      while (*haystack && strncmp (haystack, needle, char_len) != 0)
+        haystack = g_utf8_next_char (haystack);
+      if (*haystack == '\0')
+        return FALSE;
+
+      haystack += char_len;
+      needle += char_len;
+    }
+
+  return TRUE;
+}
+
+/* Compares the prepared strings, they are what gets matched.
+ * If a search term contains the previous one, it can only match
+ * fewer items, so the filter list model only needs to look at
+ * the current matches.
+ */
+static GtkFilterChange
+gtk_string_filter_get_search_change (GtkStringFilter *self,
+                                     const char      *old_prepared)
+{
+  if (self->search_prepared == NULL)
+    return GTK_FILTER_CHANGE_LESS_STRICT;
+  else if (old_prepared == NULL)
+    return GTK_FILTER_CHANGE_MORE_STRICT;
+
+  switch (self->match_mode)
+    {
+    case GTK_STRING_FILTER_MATCH_MODE_EXACT:
+      return GTK_FILTER_CHANGE_DIFFERENT;
+
+    case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
+      if (strstr (self->search_prepared, old_prepared))
+        return GTK_FILTER_CHANGE_MORE_STRICT;
+      else if (strstr (old_prepared, self->search_prepared))
+        return GTK_FILTER_CHANGE_LESS_STRICT;
+      else
+        return GTK_FILTER_CHANGE_DIFFERENT;
+
+    case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
+    case GTK_STRING_FILTER_MATCH_MODE_WORD_PREFIX:
+      if (g_str_has_prefix (self->search_prepared, old_prepared))
+        return GTK_FILTER_CHANGE_MORE_STRICT;
+      else if (g_str_has_prefix (old_prepared, self->search_prepared))
+        return GTK_FILTER_CHANGE_LESS_STRICT;
+      else
+        return GTK_FILTER_CHANGE_DIFFERENT;
+
+    case GTK_STRING_FILTER_MATCH_MODE_FUZZY:
+      if (is_subsequence (old_prepared, self->search_prepared))
+        return GTK_FILTER_CHANGE_MORE_STRICT;
+      else if (is_subsequence (self->search_prepared, old_prepared))
+        return GTK_FILTER_CHANGE_LESS_STRICT;
+      else
+        return GTK_FILTER_CHANGE_DIFFERENT;
+
+    default:
+      g_assert_not_reached ();
+      return GTK_FILTER_CHANGE_DIFFERENT;
+    }
+}
+
 /**
  * gtk_string_filter_set_search:
  * @self: a #GtkStringFilter
@@ -355,31 +873,24 @@ void
 gtk_string_filter_set_search (GtkStringFilter *self,
                               const char      *search)
 {
-  GtkFilterChange change;
+  char *old_prepared;
 
   g_return_if_fail (GTK_IS_STRING_FILTER (self));
 
   if (g_strcmp0 (self->search, search) == 0)
     return;
 
-  if (search == NULL || search[0] == 0)
-    change = GTK_FILTER_CHANGE_LESS_STRICT;
-  else if (!gtk_string_filter_has_search (self))
-    change = GTK_FILTER_CHANGE_MORE_STRICT;
-  else if (g_str_has_prefix (search, self->search))
-    change = GTK_FILTER_CHANGE_MORE_STRICT;
-  else if (g_str_has_prefix (self->search, search))
-    change = GTK_FILTER_CHANGE_LESS_STRICT;
-  else
-    change = GTK_FILTER_CHANGE_DIFFERENT;
-
   g_free (self->search);
-  g_free (self->search_prepared);
-
   self->search = g_strdup (search);
-  self->search_prepared = gtk_string_filter_prepare (self, search);
+  old_prepared = g_steal_pointer (&self->search_prepared);
+  gtk_string_filter_update_search_prepared (self);
+  gtk_string_filter_update_thread_safe (self);
 
-  gtk_filter_changed (GTK_FILTER (self), change);
+  /* Different search terms can still match the same items */
+  if (g_strcmp0 (old_prepared, self->search_prepared) != 0)
+    gtk_filter_changed (GTK_FILTER (self), gtk_string_filter_get_search_change (self, old_prepared));
+
+  g_free (old_prepared);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SEARCH]);
 }
@@ -420,8 +931,14 @@ gtk_string_filter_set_expression (GtkStringFilter *self,
   if (self->expression == expression)
     return;
 
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
-  self->expression = gtk_expression_ref (expression);
+  if (expression)
+    {
+      self->expression = gtk_expression_ref (expression);
+      self->cache = gtk_expression_cache_new (expression);
+    }
+  gtk_string_filter_update_thread_safe (self);
 
   if (gtk_string_filter_has_search (self))
     gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
@@ -465,8 +982,7 @@ gtk_string_filter_set_ignore_case (GtkStringFilter *self,
 
   if (self->search)
     {
-      g_free (self->search_prepared);
-      self->search_prepared = gtk_string_filter_prepare (self, self->search);
+      gtk_string_filter_update_search_prepared (self);
       gtk_filter_changed (GTK_FILTER (self), ignore_case ? GTK_FILTER_CHANGE_LESS_STRICT : GTK_FILTER_CHANGE_MORE_STRICT);
     }
 
@@ -489,6 +1005,37 @@ gtk_string_filter_get_match_mode (GtkStringFilter *self)
   return self->match_mode;
 }
 
+/* Checks if every text matching in mode @a also matches in mode @b */
+static gboolean
+match_mode_is_subset (GtkStringFilterMatchMode a,
+                      GtkStringFilterMatchMode b)
+{
+  if (a == b)
+    return TRUE;
+
+  switch (a)
+    {
+    case GTK_STRING_FILTER_MATCH_MODE_EXACT:
+      return TRUE;
+
+    case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
+      return b == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING ||
+             b == GTK_STRING_FILTER_MATCH_MODE_FUZZY ||
+             b == GTK_STRING_FILTER_MATCH_MODE_WORD_PREFIX;
+
+    case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
+      return b == GTK_STRING_FILTER_MATCH_MODE_FUZZY;
+
+    case GTK_STRING_FILTER_MATCH_MODE_FUZZY:
+    case GTK_STRING_FILTER_MATCH_MODE_WORD_PREFIX:
+      return FALSE;
+
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
 /**
  * gtk_string_filter_set_match_mode:
  * @self: a #GtkStringFilter
@@ -512,30 +1059,46 @@ gtk_string_filter_set_match_mode (GtkStringFilter *self,
 
   if (self->search_prepared && self->expression)
     {
-      switch (old_mode)
-        {
-        case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-          gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT);
-          break;
-
-        case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-          gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT);
-          break;
-
-        case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
-          if (mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING)
-            gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT);
-          else
-            gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT);
-          break;
-
-        default:
-          g_assert_not_reached ();
-          break;
-        }
+      if (match_mode_is_subset (mode, old_mode))
+        gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT);
+      else if (match_mode_is_subset (old_mode, mode))
+        gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT);
+      else
+        gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
     }
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MATCH_MODE]);
 }
 
                                                                  
+
+/**
+ * gtk_string_filter_get_score:
+ * @self: a #GtkStringFilter
+ * @item: (type GObject): the item to score
+ *
+ * Computes how well @item matches the current search.
+ *
+ * The score is only meaningful compared to the scores of other items
+ * for the same search and match mode. Items that match at the start
+ * of words score higher, and in #GTK_STRING_FILTER_MATCH_MODE_FUZZY
+ * mode, so do items where more characters match consecutively.
+ *
+ * To show the best matches first, sort the filtered model with a
+ * #GtkCustomSorter that compares scores and call gtk_sorter_changed()
+ * whenever @self emits #GtkFilter::changed.
+ *
+ * Returns: 0 if @item does not match, a positive score otherwise
+ **/
+guint
+gtk_string_filter_get_score (GtkStringFilter *self,
+                             gpointer         item)
+{
+  g_return_val_if_fail (GTK_IS_STRING_FILTER (self), 0);
+  g_return_val_if_fail (item != NULL, 0);
+
+  if (!gtk_string_filter_has_search (self))
+    return 1;
+
+  return gtk_string_filter_score_item (self, item);
+}
@@ -37,13 +37,20 @@ G_BEGIN_DECLS
  *     must be contained as a substring inside the text.
  * @GTK_STRING_FILTER_MATCH_MODE_PREFIX: The text must begin
  *     with the search string.
+ * @GTK_STRING_FILTER_MATCH_MODE_FUZZY: The characters of the search
+ *     string must appear in the text in the same order, but not
+ *     necessarily next to each other.
+ * @GTK_STRING_FILTER_MATCH_MODE_WORD_PREFIX: Every word of the search
+ *     string must be the beginning of a word in the text.
  *
  * Specifies how search strings are matched inside text.
  */
 typedef enum {
   GTK_STRING_FILTER_MATCH_MODE_EXACT,
   GTK_STRING_FILTER_MATCH_MODE_SUBSTRING,
-  GTK_STRING_FILTER_MATCH_MODE_PREFIX
+  GTK_STRING_FILTER_MATCH_MODE_PREFIX,
+  GTK_STRING_FILTER_MATCH_MODE_FUZZY,
+  GTK_STRING_FILTER_MATCH_MODE_WORD_PREFIX
 } GtkStringFilterMatchMode;
 
 #define GTK_TYPE_STRING_FILTER             (gtk_string_filter_get_type ())
@@ -74,6 +81,9 @@ GDK_AVAILABLE_IN_ALL
 void                     gtk_string_filter_set_match_mode       (GtkStringFilter        *self,
                                                                  GtkStringFilterMatchMode mode);
 
+GDK_AVAILABLE_IN_ALL
+guint                   gtk_string_filter_get_score             (GtkStringFilter        *self,
+                                                                 gpointer                item);
 
 
 G_END_DECLS
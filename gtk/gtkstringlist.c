@@ -39,6 +39,13 @@
  * GtkStringList is well-suited for any place where you would
  * typically use a `char*[]`, but need a list model.
  *
+ * GtkStringList only stores the strings. The #GtkStringObject for a
+ * position is created when it is first requested and is kept only as
+ * long as somebody else holds a reference to it, so even lists with
+ * millions of strings only create objects for the rows that are
+ * actually looked at. While an object is alive, looking up its row
+ * again returns the same object.
+ *
  * # GtkStringList as GtkBuildable
  *
  * The GtkStringList implementation of the GtkBuildable interface
@@ -60,16 +67,18 @@
 
  */
 
-#define GDK_ARRAY_ELEMENT_TYPE GtkStringObject *
-#define GDK_ARRAY_NAME objects
-#define GDK_ARRAY_TYPE_NAME Objects
-#define GDK_ARRAY_FREE_FUNC g_object_unref
+#define GDK_ARRAY_ELEMENT_TYPE char *
+#define GDK_ARRAY_NAME strings
+#define GDK_ARRAY_TYPE_NAME Strings
+#define GDK_ARRAY_FREE_FUNC g_free
 #include "gdk/gdkarrayimpl.c"
 
 struct _GtkStringObject
 {
   GObject parent_instance;
   char *string;
+  /* FALSE while the string is owned by the list that created us */
+  gboolean owns_string;
 };
 
 enum {
@@ -89,7 +98,8 @@ gtk_string_object_finalize (GObject *object)
 {
   GtkStringObject *self = GTK_STRING_OBJECT (object);
 
-  g_free (self->string);
+  if (self->owns_string)
+    g_free (self->string);
 
   G_OBJECT_CLASS (gtk_string_object_parent_class)->finalize (object);
 }
@@ -139,6 +149,7 @@ gtk_string_object_new_take (char *string)
 
   obj = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
   obj->string = string;
+  obj->owns_string = TRUE;
 
   return obj;
 }
@@ -177,7 +188,9 @@ struct _GtkStringList
 {
   GObject parent_instance;
 
-  Objects items;
+  Strings items;
+  /* string in items => GtkStringObject sharing it, not reffed */
+  GHashTable *objects;
 };
 
 struct _GtkStringListClass
@@ -196,7 +209,37 @@ gtk_string_list_get_n_items (GListModel *list)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
 
-  return objects_get_size (&self->items);
+  return strings_get_size (&self->items);
+}
+
+static void
+gtk_string_list_object_disposed (gpointer  data,
+                                 GObject  *where_the_object_was)
+{
+  GtkStringList *self = data;
+  GtkStringObject *object = (GtkStringObject *) where_the_object_was;
+
+  g_hash_table_remove (self->objects, object->string);
+}
+
+/* Hands the string over to its object, if one exists, so that
+ * the object keeps working after the string left the list.
+ * In that case, *string is set to %NULL.
+ */
+static void
+gtk_string_list_release_string (GtkStringList  *self,
+                                char          **string)
+{
+  GtkStringObject *object;
+
+  object = g_hash_table_lookup (self->objects, *string);
+  if (object == NULL)
+    return;
+
+  g_hash_table_remove (self->objects, *string);
+  g_object_weak_unref (G_OBJECT (object), gtk_string_list_object_disposed, self);
+  object->owns_string = TRUE;
+  *string = NULL;
 }
 
 static gpointer
@@ -204,11 +247,24 @@ gtk_string_list_get_item (GListModel *list,
                           guint       position)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
+  GtkStringObject *object;
+  char *string;
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= strings_get_size (&self->items))
     return NULL;
 
-  return g_object_ref (objects_get (&self->items, position));
+  string = strings_get (&self->items, position);
+
+  object = g_hash_table_lookup (self->objects, string);
+  if (object)
+    return g_object_ref (object);
+
+  object = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
+  object->string = string;
+  g_hash_table_insert (self->objects, string, object);
+  g_object_weak_ref (G_OBJECT (object), gtk_string_list_object_disposed, self);
+
+  return object;
 }
 
 static void
@@ -394,24 +450,40 @@ static void
 gtk_string_list_dispose (GObject *object)
 {
   GtkStringList *self = GTK_STRING_LIST (object);
+  gsize i;
 
-  objects_clear (&self->items);
+  for (i = 0; i < strings_get_size (&self->items) && g_hash_table_size (self->objects) > 0; i++)
+    gtk_string_list_release_string (self, strings_index (&self->items, i));
+
+  strings_clear (&self->items);
 
   G_OBJECT_CLASS (gtk_string_list_parent_class)->dispose (object);
 }
 
+static void
+gtk_string_list_finalize (GObject *object)
+{
+  GtkStringList *self = GTK_STRING_LIST (object);
+
+  g_hash_table_unref (self->objects);
+
+  G_OBJECT_CLASS (gtk_string_list_parent_class)->finalize (object);
+}
+
 static void
 gtk_string_list_class_init (GtkStringListClass *class)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
 
   gobject_class->dispose = gtk_string_list_dispose;
+  gobject_class->finalize = gtk_string_list_finalize;
 }
 
 static void
 gtk_string_list_init (GtkStringList *self)
 {
-  objects_init (&self->items);
+  strings_init (&self->items);
+  self->objects = g_hash_table_new (NULL, NULL);
 }
 
 /**
@@ -434,6 +506,37 @@ gtk_string_list_new (const char * const *strings)
   return self;
 }
 
+/**
+ * gtk_string_list_new_take:
+ * @strings: (array zero-terminated=1) (transfer full) (nullable): The strings
+ *     to put in the model
+ *
+ * Creates a new #GtkStringList with the given @strings, taking
+ * ownership of the array and the strings in it.
+ *
+ * This avoids copying every string, which makes it the fastest way
+ * to create a large list, for example from the result of g_strsplit().
+ *
+ * Returns: a new #GtkStringList
+ */
+GtkStringList *
+gtk_string_list_new_take (char **strings)
+{
+  GtkStringList *self;
+  guint n_strings;
+
+  self = g_object_new (GTK_TYPE_STRING_LIST, NULL);
+
+  if (strings == NULL)
+    return self;
+
+  n_strings = g_strv_length (strings);
+  strings_splice (&self->items, 0, 0, FALSE, strings, n_strings);
+  g_free (strings);
+
+  return self;
+}
+
 /**
  * gtk_string_list_splice:
  * @self: a #GtkStringList
@@ -464,18 +567,21 @@ gtk_string_list_splice (GtkStringList      *self,
 
   g_return_if_fail (GTK_IS_STRING_LIST (self));
   g_return_if_fail (position + n_removals >= position); /* overflow */
-  g_return_if_fail (position + n_removals <= objects_get_size (&self->items));
+  g_return_if_fail (position + n_removals <= strings_get_size (&self->items));
 
   if (additions)
     n_additions = g_strv_length ((char **) additions);
   else
     n_additions = 0;
 
-  objects_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+  for (i = 0; i < n_removals && g_hash_table_size (self->objects) > 0; i++)
+    gtk_string_list_release_string (self, strings_index (&self->items, position + i));
+
+  strings_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
 
   for (i = 0; i < n_additions; i++)
     {
-      *objects_index (&self->items, position + i) = gtk_string_object_new (additions[i]);
+      *strings_index (&self->items, position + i) = g_strdup (additions[i]);
     }
 
   if (n_removals || n_additions)
@@ -498,9 +604,9 @@ gtk_string_list_append (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new (string));
+  strings_append (&self->items, g_strdup (string));
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), strings_get_size (&self->items) - 1, 0, 1);
 }
 
 /**
@@ -524,9 +630,9 @@ gtk_string_list_take (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new_take (string));
+  strings_append (&self->items, string);
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), strings_get_size (&self->items) - 1, 0, 1);
 }
 
 /**
@@ -565,8 +671,8 @@ gtk_string_list_get_string (GtkStringList *self,
 {
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), NULL);
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= strings_get_size (&self->items))
     return NULL;
 
-  return objects_get (&self->items, position)->string;
+  return strings_get (&self->items, position);
 }
@@ -48,6 +48,8 @@ G_DECLARE_FINAL_TYPE (GtkStringList, gtk_string_list, GTK, STRING_LIST, GObject)
 
 GDK_AVAILABLE_IN_ALL
 GtkStringList * gtk_string_list_new             (const char * const    *strings);
+GDK_AVAILABLE_IN_ALL
+GtkStringList * gtk_string_list_new_take        (char                 **strings);
 
 GDK_AVAILABLE_IN_ALL
 void            gtk_string_list_append          (GtkStringList         *self,
@@ -46,6 +46,7 @@ struct _GtkStringSorter
   gboolean ignore_case;
 
   GtkExpression *expression;
+  GtkExpressionCache *cache;
 };
 
 enum {
@@ -60,9 +61,10 @@ G_DEFINE_TYPE (GtkStringSorter, gtk_string_sorter, GTK_TYPE_SORTER)
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
 static char *
-gtk_string_sorter_get_key (GtkExpression *expression,
-                           gboolean       ignore_case,
-                           gpointer       item1)
+gtk_string_sorter_get_key (GtkExpression      *expression,
+                           GtkExpressionCache *cache,
+                           gboolean            ignore_case,
+                           gpointer            item1)
 {
   GValue value = G_VALUE_INIT;
   char *s;
@@ -70,8 +72,16 @@ gtk_string_sorter_get_key (GtkExpression *expression,
   if (expression == NULL)
     return NULL;
 
-  if (!gtk_expression_evaluate (expression, item1, &value))
-    return NULL;
+  if (cache)
+    {
+      if (!gtk_expression_cache_evaluate (cache, item1, &value))
+        return NULL;
+    }
+  else
+    {
+      if (!gtk_expression_evaluate (expression, item1, &value))
+        return NULL;
+    }
 
   /* If strings are NULL, order them before "". */
   if (ignore_case)
@@ -104,8 +114,8 @@ gtk_string_sorter_compare (GtkSorter *sorter,
   if (self->expression == NULL)
     return GTK_ORDERING_EQUAL;
 
-  s1 = gtk_string_sorter_get_key (self->expression, self->ignore_case, item1);
-  s2 = gtk_string_sorter_get_key (self->expression, self->ignore_case, item2);
+  s1 = gtk_string_sorter_get_key (self->expression, self->cache, self->ignore_case, item1);
+  s2 = gtk_string_sorter_get_key (self->expression, self->cache, self->ignore_case, item2);
 
   result = gtk_ordering_from_cmpfunc (g_strcmp0 (s1, s2));
 
@@ -175,7 +185,7 @@ gtk_string_sort_keys_init_key (GtkSortKeys *keys,
   GtkStringSortKeys *self = (GtkStringSortKeys *) keys;
   char **key = (char **) key_memory;
 
-  *key = gtk_string_sorter_get_key (self->expression, self->ignore_case, item);
+  *key = gtk_string_sorter_get_key (self->expression, NULL, self->ignore_case, item);
 }
 
 static void
@@ -211,6 +221,7 @@ gtk_string_sort_keys_new (GtkStringSorter *self)
 
   result->expression = gtk_expression_ref (self->expression);
   result->ignore_case = self->ignore_case;
+  result->keys.thread_safe = gtk_expression_is_thread_safe (self->expression);
 
   return (GtkSortKeys *) result;
 }
@@ -268,6 +279,7 @@ gtk_string_sorter_dispose (GObject *object)
 {
   GtkStringSorter *self = GTK_STRING_SORTER (object);
 
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
 
   G_OBJECT_CLASS (gtk_string_sorter_parent_class)->dispose (object);
@@ -384,9 +396,13 @@ gtk_string_sorter_set_expression (GtkStringSorter *self,
   if (self->expression == expression)
     return;
 
+  g_clear_pointer (&self->cache, gtk_expression_cache_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
   if (expression)
-    self->expression = gtk_expression_ref (expression);
+    {
+      self->expression = gtk_expression_ref (expression);
+      self->cache = gtk_expression_cache_new (expression);
+    }
 
   gtk_sorter_changed_with_keys (GTK_SORTER (self),
                                 GTK_SORTER_CHANGE_DIFFERENT,
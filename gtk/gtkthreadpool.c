@@ -0,0 +1,99 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkthreadpoolprivate.h"
+
+/* One thread pool shared by everything in GTK that splits work across
+ * threads, like sorting and filtering list models, so that running
+ * several of them doesn't start more threads than there are processors.
+ *
+ * The thread that pushes work is expected to work on it, too, and to
+ * only wait for the parts other threads already started. That way
+ * work never waits for a free thread in the pool and tasks can't
+ * deadlock each other.
+ */
+
+typedef struct _GtkThreadPoolTask GtkThreadPoolTask;
+
+struct _GtkThreadPoolTask
+{
+  GtkThreadPoolFunc func;
+  gpointer data;
+};
+
+static void
+gtk_thread_pool_run_task (gpointer data,
+                          gpointer unused)
+{
+  GtkThreadPoolTask *task = data;
+
+  task->func (task->data);
+
+  g_slice_free (GtkThreadPoolTask, task);
+}
+
+static GThreadPool *
+gtk_thread_pool_get (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool = g_thread_pool_new (gtk_thread_pool_run_task,
+                                                 NULL,
+                                                 gtk_thread_pool_get_max_threads (),
+                                                 FALSE,
+                                                 NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/*<private>
+ * gtk_thread_pool_get_max_threads:
+ *
+ * Returns the number of threads in the pool. Together with the thread
+ * pushing the work, that is one thread per processor.
+ *
+ * Returns: the maximum number of threads running pushed functions
+ **/
+guint
+gtk_thread_pool_get_max_threads (void)
+{
+  return MAX (g_get_num_processors (), 2) - 1;
+}
+
+/*<private>
+ * gtk_thread_pool_push:
+ * @func: the function to run
+ * @data: data to pass to @func
+ *
+ * Runs @func in one of the threads of the pool once a thread is free.
+ **/
+void
+gtk_thread_pool_push (GtkThreadPoolFunc func,
+                      gpointer          data)
+{
+  GtkThreadPoolTask *task;
+
+  task = g_slice_new (GtkThreadPoolTask);
+  task->func = func;
+  task->data = data;
+
+  g_thread_pool_push (gtk_thread_pool_get (), task, NULL);
+}
@@ -0,0 +1,31 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_THREAD_POOL_PRIVATE_H__
+#define __GTK_THREAD_POOL_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef void (* GtkThreadPoolFunc) (gpointer data);
+
+guint                   gtk_thread_pool_get_max_threads         (void);
+void                    gtk_thread_pool_push                    (GtkThreadPoolFunc       func,
+                                                                 gpointer                data);
+
+G_END_DECLS
+
+#endif /* __GTK_THREAD_POOL_PRIVATE_H__ */
@@ -28,7 +28,7 @@
 #include "gtkenums.h"
 #include "gtkgestureclick.h"
 #include "gtkintl.h"
-#include "gtktreelistmodel.h"
+#include "gtktreelistmodelprivate.h"
 
 /**
  * SECTION:gtktreeexpander
@@ -800,6 +800,7 @@ gtk_tree_expander_set_list_row (GtkTreeExpander *self,
                                                "notify",
                                                G_CALLBACK (gtk_tree_expander_list_row_notify_cb),
                                                self);
+      gtk_tree_list_row_shown (list_row);
     }
 
   gtk_tree_expander_update_for_list_row (self);
@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtktreelistmodel.h"
+#include "gtktreelistmodelprivate.h"
 
 #include "gtkrbtreeprivate.h"
 #include "gtkintl.h"
@@ -33,11 +33,21 @@
  *
  * #GtkTreeListModel is a #GListModel implementation that can expand rows
  * by creating new child list models on demand.
+ *
+ * If creating the child models is slow, for example because they need to
+ * query a database, use gtk_tree_list_model_new_async(). Expanded rows then
+ * show a placeholder row until gtk_tree_list_row_set_children() is called.
+ *
+ * With #GtkTreeListModel:autoexpand set, the #GtkTreeListModel:autoexpand-depth
+ * property can be used to only expand the first levels right away. Deeper
+ * rows are expanded once a #GtkTreeExpander shows them, usually because
+ * they have been scrolled into view.
  */
 
 enum {
   PROP_0,
   PROP_AUTOEXPAND,
+  PROP_AUTOEXPAND_DEPTH,
   PROP_MODEL,
   PROP_PASSTHROUGH,
   NUM_PROPERTIES
@@ -56,8 +66,13 @@ struct _TreeNode
     GtkTreeListModel *list;
   };
 
+  guint request; /* token of the pending request while loading */
+
   guint empty : 1;
   guint is_root : 1;
+  guint placeholder : 1; /* shown while the parent's children are loading */
+  guint loading : 1; /* waiting for gtk_tree_list_row_set_children() */
+  guint autoexpand_pending : 1; /* expand when shown */
 };
 
 struct _TreeAugment
@@ -73,9 +88,17 @@ struct _GtkTreeListModel
   TreeNode root_node;
 
   GtkTreeListModelCreateModelFunc create_func;
+  GtkTreeListModelCreateModelAsyncFunc create_async_func;
   gpointer user_data;
   GDestroyNotify user_destroy;
 
+  TreeNode *requesting; /* node whose children are being requested */
+  guint last_request;
+
+  guint autoexpand_depth;
+  GPtrArray *autoexpand_rows; /* rows to expand in the idle */
+  guint autoexpand_idle;
+
   guint autoexpand : 1;
   guint passthrough : 1;
 };
@@ -255,6 +278,20 @@ tree_node_get_position (TreeNode *node)
   return n;
 }
 
+static guint
+tree_node_get_depth (TreeNode *node)
+{
+  guint depth;
+
+  depth = 0;
+  for (node = node->parent;
+       !node->is_root;
+       node = node->parent)
+    depth++;
+
+  return depth;
+}
+
 static void
 tree_node_mark_dirty (TreeNode *node)
 {
@@ -338,6 +375,9 @@ tree_node_get_item (TreeNode *node)
 {
   TreeNode *parent;
 
+  if (node->placeholder)
+    return NULL;
+
   parent = node->parent;
   return g_list_model_get_item (parent->model,
                                 tree_node_get_local_position (parent->children, node));
@@ -363,6 +403,61 @@ static guint
 gtk_tree_list_model_expand_node (GtkTreeListModel *self,
                                  TreeNode         *node);
 
+static gboolean
+gtk_tree_list_model_autoexpand_cb (gpointer data)
+{
+  GtkTreeListModel *self = data;
+  GPtrArray *rows;
+  guint i;
+
+  self->autoexpand_idle = 0;
+  rows = g_steal_pointer (&self->autoexpand_rows);
+
+  for (i = 0; i < rows->len; i++)
+    gtk_tree_list_row_set_expanded (g_ptr_array_index (rows, i), TRUE);
+
+  g_ptr_array_unref (rows);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Called when a row that was not expanded because it was too deep
+ * gets shown. Rows are shown while the model is being queried, and
+ * we can't change it then, so we expand it from an idle. */
+static void
+gtk_tree_list_model_queue_autoexpand (GtkTreeListModel *self,
+                                      TreeNode         *node)
+{
+  node->autoexpand_pending = FALSE;
+
+  if (!self->autoexpand)
+    return;
+
+  if (self->autoexpand_rows == NULL)
+    self->autoexpand_rows = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (self->autoexpand_rows, tree_node_get_row (node));
+
+  if (self->autoexpand_idle == 0)
+    {
+      self->autoexpand_idle = g_idle_add (gtk_tree_list_model_autoexpand_cb, self);
+      g_source_set_name_by_id (self->autoexpand_idle, "[gtk] gtk_tree_list_model_autoexpand_cb");
+    }
+}
+
+static guint
+gtk_tree_list_model_autoexpand_node (GtkTreeListModel *self,
+                                     TreeNode         *node)
+{
+  if (self->autoexpand_depth > 0 &&
+      tree_node_get_depth (node) >= self->autoexpand_depth)
+    {
+      node->autoexpand_pending = TRUE;
+      return 0;
+    }
+
+  return gtk_tree_list_model_expand_node (self, node);
+}
+
 static void
 gtk_tree_list_model_items_changed_cb (GListModel *model,
                                       guint       position,
@@ -425,7 +520,7 @@ gtk_tree_list_model_items_changed_cb (GListModel *model,
     {
       for (i = 0; i < added; i++)
         {
-          tree_added += gtk_tree_list_model_expand_node (self, child);
+          tree_added += gtk_tree_list_model_autoexpand_node (self, child);
           child = gtk_rb_tree_node_get_next (child);
         }
     }
@@ -512,22 +607,72 @@ gtk_tree_list_model_init_node (GtkTreeListModel *list,
       node = gtk_rb_tree_insert_after (self->children, node);
       node->parent = self;
       if (list->autoexpand)
-        gtk_tree_list_model_expand_node (list, node);
+        gtk_tree_list_model_autoexpand_node (list, node);
     }
 }
 
+static guint
+gtk_tree_list_model_request_model (GtkTreeListModel *self,
+                                   TreeNode         *node)
+{
+  GtkTreeListRow *row;
+  TreeNode *requesting;
+  gpointer item;
+
+  /* A new token for every expansion, so that answers to requests from
+   * before the row was collapsed can be told apart. 0 is never used.
+   */
+  if (++self->last_request == 0)
+    self->last_request++;
+  node->request = self->last_request;
+  node->loading = TRUE;
+  node->children = gtk_rb_tree_new (TreeNode,
+                                    TreeAugment,
+                                    gtk_tree_list_model_augment,
+                                    gtk_tree_list_model_clear_node,
+                                    NULL);
+  /* In passthrough mode, there's no item we could show */
+  if (!self->passthrough)
+    {
+      TreeNode *placeholder = gtk_rb_tree_insert_after (node->children, NULL);
+      placeholder->parent = node;
+      placeholder->placeholder = TRUE;
+      placeholder->empty = TRUE;
+    }
+  tree_node_mark_dirty (node);
+
+  row = tree_node_get_row (node);
+  item = tree_node_get_item (node);
+
+  /* the children might be set right away */
+  requesting = self->requesting;
+  self->requesting = node;
+  self->create_async_func (row, item, node->request, self->user_data);
+  self->requesting = requesting;
+
+  g_object_unref (item);
+  g_object_unref (row);
+
+  return tree_node_get_n_children (node);
+}
+
 static guint
 gtk_tree_list_model_expand_node (GtkTreeListModel *self,
                                  TreeNode         *node)
 {
   GListModel *model;
 
+  node->autoexpand_pending = FALSE;
+
   if (node->empty)
     return 0;
   
-  if (node->model != NULL)
+  if (node->children != NULL)
     return 0;
 
+  if (self->create_async_func)
+    return gtk_tree_list_model_request_model (self, node);
+
   model = tree_node_create_model (self, node);
 
   if (model == NULL)
@@ -546,11 +691,13 @@ gtk_tree_list_model_collapse_node (GtkTreeListModel *self,
 {      
   guint n_items;
 
-  if (node->model == NULL)
+  if (node->children == NULL)
     return 0;
 
   n_items = tree_node_get_n_children (node);
 
+  node->loading = FALSE;
+  node->request = 0;
   g_clear_pointer (&node->children, gtk_rb_tree_unref);
   g_clear_object (&node->model);
 
@@ -625,6 +772,10 @@ gtk_tree_list_model_set_property (GObject      *object,
       gtk_tree_list_model_set_autoexpand (self, g_value_get_boolean (value));
       break;
 
+    case PROP_AUTOEXPAND_DEPTH:
+      gtk_tree_list_model_set_autoexpand_depth (self, g_value_get_uint (value));
+      break;
+
     case PROP_PASSTHROUGH:
       self->passthrough = g_value_get_boolean (value);
       break;
@@ -649,6 +800,10 @@ gtk_tree_list_model_get_property (GObject     *object,
       g_value_set_boolean (value, self->autoexpand);
       break;
 
+    case PROP_AUTOEXPAND_DEPTH:
+      g_value_set_uint (value, self->autoexpand_depth);
+      break;
+
     case PROP_MODEL:
       g_value_set_object (value, self->root_node.model);
       break;
@@ -668,6 +823,8 @@ gtk_tree_list_model_finalize (GObject *object)
 {
   GtkTreeListModel *self = GTK_TREE_LIST_MODEL (object);
 
+  g_clear_handle_id (&self->autoexpand_idle, g_source_remove);
+  g_clear_pointer (&self->autoexpand_rows, g_ptr_array_unref);
   gtk_tree_list_model_clear_node (&self->root_node);
   if (self->user_destroy)
     self->user_destroy (self->user_data);
@@ -696,6 +853,18 @@ gtk_tree_list_model_class_init (GtkTreeListModelClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTreeListModel:autoexpand-depth:
+   *
+   * The number of levels expanded right away by autoexpand or 0 for all
+   */
+  properties[PROP_AUTOEXPAND_DEPTH] =
+      g_param_spec_uint ("autoexpand-depth",
+                         P_("Autoexpand depth"),
+                         P_("Number of levels expanded right away by autoexpand"),
+                         0, G_MAXUINT, 0,
+                         GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkTreeListModel:model:
    *
@@ -773,6 +942,53 @@ gtk_tree_list_model_new (GListModel                      *root,
   return self;
 }
 
+/**
+ * gtk_tree_list_model_new_async:
+ * @root: (transfer full): The #GListModel to use as root
+ * @passthrough: %TRUE to pass through items from the models
+ * @autoexpand: %TRUE to set the autoexpand property and expand the @root model
+ * @create_async_func: Function to call to request the #GListModel for the
+ *     children of an item
+ * @user_data: (closure): Data to pass to @create_async_func
+ * @user_destroy: Function to call to free @user_data
+ *
+ * Creates a new empty #GtkTreeListModel displaying @root with all rows
+ * collapsed, whose child models are created asynchronously.
+ *
+ * When a row gets expanded, @create_async_func is called and the row is
+ * followed by a placeholder row until gtk_tree_list_row_set_children()
+ * is called. Placeholder rows have no item. In passthrough mode, no
+ * placeholder is shown.
+ *
+ * Returns: a newly created #GtkTreeListModel.
+ **/
+GtkTreeListModel *
+gtk_tree_list_model_new_async (GListModel                           *root,
+                               gboolean                              passthrough,
+                               gboolean                              autoexpand,
+                               GtkTreeListModelCreateModelAsyncFunc  create_async_func,
+                               gpointer                              user_data,
+                               GDestroyNotify                        user_destroy)
+{
+  GtkTreeListModel *self;
+
+  g_return_val_if_fail (G_IS_LIST_MODEL (root), NULL);
+  g_return_val_if_fail (create_async_func != NULL, NULL);
+
+  self = g_object_new (GTK_TYPE_TREE_LIST_MODEL,
+                       "autoexpand", autoexpand,
+                       "passthrough", passthrough,
+                       NULL);
+
+  self->create_async_func = create_async_func;
+  self->user_data = user_data;
+  self->user_destroy = user_destroy;
+
+  gtk_tree_list_model_init_node (self, &self->root_node, root);
+
+  return self;
+}
+
 /**
  * gtk_tree_list_model_get_model:
  * @self: a #GtkTreeListModel
@@ -853,6 +1069,51 @@ gtk_tree_list_model_get_autoexpand (GtkTreeListModel *self)
   return self->autoexpand;
 }
 
+/**
+ * gtk_tree_list_model_set_autoexpand_depth:
+ * @self: a #GtkTreeListModel
+ * @depth: the number of levels to expand right away or 0 for all
+ *
+ * Limits how many levels of the tree autoexpand expands right away.
+ *
+ * Rows deeper than @depth are expanded once a #GtkTreeExpander shows
+ * them, which usually happens when they are scrolled into view. This
+ * avoids creating the child models of large trees that are never looked
+ * at. Looking up rows, for example by sorting or filtering the model,
+ * does not expand them.
+ *
+ * This only affects rows added after the call.
+ **/
+void
+gtk_tree_list_model_set_autoexpand_depth (GtkTreeListModel *self,
+                                          guint             depth)
+{
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  if (self->autoexpand_depth == depth)
+    return;
+
+  self->autoexpand_depth = depth;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_AUTOEXPAND_DEPTH]);
+}
+
+/**
+ * gtk_tree_list_model_get_autoexpand_depth:
+ * @self: a #GtkTreeListModel
+ *
+ * Gets the value set via gtk_tree_list_model_set_autoexpand_depth().
+ *
+ * Returns: the number of levels expanded right away or 0 for all
+ **/
+guint
+gtk_tree_list_model_get_autoexpand_depth (GtkTreeListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_TREE_LIST_MODEL (self), 0);
+
+  return self->autoexpand_depth;
+}
+
 /**
  * gtk_tree_list_model_get_row:
  * @self: a #GtkTreeListModel
@@ -1148,21 +1409,24 @@ gtk_tree_list_row_get_position (GtkTreeListRow *self)
 guint
 gtk_tree_list_row_get_depth (GtkTreeListRow *self)
 {
-  TreeNode *node;
-  guint depth;
-
   g_return_val_if_fail (GTK_IS_TREE_LIST_ROW (self), 0);
 
   if (self->node == NULL)
     return 0;
 
-  depth = 0;
-  for (node = self->node->parent;
-       !node->is_root;
-       node = node->parent)
-    depth++;
+  return tree_node_get_depth (self->node);
+}
 
-  return depth;
+/* Called by GtkTreeExpander when it shows the row */
+void
+gtk_tree_list_row_shown (GtkTreeListRow *self)
+{
+  g_return_if_fail (GTK_IS_TREE_LIST_ROW (self));
+
+  if (self->node == NULL || !self->node->autoexpand_pending)
+    return;
+
+  gtk_tree_list_model_queue_autoexpand (tree_node_get_tree_list_model (self->node), self->node);
 }
 
 /**
@@ -1242,7 +1506,9 @@ gtk_tree_list_row_get_expanded (GtkTreeListRow *self)
  * row is actually expanded, this can be checked with
  * gtk_tree_list_row_get_expanded()
  * 
- * If a row is expandable never changes until the row is destroyed.
+ * If a row is expandable never changes until the row is destroyed,
+ * unless the model was created with gtk_tree_list_model_new_async()
+ * and gtk_tree_list_row_set_children() reported no children.
  *
  * Returns: %TRUE if the row is expandable
  **/
@@ -1264,6 +1530,10 @@ gtk_tree_list_row_is_expandable (GtkTreeListRow *self)
     return TRUE;
 
   list = tree_node_get_tree_list_model (self->node);
+  /* We don't know until the children arrive */
+  if (list->create_async_func)
+    return TRUE;
+
   model = tree_node_create_model (list, self->node);
   if (model)
     {
@@ -1320,6 +1590,69 @@ gtk_tree_list_row_get_children (GtkTreeListRow *self)
   return self->node->model;
 }
 
+/**
+ * gtk_tree_list_row_set_children:
+ * @self: a #GtkTreeListRow
+ * @request: the request token passed to the #GtkTreeListModelCreateModelAsyncFunc
+ * @children: (nullable) (transfer none): The model containing the children
+ *     of @self or %NULL if @self has no children
+ *
+ * Sets the children of a row after they have been requested via the
+ * #GtkTreeListModelCreateModelAsyncFunc of a model created with
+ * gtk_tree_list_model_new_async().
+ *
+ * This replaces the placeholder row shown while the children were loading.
+ * If @children is %NULL, the row is collapsed and will not be expandable
+ * anymore.
+ *
+ * If the row has been destroyed or collapsed in the meantime, this function
+ * does nothing. This is also the case if the row has been expanded again,
+ * because that issues a new request with a different @request token.
+ **/
+void
+gtk_tree_list_row_set_children (GtkTreeListRow *self,
+                                guint           request,
+                                GListModel     *children)
+{
+  GtkTreeListModel *list;
+  TreeNode *node;
+  gboolean emit;
+  guint removed, added;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_ROW (self));
+  g_return_if_fail (children == NULL || G_IS_LIST_MODEL (children));
+
+  node = self->node;
+  if (node == NULL || !node->loading || node->request != request)
+    return;
+
+  list = tree_node_get_tree_list_model (node);
+  /* When called from the create function, the caller does the emission */
+  emit = list->requesting != node;
+
+  removed = tree_node_get_n_children (node);
+  node->loading = FALSE;
+  node->request = 0;
+  g_clear_pointer (&node->children, gtk_rb_tree_unref);
+
+  if (children)
+    gtk_tree_list_model_init_node (list, node, g_object_ref (children));
+  else
+    node->empty = TRUE;
+
+  tree_node_mark_dirty (node);
+  added = tree_node_get_n_children (node);
+
+  if (emit && (removed > 0 || added > 0))
+    g_list_model_items_changed (G_LIST_MODEL (list),
+                                tree_node_get_position (node) + 1,
+                                removed, added);
+
+  if (children == NULL)
+    g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_EXPANDED]);
+  g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_CHILDREN]);
+}
+
 /**
  * gtk_tree_list_row_get_parent:
  * @self: a #GtkTreeListRow
@@ -57,6 +57,23 @@ G_DECLARE_FINAL_TYPE (GtkTreeListRow, gtk_tree_list_row, GTK, TREE_LIST_ROW, GOb
  */
 typedef GListModel * (* GtkTreeListModelCreateModelFunc) (gpointer item, gpointer user_data);
 
+/**
+ * GtkTreeListModelCreateModelAsyncFunc:
+ * @row: The row that is being expanded
+ * @item: (type GObject): The item that is being expanded
+ * @request: A token identifying this request
+ * @user_data: User data passed when registering the function
+ *
+ * Prototype of the function called to request new child models when
+ * gtk_tree_list_row_set_expanded() is called on a model created with
+ * gtk_tree_list_model_new_async().
+ *
+ * Once the children are known, call gtk_tree_list_row_set_children() on
+ * @row with @request. This can happen right away or later, in which case
+ * a reference to @row must be kept.
+ */
+typedef void (* GtkTreeListModelCreateModelAsyncFunc) (GtkTreeListRow *row, gpointer item, guint request, gpointer user_data);
+
 GDK_AVAILABLE_IN_ALL
 GtkTreeListModel *      gtk_tree_list_model_new                 (GListModel             *root,
                                                                  gboolean                passthrough,
@@ -64,6 +81,13 @@ GtkTreeListModel *      gtk_tree_list_model_new                 (GListModel
                                                                  GtkTreeListModelCreateModelFunc create_func,
                                                                  gpointer                user_data,
                                                                  GDestroyNotify          user_destroy);
+GDK_AVAILABLE_IN_ALL
+GtkTreeListModel *      gtk_tree_list_model_new_async           (GListModel             *root,
+                                                                 gboolean                passthrough,
+                                                                 gboolean                autoexpand,
+                                                                 GtkTreeListModelCreateModelAsyncFunc create_async_func,
+                                                                 gpointer                user_data,
+                                                                 GDestroyNotify          user_destroy);
 
 GDK_AVAILABLE_IN_ALL
 GListModel *            gtk_tree_list_model_get_model           (GtkTreeListModel       *self);
@@ -74,6 +98,11 @@ void                    gtk_tree_list_model_set_autoexpand      (GtkTreeListMode
                                                                  gboolean                autoexpand);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_tree_list_model_get_autoexpand      (GtkTreeListModel       *self);
+GDK_AVAILABLE_IN_ALL
+void                    gtk_tree_list_model_set_autoexpand_depth (GtkTreeListModel      *self,
+                                                                 guint                   depth);
+GDK_AVAILABLE_IN_ALL
+guint                   gtk_tree_list_model_get_autoexpand_depth (GtkTreeListModel      *self);
 
 GDK_AVAILABLE_IN_ALL
 GtkTreeListRow *        gtk_tree_list_model_get_child_row       (GtkTreeListModel       *self,
@@ -98,6 +127,10 @@ guint                   gtk_tree_list_row_get_depth             (GtkTreeListRow
 GDK_AVAILABLE_IN_ALL
 GListModel *            gtk_tree_list_row_get_children          (GtkTreeListRow         *self);
 GDK_AVAILABLE_IN_ALL
+void                    gtk_tree_list_row_set_children          (GtkTreeListRow         *self,
+                                                                 guint                   request,
+                                                                 GListModel             *children);
+GDK_AVAILABLE_IN_ALL
 GtkTreeListRow *        gtk_tree_list_row_get_parent            (GtkTreeListRow         *self);
 GDK_AVAILABLE_IN_ALL
 GtkTreeListRow *        gtk_tree_list_row_get_child_row         (GtkTreeListRow         *self,
@@ -0,0 +1,24 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_TREE_LIST_MODEL_PRIVATE_H__
+#define __GTK_TREE_LIST_MODEL_PRIVATE_H__
+
+#include <gtk/gtktreelistmodel.h>
+
+void                    gtk_tree_list_row_shown                 (GtkTreeListRow         *self);
+
+
+#endif /* __GTK_TREE_LIST_MODEL_PRIVATE_H__ */
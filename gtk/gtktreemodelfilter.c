@@ -18,6 +18,7 @@
 
 #include "config.h"
 #include "gtktreemodelfilter.h"
+#include "gtkbitset.h"
 #include "gtkintl.h"
 #include "gtktreednd.h"
 #include "gtkprivate.h"
@@ -4248,6 +4249,155 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
                           filter);
 }
 
+static void
+collect_offsets (gpointer data,
+                 gpointer user_data)
+{
+  FilterElt *elt = data;
+  GtkBitset **sets = user_data;
+
+  if (elt->visible_siter)
+    gtk_bitset_add (sets[0], elt->offset);
+  if (elt->children)
+    gtk_bitset_add (sets[1], elt->offset);
+}
+
+/* c_parent_path is the path of the level's parent in the child model,
+ * including the virtual root.
+ */
+static void
+gtk_tree_model_filter_refilter_level (GtkTreeModelFilter *filter,
+                                      GtkTreePath        *c_parent_path)
+{
+  GtkTreeModel *c_model = filter->priv->child_model;
+  FilterLevel *level;
+  GtkTreePath *path;
+  GtkTreeIter c_iter;
+  GtkBitset *sets[2];
+  GtkBitset *changed;
+  GtkBitsetIter bitset_iter;
+  guint offset;
+
+  if (filter->priv->virtual_root)
+    path = gtk_tree_model_filter_remove_root (c_parent_path, filter->priv->virtual_root);
+  else if (gtk_tree_path_get_depth (c_parent_path) > 0)
+    path = gtk_tree_path_copy (c_parent_path);
+  else
+    path = NULL;
+
+  if (path)
+    {
+      FilterElt *elt;
+      gboolean found;
+
+      found = find_elt_with_offset (filter, path, NULL, &elt);
+      gtk_tree_path_free (path);
+      if (!found)
+        return;
+      level = elt->children;
+    }
+  else
+    level = FILTER_LEVEL (filter->priv->root);
+
+  /* Levels that were never built have no state to update */
+  if (level == NULL)
+    return;
+
+  if (gtk_tree_path_get_depth (c_parent_path) > 0)
+    {
+      GtkTreeIter c_parent;
+
+      if (!gtk_tree_model_get_iter (c_model, &c_parent, c_parent_path) ||
+          !gtk_tree_model_iter_children (c_model, &c_iter, &c_parent))
+        return;
+    }
+  else if (!gtk_tree_model_get_iter_first (c_model, &c_iter))
+    return;
+
+  /* sets[0] is the old visibility, sets[1] the rows with built children */
+  sets[0] = gtk_bitset_new_empty ();
+  sets[1] = gtk_bitset_new_empty ();
+  g_sequence_foreach (level->seq, collect_offsets, sets);
+
+  changed = gtk_bitset_new_empty ();
+  offset = 0;
+  do
+    {
+      if (gtk_tree_model_filter_visible (filter, &c_iter))
+        gtk_bitset_add (changed, offset);
+      offset++;
+    }
+  while (gtk_tree_model_iter_next (c_model, &c_iter));
+
+  gtk_bitset_difference (changed, sets[0]);
+
+  /* Only the rows that changed visibility need to be inserted or
+   * deleted. This is done by paths, as it may rebuild or free levels.
+   */
+  if (gtk_bitset_iter_init_first (&bitset_iter, changed, &offset))
+    {
+      do
+        {
+          GtkTreePath *c_path = gtk_tree_path_copy (c_parent_path);
+
+          gtk_tree_path_append_index (c_path, offset);
+          if (gtk_tree_model_get_iter (c_model, &c_iter, c_path))
+            gtk_tree_model_filter_row_changed (c_model, c_path, &c_iter, filter);
+          gtk_tree_path_free (c_path);
+        }
+      while (gtk_bitset_iter_next (&bitset_iter, &offset));
+    }
+
+  if (gtk_bitset_iter_init_first (&bitset_iter, sets[1], &offset))
+    {
+      do
+        {
+          GtkTreePath *c_path = gtk_tree_path_copy (c_parent_path);
+
+          gtk_tree_path_append_index (c_path, offset);
+          gtk_tree_model_filter_refilter_level (filter, c_path);
+          gtk_tree_path_free (c_path);
+        }
+      while (gtk_bitset_iter_next (&bitset_iter, &offset));
+    }
+
+  gtk_bitset_unref (changed);
+  gtk_bitset_unref (sets[0]);
+  gtk_bitset_unref (sets[1]);
+}
+
+/**
+ * gtk_tree_model_filter_refilter_visibility:
+ * @filter: A #GtkTreeModelFilter.
+ *
+ * Re-evaluates whether rows are visible, like gtk_tree_model_filter_refilter(),
+ * but only emits ::row-inserted and ::row-deleted for the rows whose
+ * visibility changed and no ::row-changed for the others.
+ *
+ * Only rows in levels that have been accessed are evaluated, so this is
+ * much faster than gtk_tree_model_filter_refilter() for large models
+ * where few rows change.
+ */
+void
+gtk_tree_model_filter_refilter_visibility (GtkTreeModelFilter *filter)
+{
+  GtkTreePath *path;
+
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+
+  if (filter->priv->child_model == NULL || filter->priv->root == NULL)
+    return;
+
+  if (filter->priv->virtual_root)
+    path = gtk_tree_path_copy (filter->priv->virtual_root);
+  else
+    path = gtk_tree_path_new ();
+
+  gtk_tree_model_filter_refilter_level (filter, path);
+
+  gtk_tree_path_free (path);
+}
+
 /**
  * gtk_tree_model_filter_clear_cache:
  * @filter: A #GtkTreeModelFilter.
@@ -260,6 +260,8 @@ typedef enum {
 #define GTK_TREE_VIEW_PRIORITY_SCROLL_SYNC (GTK_TREE_VIEW_PRIORITY_VALIDATE + 2)
 /* 3/5 of gdkframeclockidle.c's FRAME_INTERVAL (16667 microsecs) */
 #define GTK_TREE_VIEW_TIME_MS_PER_IDLE 10
+/* minimum time spent validating while frames are being drawn */
+#define GTK_TREE_VIEW_MIN_TIME_MS_PER_IDLE 1
 #define SCROLL_EDGE_SIZE 15
 #define GTK_TREE_VIEW_SEARCH_DIALOG_TIMEOUT 5000
 #define AUTO_EXPAND_TIMEOUT 500
@@ -424,6 +426,10 @@ typedef struct
   /* fixed height */
   int fixed_height;
 
+  /* estimated height of invalid rows, averaged over validated rows */
+  gint64 validated_height_sum;
+  guint n_validated_heights;
+
   GtkTreeRBNode *rubber_band_start_node;
   GtkTreeRBTree *rubber_band_start_tree;
 
@@ -5682,6 +5688,12 @@ validate_row (GtkTreeView   *tree_view,
   if (draw_hgrid_lines)
     height += _TREE_VIEW_GRID_LINE_WIDTH;
 
+  if (!is_separator)
+    {
+      priv->validated_height_sum += height;
+      priv->n_validated_heights++;
+    }
+
   if (height != GTK_TREE_RBNODE_GET_HEIGHT (node))
     {
       retval = TRUE;
@@ -6095,6 +6107,55 @@ initialize_fixed_height_mode (GtkTreeView *tree_view)
                                  priv->fixed_height, TRUE);
 }
 
+static int
+gtk_tree_view_get_estimated_row_height (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = gtk_tree_view_get_instance_private (tree_view);
+
+  if (priv->n_validated_heights == 0)
+    return 0;
+
+  return priv->validated_height_sum / priv->n_validated_heights;
+}
+
+static void
+gtk_tree_view_reset_estimated_row_height (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = gtk_tree_view_get_instance_private (tree_view);
+
+  priv->validated_height_sum = 0;
+  priv->n_validated_heights = 0;
+}
+
+/* Returns the time in microseconds do_validate_rows() may take.
+ * While frames are being drawn, we only use the time left until the
+ * next frame is due, so validating doesn't make us miss frames.
+ */
+static gint64
+gtk_tree_view_get_validate_budget (GtkTreeView *tree_view)
+{
+  GdkFrameClock *frame_clock;
+  gint64 now, frame_time, refresh_interval, remaining;
+
+  frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (tree_view));
+  if (frame_clock == NULL)
+    return GTK_TREE_VIEW_TIME_MS_PER_IDLE * G_TIME_SPAN_MILLISECOND;
+
+  now = g_get_monotonic_time ();
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  gdk_frame_clock_get_refresh_info (frame_clock, frame_time, &refresh_interval, NULL);
+
+  /* no frame in progress */
+  if (refresh_interval <= 0 || now - frame_time >= refresh_interval)
+    return GTK_TREE_VIEW_TIME_MS_PER_IDLE * G_TIME_SPAN_MILLISECOND;
+
+  remaining = frame_time + refresh_interval - now;
+
+  return CLAMP (remaining,
+                GTK_TREE_VIEW_MIN_TIME_MS_PER_IDLE * G_TIME_SPAN_MILLISECOND,
+                GTK_TREE_VIEW_TIME_MS_PER_IDLE * G_TIME_SPAN_MILLISECOND);
+}
+
 /* Our strategy for finding nodes to validate is a little convoluted.  We find
  * the left-most uninvalidated node.  We then try walking right, validating
  * nodes.  Once we find a valid node, we repeat the previous process of finding
@@ -6113,12 +6174,10 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   int retval = TRUE;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
-  GTimer *timer;
+  gint64 end_time;
   int i = 0;
 
   int y = -1;
-  int prev_height = -1;
-  gboolean fixed_height = TRUE;
 
   g_assert (tree_view);
 
@@ -6137,8 +6196,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
       return FALSE;
     }
 
-  timer = g_timer_new ();
-  g_timer_start (timer);
+  end_time = g_get_monotonic_time () + gtk_tree_view_get_validate_budget (tree_view);
 
   do
     {
@@ -6214,25 +6272,20 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
             y = offset;
         }
 
-      if (!priv->fixed_height_check)
-        {
-	  int height;
-
-	  height = gtk_tree_view_get_row_height (tree_view, node);
-	  if (prev_height < 0)
-	    prev_height = height;
-	  else if (prev_height != height)
-	    fixed_height = FALSE;
-	}
-
       i++;
     }
-  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000.);
+  while (g_get_monotonic_time () < end_time);
 
+  /* After the first batch, give all rows that are still invalid the
+   * average height of the validated ones, so the scrollbars start out
+   * close to their final size instead of growing while we validate.
+   */
   if (!priv->fixed_height_check)
    {
-     if (fixed_height)
-       gtk_tree_rbtree_set_fixed_height (priv->tree, prev_height, FALSE);
+     int estimated_height = gtk_tree_view_get_estimated_row_height (tree_view);
+
+     if (estimated_height > 0)
+       gtk_tree_rbtree_set_fixed_height (priv->tree, estimated_height, FALSE);
 
      priv->fixed_height_check = 1;
    }
@@ -6286,7 +6339,6 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
     }
 
   if (path) gtk_tree_path_free (path);
-  g_timer_destroy (timer);
 
   if (!retval && gtk_widget_get_mapped (GTK_WIDGET (tree_view)))
     update_prelight (tree_view,
@@ -7912,6 +7964,7 @@ gtk_tree_view_css_changed (GtkWidget         *widget,
 	}
 
       priv->fixed_height = -1;
+      gtk_tree_view_reset_estimated_row_height (tree_view);
       gtk_tree_rbtree_mark_invalid (priv->tree);
     }
 
@@ -8187,6 +8240,15 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
       tmpnode = gtk_tree_rbtree_insert_after (tree, tmpnode, height, FALSE);
     }
 
+  /* The row stays invalid, but don't make it jump from 0 */
+  if (height == 0)
+    {
+      int estimated_height = gtk_tree_view_get_estimated_row_height (tree_view);
+
+      if (estimated_height > 0)
+        gtk_tree_rbtree_node_set_height (tree, tmpnode, estimated_height);
+    }
+
  done:
   if (height > 0)
     {
@@ -8589,11 +8651,14 @@ gtk_tree_view_build_tree (GtkTreeView   *tree_view,
   GtkTreeViewPrivate *priv = gtk_tree_view_get_instance_private (tree_view);
   GtkTreeRBNode *temp = NULL;
   GtkTreePath *path = NULL;
+  int estimated_height;
+
+  estimated_height = gtk_tree_view_get_estimated_row_height (tree_view);
 
   do
     {
       gtk_tree_model_ref_node (priv->model, iter);
-      temp = gtk_tree_rbtree_insert_after (tree, temp, 0, FALSE);
+      temp = gtk_tree_rbtree_insert_after (tree, temp, estimated_height, FALSE);
 
       if (priv->fixed_height > 0)
         {
@@ -10305,6 +10370,7 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
       priv->search_column = -1;
       priv->fixed_height_check = 0;
       priv->fixed_height = -1;
+      gtk_tree_view_reset_estimated_row_height (tree_view);
       priv->dy = priv->top_row_dy = 0;
     }
 
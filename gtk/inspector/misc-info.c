@@ -72,6 +72,8 @@ struct _GtkInspectorMiscInfo
   GtkWidget *framerate;
   GtkWidget *framecount_row;
   GtkWidget *framecount;
+  GtkWidget *frame_phases_row;
+  GtkWidget *frame_phases;
   GtkWidget *mapped_row;
   GtkWidget *mapped;
   GtkWidget *realized_row;
@@ -296,6 +298,44 @@ update_frame_clock (GtkInspectorMiscInfo *sl)
     }
 }
 
+static void
+update_frame_phases (GtkInspectorMiscInfo *sl,
+                     GdkFrameClock        *clock)
+{
+  static const struct {
+    GdkFrameClockPhase phase;
+    const char *name;
+  } phases[] = {
+    { GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS, "flush-events" },
+    { GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT, "before-paint" },
+    { GDK_FRAME_CLOCK_PHASE_UPDATE, "update" },
+    { GDK_FRAME_CLOCK_PHASE_LAYOUT, "layout" },
+    { GDK_FRAME_CLOCK_PHASE_PAINT, "paint" },
+    { GDK_FRAME_CLOCK_PHASE_AFTER_PAINT, "after-paint" },
+  };
+  GString *str;
+  int i;
+
+  str = g_string_new ("");
+
+  for (i = 0; i < G_N_ELEMENTS (phases); i++)
+    {
+      if (gdk_frame_clock_get_phase_count (clock, phases[i].phase) == 0)
+        continue;
+
+      if (str->len > 0)
+        g_string_append_c (str, '\n');
+
+      g_string_append_printf (str, "%s  %.2f ⁄ %.2f ms",
+                              phases[i].name,
+                              gdk_frame_clock_get_phase_percentile (clock, phases[i].phase, 50) / 1000.,
+                              gdk_frame_clock_get_phase_percentile (clock, phases[i].phase, 99) / 1000.);
+    }
+
+  gtk_label_set_label (GTK_LABEL (sl->frame_phases), str->len > 0 ? str->str : "—");
+  g_string_free (str, TRUE);
+}
+
 static gboolean
 update_info (gpointer data)
 {
@@ -391,6 +431,8 @@ update_info (gpointer data)
         }
 
       sl->last_frame = frame;
+
+      update_frame_phases (sl, clock);
     }
 
   return G_SOURCE_CONTINUE;
@@ -462,11 +504,13 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
     {
       gtk_widget_show (sl->framecount_row);
       gtk_widget_show (sl->framerate_row);
+      gtk_widget_show (sl->frame_phases_row);
     }
   else
     {
       gtk_widget_hide (sl->framecount_row);
       gtk_widget_hide (sl->framerate_row);
+      gtk_widget_hide (sl->frame_phases_row);
     }
 
   update_info (sl);
@@ -559,6 +603,8 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framecount);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, frame_phases_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, frame_phases);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mapped_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mapped);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, realized_row);
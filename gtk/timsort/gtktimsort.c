@@ -6,6 +6,10 @@
 
 #include "gtktimsortprivate.h"
 
+#include "gtkthreadpoolprivate.h"
+
+#include <string.h>
+
 /*
  * This is the minimum sized sequence that will be merged.  Shorter
  * sequences will be lengthened by calling binarySort.  If the entire
@@ -31,6 +35,12 @@
  */
 #define MIN_GALLOP 7
 
+/*
+ * The minimum number of elements per thread for gtk_tim_sort_parallel().
+ * Below that, the overhead of threading isn't worth it.
+ */
+#define MIN_PARALLEL_SEGMENT 8192
+
 /*
  * Returns the minimum acceptable run length for an array of the specified
  * length. Natural runs shorter than this will be extended with binary sort.
@@ -104,6 +114,301 @@ gtk_tim_sort (gpointer         base,
   gtk_tim_sort_finish (&self);
 }
 
+/* Parallel sorting
+ *
+ * The array is split into segments that are sorted independently, and
+ * then the sorted segments are merged pairwise until one is left. Every
+ * pairwise merge is itself split into independent pieces, so all
+ * threads are busy even in the last rounds.
+ *
+ * Merges prefer the left side on ties, so the result is the same
+ * stable order the serial sort produces.
+ */
+typedef struct _GtkTimSortTask GtkTimSortTask;
+typedef struct _GtkTimSortBatch GtkTimSortBatch;
+
+struct _GtkTimSortTask
+{
+  /* If dest is NULL, a is sorted in place */
+  char *a;
+  gsize len_a;
+  char *b;
+  gsize len_b;
+  char *dest;
+};
+
+struct _GtkTimSortBatch
+{
+  int ref_count;
+
+  gsize element_size;
+  GCompareDataFunc compare_func;
+  gpointer data;
+
+  GtkTimSortTask *tasks;
+  guint n_tasks;
+  int next_task; /* atomic */
+
+  GMutex lock;
+  GCond cond;
+  guint n_finished; /* protected by lock */
+};
+
+static void
+gtk_tim_sort_batch_unref (GtkTimSortBatch *batch)
+{
+  if (!g_atomic_int_dec_and_test (&batch->ref_count))
+    return;
+
+  g_mutex_clear (&batch->lock);
+  g_cond_clear (&batch->cond);
+  g_free (batch->tasks);
+  g_free (batch);
+}
+
+static void
+gtk_tim_sort_merge_into (GtkTimSortBatch *batch,
+                         GtkTimSortTask  *task)
+{
+  gsize element_size = batch->element_size;
+  char *a = task->a;
+  char *b = task->b;
+  char *dest = task->dest;
+  gsize len_a = task->len_a;
+  gsize len_b = task->len_b;
+
+  while (len_a > 0 && len_b > 0)
+    {
+      if (batch->compare_func (b, a, batch->data) < 0)
+        {
+          memcpy (dest, b, element_size);
+          b += element_size;
+          len_b--;
+        }
+      else
+        {
+          memcpy (dest, a, element_size);
+          a += element_size;
+          len_a--;
+        }
+      dest += element_size;
+    }
+
+  memcpy (dest, a, len_a * element_size);
+  dest += len_a * element_size;
+  memcpy (dest, b, len_b * element_size);
+}
+
+static void
+gtk_tim_sort_batch_run (GtkTimSortBatch *batch)
+{
+  guint i;
+
+  while ((i = g_atomic_int_add (&batch->next_task, 1)) < batch->n_tasks)
+    {
+      GtkTimSortTask *task = &batch->tasks[i];
+
+      if (task->dest == NULL)
+        gtk_tim_sort (task->a, task->len_a, batch->element_size, batch->compare_func, batch->data);
+      else
+        gtk_tim_sort_merge_into (batch, task);
+
+      g_mutex_lock (&batch->lock);
+      batch->n_finished++;
+      if (batch->n_finished == batch->n_tasks)
+        g_cond_signal (&batch->cond);
+      g_mutex_unlock (&batch->lock);
+    }
+}
+
+static void
+gtk_tim_sort_batch_thread (gpointer data)
+{
+  GtkTimSortBatch *batch = data;
+
+  gtk_tim_sort_batch_run (batch);
+  gtk_tim_sort_batch_unref (batch);
+}
+
+/* Runs all tasks, using up to n_threads threads including this one */
+static void
+gtk_tim_sort_run_tasks (GtkTimSortTask   *tasks,
+                        guint             n_tasks,
+                        gsize             element_size,
+                        GCompareDataFunc  compare_func,
+                        gpointer          data,
+                        guint             n_threads)
+{
+  GtkTimSortBatch *batch;
+  guint i;
+
+  batch = g_new0 (GtkTimSortBatch, 1);
+  batch->ref_count = 1;
+  batch->element_size = element_size;
+  batch->compare_func = compare_func;
+  batch->data = data;
+  batch->tasks = tasks;
+  batch->n_tasks = n_tasks;
+  g_mutex_init (&batch->lock);
+  g_cond_init (&batch->cond);
+
+  for (i = 1; i < MIN (n_threads, n_tasks); i++)
+    {
+      g_atomic_int_inc (&batch->ref_count);
+      gtk_thread_pool_push (gtk_tim_sort_batch_thread, batch);
+    }
+
+  gtk_tim_sort_batch_run (batch);
+
+  g_mutex_lock (&batch->lock);
+  while (batch->n_finished < batch->n_tasks)
+    g_cond_wait (&batch->cond, &batch->lock);
+  g_mutex_unlock (&batch->lock);
+
+  gtk_tim_sort_batch_unref (batch);
+}
+
+/* Number of elements in a that are smaller than key */
+static gsize
+gtk_tim_sort_lower_bound (char             *a,
+                          gsize             len,
+                          gsize             element_size,
+                          char             *key,
+                          GCompareDataFunc  compare_func,
+                          gpointer          data)
+{
+  gsize lo = 0, hi = len;
+
+  while (lo < hi)
+    {
+      gsize mid = lo + (hi - lo) / 2;
+
+      if (compare_func (a + mid * element_size, key, data) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/*<private>
+ * gtk_tim_sort_parallel:
+ * @base: the array to sort
+ * @size: the number of elements in @base
+ * @element_size: the size of each element
+ * @compare_func: the function to compare elements
+ * @user_data: data to pass to @compare_func
+ * @n_threads: the maximum number of threads to use
+ *
+ * Sorts @base like gtk_tim_sort(), but splits the work across up
+ * to @n_threads threads. The result is identical to gtk_tim_sort().
+ *
+ * @compare_func will be called from multiple threads at once, so
+ * it must be thread-safe.
+ **/
+void
+gtk_tim_sort_parallel (gpointer         base,
+                       gsize            size,
+                       gsize            element_size,
+                       GCompareDataFunc compare_func,
+                       gpointer         user_data,
+                       guint            n_threads)
+{
+  GtkTimSortTask *tasks;
+  gsize *offsets;
+  guint n_segments, n_pieces, n_tasks, i, p;
+  char *src, *dest, *tmp;
+
+  n_threads = MIN (n_threads, size / MIN_PARALLEL_SEGMENT);
+  if (n_threads < 2)
+    {
+      gtk_tim_sort (base, size, element_size, compare_func, user_data);
+      return;
+    }
+
+  /* Use a power of 2 segments, so every round merges pairs */
+  n_segments = 1;
+  while (n_segments < n_threads)
+    n_segments *= 2;
+
+  offsets = g_new (gsize, n_segments + 1);
+  for (i = 0; i <= n_segments; i++)
+    offsets[i] = size * i / n_segments;
+
+  tasks = g_new0 (GtkTimSortTask, n_segments);
+  for (i = 0; i < n_segments; i++)
+    {
+      tasks[i].a = (char *) base + offsets[i] * element_size;
+      tasks[i].len_a = offsets[i + 1] - offsets[i];
+    }
+  gtk_tim_sort_run_tasks (tasks, n_segments, element_size, compare_func, user_data, n_threads);
+
+  tmp = g_malloc (size * element_size);
+  src = base;
+  dest = tmp;
+
+  for (; n_segments > 1; n_segments /= 2)
+    {
+      n_pieces = MAX (1, n_threads / (n_segments / 2));
+      tasks = g_new0 (GtkTimSortTask, n_segments / 2 * n_pieces);
+      n_tasks = 0;
+
+      for (i = 0; i < n_segments; i += 2)
+        {
+          char *a = src + offsets[i] * element_size;
+          char *b = src + offsets[i + 1] * element_size;
+          gsize len_a = offsets[i + 1] - offsets[i];
+          gsize len_b = offsets[i + 2] - offsets[i + 1];
+          gsize start_a = 0, start_b = 0;
+
+          for (p = 1; p <= n_pieces; p++)
+            {
+              gsize end_a, end_b;
+
+              if (p == n_pieces)
+                {
+                  end_a = len_a;
+                  end_b = len_b;
+                }
+              else
+                {
+                  end_a = len_a * p / n_pieces;
+                  if (end_a == len_a)
+                    continue;
+                  end_b = gtk_tim_sort_lower_bound (b, len_b, element_size,
+                                                    a + end_a * element_size,
+                                                    compare_func, user_data);
+                }
+
+              tasks[n_tasks].a = a + start_a * element_size;
+              tasks[n_tasks].len_a = end_a - start_a;
+              tasks[n_tasks].b = b + start_b * element_size;
+              tasks[n_tasks].len_b = end_b - start_b;
+              tasks[n_tasks].dest = dest + (offsets[i] + start_a + start_b) * element_size;
+              n_tasks++;
+
+              start_a = end_a;
+              start_b = end_b;
+            }
+        }
+
+      gtk_tim_sort_run_tasks (tasks, n_tasks, element_size, compare_func, user_data, n_threads);
+
+      for (i = 0; i <= n_segments / 2; i++)
+        offsets[i] = offsets[2 * i];
+
+      src = dest;
+      dest = (src == tmp) ? base : tmp;
+    }
+
+  if (src != base)
+    memcpy (base, src, size * element_size);
+
+  g_free (tmp);
+  g_free (offsets);
+}
+
 static inline int
 gtk_tim_sort_compare (GtkTimSort *self,
                       gpointer    a,
@@ -118,5 +118,11 @@ void            gtk_tim_sort                                    (gpointer
                                                                  gsize                   element_size,
                                                                  GCompareDataFunc        compare_func,
                                                                  gpointer                user_data);
+void            gtk_tim_sort_parallel                           (gpointer                base,
+                                                                 gsize                   size,
+                                                                 gsize                   element_size,
+                                                                 GCompareDataFunc        compare_func,
+                                                                 gpointer                user_data,
+                                                                 guint                   n_threads);
 
 #endif /* __GTK_TIMSORT_PRIVATE_H__ */
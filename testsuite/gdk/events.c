@@ -0,0 +1,268 @@
+#include <gdk/gdk.h>
+
+#include "gdk/gdkdisplayprivate.h"
+#include "gdk/gdkeventsprivate.h"
+
+static GdkDisplay *display;
+
+static GdkDevice *
+get_pointer (void)
+{
+  GdkSeat *seat;
+
+  if (display == NULL)
+    return NULL;
+
+  seat = gdk_display_get_default_seat (display);
+
+  return seat ? gdk_seat_get_pointer (seat) : NULL;
+}
+
+static void
+clear_queue (void)
+{
+  GdkEvent *event;
+
+  while ((event = g_queue_pop_head (&display->queued_events)))
+    gdk_event_unref (event);
+}
+
+static void
+test_scroll_compression (void)
+{
+  GdkSurface *surface;
+  GdkDevice *device;
+  GdkEvent *event;
+  GdkTimeCoord *history;
+  guint n_coords;
+  double dx, dy;
+
+  device = get_pointer ();
+  if (device == NULL)
+    {
+      g_test_skip ("No display with a pointer");
+      return;
+    }
+
+  surface = gdk_surface_new_toplevel (display);
+
+  _gdk_event_queue_append (display, gdk_scroll_event_new (surface, device, NULL, 10, 0, 1, 2, FALSE));
+  _gdk_event_queue_append (display, gdk_scroll_event_new (surface, device, NULL, 20, 0, 3, 4, FALSE));
+  _gdk_event_queue_append (display, gdk_scroll_event_new (surface, device, NULL, 30, 0, 5, 6, FALSE));
+
+  gdk_event_queue_handle_scroll_compression (display);
+
+  g_assert_cmpuint (g_queue_get_length (&display->queued_events), ==, 1);
+  event = g_queue_peek_head (&display->queued_events);
+  g_assert_cmpuint (gdk_event_get_time (event), ==, 30);
+  gdk_scroll_event_get_deltas (event, &dx, &dy);
+  g_assert_cmpfloat (dx, ==, 9);
+  g_assert_cmpfloat (dy, ==, 12);
+
+  history = gdk_event_get_history (event, &n_coords);
+  g_assert_cmpuint (n_coords, ==, 2);
+  g_assert_cmpuint (history[0].time, ==, 10);
+  g_assert_cmpuint (history[1].time, ==, 20);
+  g_free (history);
+
+  clear_queue ();
+  gdk_surface_destroy (surface);
+}
+
+static void
+test_touch_compression (void)
+{
+  GdkSurface *surface;
+  GdkDevice *device;
+  GdkEventSequence *seq1 = GUINT_TO_POINTER (1);
+  GdkEventSequence *seq2 = GUINT_TO_POINTER (2);
+  GdkEvent *event;
+  GdkTimeCoord *history;
+  guint n_coords;
+  double x, y;
+
+  device = get_pointer ();
+  if (device == NULL)
+    {
+      g_test_skip ("No display with a pointer");
+      return;
+    }
+
+  surface = gdk_surface_new_toplevel (display);
+
+  _gdk_event_queue_append (display, gdk_touch_event_new (GDK_TOUCH_UPDATE, seq1, surface, device, 10, 0, 1, 1, NULL, FALSE));
+  _gdk_event_queue_append (display, gdk_touch_event_new (GDK_TOUCH_UPDATE, seq2, surface, device, 11, 0, 2, 2, NULL, FALSE));
+  _gdk_event_queue_append (display, gdk_touch_event_new (GDK_TOUCH_UPDATE, seq1, surface, device, 20, 0, 3, 3, NULL, FALSE));
+  _gdk_event_queue_append (display, gdk_touch_event_new (GDK_TOUCH_UPDATE, seq2, surface, device, 21, 0, 4, 4, NULL, FALSE));
+  _gdk_event_queue_append (display, gdk_touch_event_new (GDK_TOUCH_UPDATE, seq1, surface, device, 30, 0, 5, 5, NULL, FALSE));
+
+  gdk_event_queue_handle_touch_compression (display);
+
+  /* the last update of every sequence stays, in queue order */
+  g_assert_cmpuint (g_queue_get_length (&display->queued_events), ==, 2);
+
+  event = g_queue_peek_nth (&display->queued_events, 0);
+  g_assert_true (gdk_event_get_event_sequence (event) == seq2);
+  g_assert_true (gdk_event_get_position (event, &x, &y));
+  g_assert_cmpfloat (x, ==, 4);
+  history = gdk_event_get_history (event, &n_coords);
+  g_assert_cmpuint (n_coords, ==, 1);
+  g_assert_cmpuint (history[0].time, ==, 11);
+  g_free (history);
+
+  event = g_queue_peek_nth (&display->queued_events, 1);
+  g_assert_true (gdk_event_get_event_sequence (event) == seq1);
+  g_assert_true (gdk_event_get_position (event, &x, &y));
+  g_assert_cmpfloat (x, ==, 5);
+  history = gdk_event_get_history (event, &n_coords);
+  g_assert_cmpuint (n_coords, ==, 2);
+  g_assert_cmpuint (history[0].time, ==, 10);
+  g_assert_cmpuint (history[1].time, ==, 20);
+  g_free (history);
+
+  clear_queue ();
+  gdk_surface_destroy (surface);
+}
+
+/* Compressing after every queued event, like the backends do, must
+ * keep the samples the dropped events collected before.
+ */
+static void
+test_incremental_compression (void)
+{
+  GdkSurface *surface;
+  GdkDevice *device;
+  GdkEventSequence *seq = GUINT_TO_POINTER (1);
+  GdkEvent *event;
+  GdkTimeCoord *history;
+  guint n_coords, i;
+  double dx, dy;
+
+  device = get_pointer ();
+  if (device == NULL)
+    {
+      g_test_skip ("No display with a pointer");
+      return;
+    }
+
+  surface = gdk_surface_new_toplevel (display);
+  /* so motion events record their history */
+  gdk_surface_set_input_batching (surface, TRUE);
+
+  for (i = 1; i <= 5; i++)
+    {
+      _gdk_event_queue_append (display, gdk_scroll_event_new (surface, device, NULL, 10 * i, 0, i, 2 * i, FALSE));
+      gdk_event_queue_handle_scroll_compression (display);
+    }
+
+  g_assert_cmpuint (g_queue_get_length (&display->queued_events), ==, 1);
+  event = g_queue_peek_head (&display->queued_events);
+  g_assert_cmpuint (gdk_event_get_time (event), ==, 50);
+  gdk_scroll_event_get_deltas (event, &dx, &dy);
+  g_assert_cmpfloat (dx, ==, 15);
+  g_assert_cmpfloat (dy, ==, 30);
+
+  history = gdk_event_get_history (event, &n_coords);
+  g_assert_cmpuint (n_coords, ==, 4);
+  for (i = 0; i < n_coords; i++)
+    {
+      g_assert_cmpuint (history[i].time, ==, 10 * (i + 1));
+      g_assert_cmpfloat (history[i].axes[GDK_AXIS_DELTA_X], ==, i + 1);
+      g_assert_cmpfloat (history[i].axes[GDK_AXIS_DELTA_Y], ==, 2 * (i + 1));
+    }
+  g_free (history);
+  clear_queue ();
+
+  for (i = 1; i <= 5; i++)
+    {
+      _gdk_event_queue_append (display, gdk_motion_event_new (surface, device, NULL, 10 * i, 0, i, i, NULL));
+      _gdk_event_queue_handle_motion_compression (display);
+    }
+
+  g_assert_cmpuint (g_queue_get_length (&display->queued_events), ==, 1);
+  event = g_queue_peek_head (&display->queued_events);
+  g_assert_cmpuint (gdk_event_get_time (event), ==, 50);
+
+  history = gdk_event_get_history (event, &n_coords);
+  g_assert_cmpuint (n_coords, ==, 4);
+  for (i = 0; i < n_coords; i++)
+    {
+      g_assert_cmpuint (history[i].time, ==, 10 * (i + 1));
+      g_assert_cmpfloat (history[i].axes[GDK_AXIS_X], ==, i + 1);
+    }
+  g_free (history);
+  clear_queue ();
+
+  for (i = 1; i <= 5; i++)
+    {
+      _gdk_event_queue_append (display, gdk_touch_event_new (GDK_TOUCH_UPDATE, seq, surface, device, 10 * i, 0, i, i, NULL, FALSE));
+      gdk_event_queue_handle_touch_compression (display);
+    }
+
+  g_assert_cmpuint (g_queue_get_length (&display->queued_events), ==, 1);
+  event = g_queue_peek_head (&display->queued_events);
+  g_assert_cmpuint (gdk_event_get_time (event), ==, 50);
+
+  history = gdk_event_get_history (event, &n_coords);
+  g_assert_cmpuint (n_coords, ==, 4);
+  for (i = 0; i < n_coords; i++)
+    {
+      g_assert_cmpuint (history[i].time, ==, 10 * (i + 1));
+      g_assert_cmpfloat (history[i].axes[GDK_AXIS_X], ==, i + 1);
+    }
+  g_free (history);
+
+  clear_queue ();
+  gdk_surface_destroy (surface);
+}
+
+static void
+test_input_batching (void)
+{
+  GdkSurface *surface;
+  GdkDevice *device;
+  GList *scroll;
+
+  device = get_pointer ();
+  if (device == NULL)
+    {
+      g_test_skip ("No display with a pointer");
+      return;
+    }
+
+  surface = gdk_surface_new_toplevel (display);
+  g_assert_false (gdk_surface_get_input_batching (surface));
+
+  /* without batching, scroll events are delivered right away */
+  scroll = _gdk_event_queue_append (display, gdk_scroll_event_new (surface, device, NULL, 10, 0, 1, 1, FALSE));
+  g_assert_true (_gdk_event_queue_find_first (display) == scroll);
+  clear_queue ();
+
+  /* with batching, a lone scroll event waits for the next frame... */
+  gdk_surface_set_input_batching (surface, TRUE);
+  g_assert_true (gdk_surface_get_input_batching (surface));
+  scroll = _gdk_event_queue_append (display, gdk_scroll_event_new (surface, device, NULL, 20, 0, 1, 1, FALSE));
+  g_assert_null (_gdk_event_queue_find_first (display));
+
+  /* ...unless another event follows it */
+  _gdk_event_queue_append (display, gdk_scroll_event_new_discrete (surface, device, NULL, 30, 0, GDK_SCROLL_UP, TRUE));
+  g_assert_true (_gdk_event_queue_find_first (display) == scroll);
+
+  clear_queue ();
+  gdk_surface_destroy (surface);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  display = gdk_display_open (NULL);
+
+  g_test_add_func ("/events/scroll-compression", test_scroll_compression);
+  g_test_add_func ("/events/touch-compression", test_touch_compression);
+  g_test_add_func ("/events/incremental-compression", test_incremental_compression);
+  g_test_add_func ("/events/input-batching", test_input_batching);
+
+  return g_test_run ();
+}
@@ -555,6 +555,190 @@ test_splice_overflow (void)
   g_assert_true (gtk_bitset_equals (set, compare));
 }
 
+static void
+test_splice (void)
+{
+  const struct {
+    guint position;
+    guint removed;
+    guint added;
+  } splices[] = {
+    { 0, 0, 1 },
+    { 5, 10, 0 },
+    { 1000, 0, 65536 },
+    { 1000, 65536, 0 },
+    { 99990, 12, 70000 },
+    { 500000, 3, 3 },
+    { G_MAXUINT - 10, 5, 10 },
+  };
+  guint i, j, value;
+  GtkBitset *set, *compare;
+  GtkBitsetIter iter;
+  gboolean more;
+
+  for (i = 0; i < G_N_ELEMENTS (bitsets); i++)
+    {
+      for (j = 0; j < G_N_ELEMENTS (splices); j++)
+        {
+          guint position = splices[j].position;
+          guint removed = splices[j].removed;
+          guint added = splices[j].added;
+
+          set = bitsets[i].create();
+          compare = gtk_bitset_new_empty ();
+          for (more = gtk_bitset_iter_init_first (&iter, set, &value);
+               more;
+               more = gtk_bitset_iter_next (&iter, &value))
+            {
+              if (value < position)
+                gtk_bitset_add (compare, value);
+              else if (value >= position + removed &&
+                       value - removed <= G_MAXUINT - added)
+                gtk_bitset_add (compare, value - removed + added);
+            }
+
+          gtk_bitset_splice (set, position, removed, added);
+          g_assert_true (gtk_bitset_equals (set, compare));
+
+          gtk_bitset_unref (compare);
+          gtk_bitset_unref (set);
+        }
+    }
+}
+
+static void
+test_many (void)
+{
+  guint values[1000];
+  GtkBitset *set, *compare;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    values[i] = g_test_rand_int_range (0, LARGE_VALUE);
+
+  set = gtk_bitset_new_empty ();
+  compare = gtk_bitset_new_empty ();
+
+  gtk_bitset_add_many (set, values, G_N_ELEMENTS (values));
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    gtk_bitset_add (compare, values[i]);
+  g_assert_true (gtk_bitset_equals (set, compare));
+
+  gtk_bitset_remove_many (set, values, G_N_ELEMENTS (values) / 2);
+  for (i = 0; i < G_N_ELEMENTS (values) / 2; i++)
+    gtk_bitset_remove (compare, values[i]);
+  g_assert_true (gtk_bitset_equals (set, compare));
+
+  gtk_bitset_unref (compare);
+  gtk_bitset_unref (set);
+}
+
+static gboolean
+collect_range (guint    first,
+               guint    last,
+               gpointer data)
+{
+  GtkBitset *set = data;
+
+  /* ranges come in order and are never adjacent */
+  g_assert_cmpuint (first, <=, last);
+  g_assert_true (gtk_bitset_is_empty (set) || gtk_bitset_get_maximum (set) + 1 < first);
+
+  gtk_bitset_add_range_closed (set, first, last);
+
+  return TRUE;
+}
+
+static void
+test_foreach_range (void)
+{
+  GtkBitset *set, *compare;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (bitsets); i++)
+    {
+      set = bitsets[i].create();
+
+      compare = gtk_bitset_new_empty ();
+      gtk_bitset_foreach_range (set, collect_range, compare);
+      g_assert_true (gtk_bitset_equals (set, compare));
+      gtk_bitset_unref (compare);
+
+      gtk_bitset_optimize (set);
+      g_assert_cmpuint (gtk_bitset_get_size (set), ==, bitsets[i].n_elements);
+
+      compare = gtk_bitset_new_empty ();
+      gtk_bitset_foreach_range (set, collect_range, compare);
+      g_assert_true (gtk_bitset_equals (set, compare));
+      gtk_bitset_unref (compare);
+
+      gtk_bitset_unref (set);
+    }
+}
+
+static void
+test_performance (void)
+{
+  guint n = g_test_perf () ? 10 * 1000 * 1000 : 100 * 1000;
+  guint values[1024];
+  GtkBitset *set, *all;
+  guint i, n_values;
+  double elapsed;
+
+  set = gtk_bitset_new_empty ();
+
+  g_test_timer_start ();
+  gtk_bitset_add_range (set, 0, n);
+  gtk_bitset_optimize (set);
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "selecting all of %u items: %gsec", n, elapsed);
+  g_assert_cmpuint (gtk_bitset_get_size (set), ==, n);
+
+  /* select every third item */
+  gtk_bitset_remove_all (set);
+  n_values = 0;
+  for (i = 0; i < n; i += 3)
+    {
+      values[n_values++] = i;
+      if (n_values == G_N_ELEMENTS (values))
+        {
+          gtk_bitset_add_many (set, values, n_values);
+          n_values = 0;
+        }
+    }
+  gtk_bitset_add_many (set, values, n_values);
+  g_assert_cmpuint (gtk_bitset_get_size (set), ==, (n + 2) / 3);
+
+  all = gtk_bitset_new_range (0, n);
+  g_test_timer_start ();
+  gtk_bitset_difference (set, all);
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "inverting selection of %u items: %gsec", n, elapsed);
+  g_assert_cmpuint (gtk_bitset_get_size (set), ==, n - (n + 2) / 3);
+  gtk_bitset_unref (all);
+
+  g_test_timer_start ();
+  gtk_bitset_splice (set, 1, 0, 1);
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "inserting an item before %u items: %gsec", n, elapsed);
+  g_assert_cmpuint (gtk_bitset_get_size (set), ==, n - (n + 2) / 3);
+  g_assert_true (gtk_bitset_contains (set, 2));
+  g_assert_false (gtk_bitset_contains (set, 4));
+
+  g_test_timer_start ();
+  gtk_bitset_shift_left (set, 1);
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "shifting selection of %u items: %gsec", n, elapsed);
+  g_assert_true (gtk_bitset_contains (set, 1));
+  g_assert_false (gtk_bitset_contains (set, 3));
+
+  gtk_bitset_unref (set);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -575,6 +759,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/bitset/rectangle", test_rectangle);
   g_test_add_func ("/bitset/iter", test_iter);
   g_test_add_func ("/bitset/splice-overflow", test_splice_overflow);
+  g_test_add_func ("/bitset/splice", test_splice);
+  g_test_add_func ("/bitset/many", test_many);
+  g_test_add_func ("/bitset/foreach-range", test_foreach_range);
+  g_test_add_func ("/bitset/performance", test_performance);
 
   return g_test_run ();
 }
@@ -0,0 +1,454 @@
+/* GtkColumnView tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#define N_COLUMNS 20
+#define COLUMN_WIDTH 100
+
+typedef struct {
+  guint index;
+  GHashTable *bound;
+} Column;
+
+static void
+setup_cb (GtkSignalListItemFactory *factory,
+          GtkListItem              *list_item,
+          Column                   *column)
+{
+  gtk_list_item_set_child (list_item, gtk_label_new (NULL));
+}
+
+static void
+bind_cb (GtkSignalListItemFactory *factory,
+         GtkListItem              *list_item,
+         Column                   *column)
+{
+  GtkStringObject *string = gtk_list_item_get_item (list_item);
+  char *label;
+
+  label = g_strdup_printf ("c%u %s", column->index, gtk_string_object_get_string (string));
+  gtk_label_set_label (GTK_LABEL (gtk_list_item_get_child (list_item)), label);
+  g_free (label);
+
+  g_assert_true (g_hash_table_add (column->bound, string));
+}
+
+static void
+unbind_cb (GtkSignalListItemFactory *factory,
+           GtkListItem              *list_item,
+           Column                   *column)
+{
+  g_assert_true (g_hash_table_remove (column->bound, gtk_list_item_get_item (list_item)));
+}
+
+static GtkListItemFactory *
+create_factory (Column *column)
+{
+  GtkListItemFactory *factory;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_cb), column);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_cb), column);
+  g_signal_connect (factory, "unbind", G_CALLBACK (unbind_cb), column);
+
+  return factory;
+}
+
+static GtkSelectionModel *
+create_model (guint n_items)
+{
+  GtkStringList *list;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    gtk_string_list_take (list, g_strdup_printf ("item%u", i));
+
+  return GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (list)));
+}
+
+static void
+allocate (GtkWidget *widget,
+          int        width,
+          int        height)
+{
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, NULL, NULL, NULL, NULL);
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, width, NULL, NULL, NULL, NULL);
+  gtk_widget_size_allocate (widget, &(GtkAllocation) { 0, 0, width, height }, -1);
+}
+
+static void
+scroll_to (GtkWidget *view,
+           double     x)
+{
+  GtkAdjustment *hadjustment = gtk_scrollable_get_hadjustment (GTK_SCROLLABLE (view));
+
+  gtk_adjustment_set_value (hadjustment, x);
+  /* cells are created and removed while allocating, so they are
+   * ready before the view is drawn
+   */
+  allocate (view, COLUMN_WIDTH, 200);
+}
+
+static GtkWidget *
+get_list_view (GtkWidget *view)
+{
+  GtkWidget *child;
+
+  for (child = gtk_widget_get_first_child (view);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (GTK_IS_LIST_VIEW (child))
+        return child;
+    }
+
+  g_assert_not_reached ();
+}
+
+/* Checks that only the columns first to last have cells and that
+ * they show the item of their row.
+ * Returns the number of visible rows.
+ */
+static guint
+check_cells (GtkWidget *view,
+             guint      first,
+             guint      last)
+{
+  GtkWidget *row, *cell;
+  guint n_rows = 0;
+
+  for (row = gtk_widget_get_first_child (get_list_view (view));
+       row != NULL;
+       row = gtk_widget_get_next_sibling (row))
+    {
+      const char *item = NULL;
+      guint i;
+
+      if (!gtk_widget_get_child_visible (row))
+        continue;
+
+      for (cell = gtk_widget_get_first_child (row), i = first;
+           cell != NULL;
+           cell = gtk_widget_get_next_sibling (cell), i++)
+        {
+          GtkWidget *label = gtk_widget_get_first_child (cell);
+          char *prefix = g_strdup_printf ("c%u ", i);
+          const char *text = gtk_label_get_label (GTK_LABEL (label));
+
+          g_assert_true (g_str_has_prefix (text, prefix));
+          if (item == NULL)
+            item = text + strlen (prefix);
+          else
+            g_assert_cmpstr (text + strlen (prefix), ==, item);
+
+          g_free (prefix);
+        }
+
+      g_assert_cmpuint (i, ==, last + 1);
+      n_rows++;
+    }
+
+  return n_rows;
+}
+
+static gboolean
+same_items (GHashTable *a,
+            GHashTable *b)
+{
+  GHashTableIter iter;
+  gpointer item;
+
+  if (g_hash_table_size (a) != g_hash_table_size (b))
+    return FALSE;
+
+  g_hash_table_iter_init (&iter, a);
+  while (g_hash_table_iter_next (&iter, &item, NULL))
+    {
+      if (!g_hash_table_contains (b, item))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Test that with lazy columns, columns scrolled out of view have no
+ * cells and that their cells are bound to the item of their row
+ * again when they are scrolled back into view.
+ */
+static void
+test_scroll_columns (void)
+{
+  Column columns[N_COLUMNS];
+  GtkWidget *window, *view;
+  GHashTableIter iter;
+  GHashTable *rows;
+  gpointer item;
+  guint i, n_rows;
+
+  window = gtk_window_new ();
+  view = gtk_column_view_new (create_model (100));
+  gtk_window_set_child (GTK_WINDOW (window), view);
+
+  for (i = 0; i < N_COLUMNS; i++)
+    {
+      GtkColumnViewColumn *column;
+      GtkListItemFactory *factory;
+
+      columns[i].index = i;
+      columns[i].bound = g_hash_table_new (NULL, NULL);
+
+      factory = create_factory (&columns[i]);
+      column = gtk_column_view_column_new ("Column", factory);
+      gtk_column_view_column_set_fixed_width (column, COLUMN_WIDTH);
+      gtk_column_view_append_column (GTK_COLUMN_VIEW (view), column);
+      g_object_unref (column);
+    }
+
+  /* Without lazy columns, all columns have cells */
+  scroll_to (view, 10 * COLUMN_WIDTH);
+  n_rows = check_cells (view, 0, N_COLUMNS - 1);
+  g_assert_cmpuint (n_rows, >, 0);
+  for (i = 0; i < N_COLUMNS; i++)
+    g_assert_cmpuint (g_hash_table_size (columns[i].bound), ==, n_rows);
+
+  /* Only the first column and the one in the margin next to it have cells */
+  gtk_column_view_set_lazy_columns (GTK_COLUMN_VIEW (view), TRUE);
+  scroll_to (view, 0);
+  n_rows = check_cells (view, 0, 1);
+  g_assert_cmpuint (n_rows, >, 0);
+  for (i = 0; i < N_COLUMNS; i++)
+    g_assert_cmpuint (g_hash_table_size (columns[i].bound), ==, i <= 1 ? n_rows : 0);
+  g_assert_true (same_items (columns[0].bound, columns[1].bound));
+
+  rows = g_hash_table_new (NULL, NULL);
+  g_hash_table_iter_init (&iter, columns[0].bound);
+  while (g_hash_table_iter_next (&iter, &item, NULL))
+    g_hash_table_add (rows, item);
+
+  /* Scrolling horizontally binds the same rows in other columns */
+  scroll_to (view, 10 * COLUMN_WIDTH);
+  g_assert_cmpuint (check_cells (view, 9, 11), ==, n_rows);
+  for (i = 0; i < N_COLUMNS; i++)
+    {
+      if (i >= 9 && i <= 11)
+        g_assert_true (same_items (columns[i].bound, rows));
+      else
+        g_assert_cmpuint (g_hash_table_size (columns[i].bound), ==, 0);
+    }
+
+  /* The end of the view */
+  scroll_to (view, (N_COLUMNS - 1) * COLUMN_WIDTH);
+  g_assert_cmpuint (check_cells (view, N_COLUMNS - 2, N_COLUMNS - 1), ==, n_rows);
+
+  /* and back */
+  scroll_to (view, 0);
+  g_assert_cmpuint (check_cells (view, 0, 1), ==, n_rows);
+  g_assert_true (same_items (columns[0].bound, rows));
+  for (i = 2; i < N_COLUMNS; i++)
+    g_assert_cmpuint (g_hash_table_size (columns[i].bound), ==, 0);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_hash_table_unref (rows);
+  for (i = 0; i < N_COLUMNS; i++)
+    g_hash_table_unref (columns[i].bound);
+}
+
+typedef struct {
+  guint index;
+  guint n_evaluated;
+} Digit;
+
+static guint
+get_digit (GtkStringObject *string,
+           Digit           *digit)
+{
+  digit->n_evaluated++;
+
+  return gtk_string_object_get_string (string)[digit->index] - '0';
+}
+
+static GtkSorter *
+create_digit_sorter (Digit *digit)
+{
+  return GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL,
+                                                                          0, NULL,
+                                                                          (GCallback) get_digit,
+                                                                          digit, NULL)));
+}
+
+static GtkColumnViewColumn *
+add_sort_column (GtkWidget *view,
+                 GtkSorter *sorter)
+{
+  GtkColumnViewColumn *column;
+
+  column = gtk_column_view_column_new ("Column", NULL);
+  gtk_column_view_column_set_sorter (column, sorter);
+  gtk_column_view_append_column (GTK_COLUMN_VIEW (view), column);
+  g_object_unref (column);
+  g_object_unref (sorter);
+
+  return column;
+}
+
+static GListModel *
+create_sort_model (GtkWidget *view)
+{
+  const char *strings[] = { "21", "12", "30", "11", "22", "10", "31", "20", NULL };
+  GtkSelectionModel *selection;
+  GtkSortListModel *sort;
+  GtkSorter *sorter;
+
+  sorter = gtk_column_view_get_sorter (GTK_COLUMN_VIEW (view));
+  sort = gtk_sort_list_model_new (G_LIST_MODEL (gtk_string_list_new (strings)), g_object_ref (sorter));
+  selection = GTK_SELECTION_MODEL (gtk_no_selection_new (g_object_ref (G_LIST_MODEL (sort))));
+  gtk_column_view_set_model (GTK_COLUMN_VIEW (view), selection);
+  g_object_unref (selection);
+
+  return G_LIST_MODEL (sort);
+}
+
+static char *
+model_to_string (GListModel *model)
+{
+  GString *string = g_string_new (NULL);
+  guint i;
+
+  for (i = 0; i < g_list_model_get_n_items (model); i++)
+    {
+      GtkStringObject *item = g_list_model_get_item (model, i);
+
+      if (i > 0)
+        g_string_append_c (string, ' ');
+      g_string_append (string, gtk_string_object_get_string (item));
+      g_object_unref (item);
+    }
+
+  return g_string_free (string, FALSE);
+}
+
+#define assert_model(model, expected) G_STMT_START{ \
+  char *s = model_to_string (G_LIST_MODEL (model)); \
+  if (!g_str_equal (s, expected)) \
+     g_assertion_message_cmpstr (G_LOG_DOMAIN, __FILE__, __LINE__, G_STRFUNC, \
+         #model " == " #expected, s, "==", expected); \
+  g_free (s); \
+}G_STMT_END
+
+/* Test that switching the sort direction reuses the sort keys while
+ * switching the primary column creates new ones.
+ */
+static void
+test_sort_keys (void)
+{
+  Digit first = { 0, 0 }, second = { 1, 0 };
+  GtkColumnViewColumn *first_column, *second_column;
+  GtkWidget *view;
+  GListModel *model;
+
+  view = g_object_ref_sink (gtk_column_view_new (NULL));
+  first_column = add_sort_column (view, create_digit_sorter (&first));
+  second_column = add_sort_column (view, create_digit_sorter (&second));
+  model = create_sort_model (view);
+  assert_model (model, "21 12 30 11 22 10 31 20");
+
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), first_column, GTK_SORT_ASCENDING);
+  assert_model (model, "12 11 10 21 22 20 30 31");
+  g_assert_cmpuint (first.n_evaluated, >, 0);
+
+  /* equal items stay in model order */
+  first.n_evaluated = 0;
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), first_column, GTK_SORT_DESCENDING);
+  assert_model (model, "30 31 21 22 20 12 11 10");
+  g_assert_cmpuint (first.n_evaluated, ==, 0);
+
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), second_column, GTK_SORT_ASCENDING);
+  assert_model (model, "30 10 20 21 11 31 12 22");
+  g_assert_cmpuint (second.n_evaluated, >, 0);
+
+  second.n_evaluated = 0;
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), second_column, GTK_SORT_DESCENDING);
+  assert_model (model, "12 22 21 11 31 30 10 20");
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), second_column, GTK_SORT_ASCENDING);
+  assert_model (model, "30 10 20 21 11 31 12 22");
+  g_assert_cmpuint (second.n_evaluated, ==, 0);
+  g_assert_cmpuint (first.n_evaluated, ==, 0);
+
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), NULL, GTK_SORT_ASCENDING);
+  assert_model (model, "21 12 30 11 22 10 31 20");
+
+  g_object_unref (model);
+  g_object_unref (view);
+}
+
+/* Test that the keys of a multisorter column work as tiebreakers and
+ * are reused when the direction changes, even if they are bigger
+ * than what is cached for secondary columns.
+ */
+static void
+test_sort_multisorter (void)
+{
+  Digit first = { 0, 0 }, second = { 1, 0 };
+  GtkColumnViewColumn *column;
+  GtkMultiSorter *multi;
+  GtkWidget *view;
+  GListModel *model;
+  guint i;
+
+  view = g_object_ref_sink (gtk_column_view_new (NULL));
+  multi = gtk_multi_sorter_new ();
+  gtk_multi_sorter_append (multi, create_digit_sorter (&first));
+  /* make the keys big */
+  for (i = 0; i < 20; i++)
+    gtk_multi_sorter_append (multi, create_digit_sorter (&second));
+  column = add_sort_column (view, GTK_SORTER (multi));
+  model = create_sort_model (view);
+
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), column, GTK_SORT_ASCENDING);
+  assert_model (model, "10 11 12 20 21 22 30 31");
+  g_assert_cmpuint (first.n_evaluated, >, 0);
+  g_assert_cmpuint (second.n_evaluated, >, 0);
+
+  first.n_evaluated = 0;
+  second.n_evaluated = 0;
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), column, GTK_SORT_DESCENDING);
+  assert_model (model, "31 30 22 21 20 12 11 10");
+  g_assert_cmpuint (first.n_evaluated, ==, 0);
+  g_assert_cmpuint (second.n_evaluated, ==, 0);
+
+  /* items added later get keys, too */
+  gtk_string_list_append (GTK_STRING_LIST (gtk_sort_list_model_get_model (GTK_SORT_LIST_MODEL (model))), "23");
+  assert_model (model, "31 30 23 22 21 20 12 11 10");
+
+  g_object_unref (model);
+  g_object_unref (view);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/columnview/scroll-columns", test_scroll_columns);
+  g_test_add_func ("/columnview/sort/keys", test_sort_keys);
+  g_test_add_func ("/columnview/sort/multisorter", test_sort_multisorter);
+
+  return g_test_run ();
+}
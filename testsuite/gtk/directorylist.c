@@ -0,0 +1,364 @@
+/* GtkDirectoryList tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include <gtk/gtk.h>
+
+/* More directories than are enumerated in parallel */
+#define N_DIRS 7
+
+typedef struct {
+  guint n_changes;
+  guint n_added;
+} Changes;
+
+static void
+items_changed (GListModel *model,
+               guint       position,
+               guint       removed,
+               guint       added,
+               Changes    *changes)
+{
+  /* restarting clears the list, loading only ever appends */
+  if (removed > 0)
+    {
+      g_assert_cmpuint (position, ==, 0);
+      g_assert_cmpuint (added, ==, 0);
+      changes->n_added = 0;
+      return;
+    }
+
+  g_assert_cmpuint (added, >, 0);
+  g_assert_cmpuint (position, ==, changes->n_added);
+  g_assert_cmpuint (position + added, ==, g_list_model_get_n_items (model));
+
+  changes->n_added += added;
+  changes->n_changes++;
+}
+
+static void
+create_file (const char *dir,
+             const char *name)
+{
+  GError *error = NULL;
+  char *path;
+
+  path = g_build_filename (dir, name, NULL);
+  g_file_set_contents (path, "", 0, &error);
+  g_assert_no_error (error);
+  g_free (path);
+}
+
+static char *
+create_dir (const char *dir,
+            const char *name)
+{
+  char *path;
+
+  path = g_build_filename (dir, name, NULL);
+  g_assert_cmpint (g_mkdir (path, 0700), ==, 0);
+
+  return path;
+}
+
+static void
+remove_tree (const char *path)
+{
+  GDir *dir;
+  const char *name;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)))
+        {
+          char *child = g_build_filename (path, name, NULL);
+
+          if (g_file_test (child, G_FILE_TEST_IS_DIR) &&
+              !g_file_test (child, G_FILE_TEST_IS_SYMLINK))
+            remove_tree (child);
+          else
+            g_unlink (child);
+
+          g_free (child);
+        }
+      g_dir_close (dir);
+    }
+
+  g_rmdir (path);
+}
+
+/* Creates n_dirs subdirectories with a nested directory each and
+ * n_files files in every directory.
+ * Returns the number of entries below the toplevel directory.
+ */
+static guint
+create_tree (const char *root,
+             guint       n_dirs,
+             guint       n_files)
+{
+  guint i, j, n;
+
+  n = 0;
+  for (i = 0; i < n_files; i++)
+    {
+      char *name = g_strdup_printf ("file%u", i);
+      create_file (root, name);
+      g_free (name);
+      n++;
+    }
+
+  for (i = 0; i < n_dirs; i++)
+    {
+      char *name, *dir, *nested;
+
+      name = g_strdup_printf ("dir%u", i);
+      dir = create_dir (root, name);
+      nested = create_dir (dir, "nested");
+      n += 2;
+
+      for (j = 0; j < n_files; j++)
+        {
+          char *file = g_strdup_printf ("file%u", j);
+          create_file (dir, file);
+          create_file (nested, file);
+          g_free (file);
+          n += 2;
+        }
+
+      g_free (nested);
+      g_free (dir);
+      g_free (name);
+    }
+
+  return n;
+}
+
+static GtkDirectoryList *
+create_list (const char *path,
+             gboolean    recursive,
+             Changes    *changes)
+{
+  GtkDirectoryList *list;
+  GFile *file;
+
+  list = gtk_directory_list_new (NULL, NULL);
+  gtk_directory_list_set_recursive (list, recursive);
+  g_signal_connect (list, "items-changed", G_CALLBACK (items_changed), changes);
+
+  file = g_file_new_for_path (path);
+  gtk_directory_list_set_file (list, file);
+  g_object_unref (file);
+
+  return list;
+}
+
+static void
+wait_for_loading (GtkDirectoryList *list)
+{
+  while (gtk_directory_list_is_loading (list))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_no_error ((GError *) gtk_directory_list_get_error (list));
+}
+
+/* Returns the paths of all files relative to root, sorted and
+ * joined by spaces, checking that no file shows up twice.
+ */
+static char *
+list_to_string (GListModel *list,
+                const char *root)
+{
+  GFile *root_file;
+  GPtrArray *paths;
+  GString *string;
+  guint i;
+
+  root_file = g_file_new_for_path (root);
+  paths = g_ptr_array_new_with_free_func (g_free);
+
+  for (i = 0; i < g_list_model_get_n_items (list); i++)
+    {
+      GFileInfo *info = g_list_model_get_item (list, i);
+      GFile *file = G_FILE (g_file_info_get_attribute_object (info, "standard::file"));
+
+      g_ptr_array_add (paths, g_file_get_relative_path (root_file, file));
+      g_object_unref (info);
+    }
+
+  g_ptr_array_sort (paths, (GCompareFunc) g_strcmp0);
+
+  string = g_string_new ("");
+  for (i = 0; i < paths->len; i++)
+    {
+      if (i > 0)
+        {
+          g_assert_cmpstr (g_ptr_array_index (paths, i - 1), !=, g_ptr_array_index (paths, i));
+          g_string_append_c (string, ' ');
+        }
+      g_string_append (string, g_ptr_array_index (paths, i));
+    }
+
+  g_ptr_array_unref (paths);
+  g_object_unref (root_file);
+
+  return g_string_free (string, FALSE);
+}
+
+static void
+test_recursive (void)
+{
+  GtkDirectoryList *list;
+  Changes changes = { 0, };
+  GFile *link;
+  char *root, *path, *s;
+  guint n;
+
+  root = g_dir_make_tmp ("gtk-directorylist-XXXXXX", NULL);
+  g_assert_nonnull (root);
+
+  n = create_tree (root, N_DIRS, 3);
+
+  /* a loop that must not be followed */
+  path = g_build_filename (root, "dir0", "loop", NULL);
+  link = g_file_new_for_path (path);
+  if (g_file_make_symbolic_link (link, root, NULL, NULL))
+    n++;
+  g_free (path);
+
+  list = create_list (root, FALSE, &changes);
+  wait_for_loading (list);
+  s = list_to_string (G_LIST_MODEL (list), root);
+  g_assert_cmpstr (s, ==, "dir0 dir1 dir2 dir3 dir4 dir5 dir6 file0 file1 file2");
+  g_free (s);
+
+  changes.n_changes = 0;
+  gtk_directory_list_set_recursive (list, TRUE);
+  g_assert_true (gtk_directory_list_is_loading (list));
+  wait_for_loading (list);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, n);
+  g_assert_cmpuint (changes.n_added, ==, n);
+  s = list_to_string (G_LIST_MODEL (list), root);
+  g_assert_nonnull (strstr (s, " dir0/nested/file2 "));
+  g_assert_nonnull (strstr (s, " dir6/nested/file0 "));
+  g_free (s);
+
+  /* switching back only lists the toplevel again */
+  gtk_directory_list_set_recursive (list, FALSE);
+  wait_for_loading (list);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, N_DIRS + 3);
+  g_assert_cmpuint (changes.n_added, ==, N_DIRS + 3);
+
+  g_object_unref (list);
+  g_object_unref (link);
+  remove_tree (root);
+  g_free (root);
+}
+
+static void
+test_cancel_recursive (void)
+{
+  GtkDirectoryList *list;
+  Changes changes = { 0, };
+  char *root;
+  guint n;
+
+  root = g_dir_make_tmp ("gtk-directorylist-XXXXXX", NULL);
+  g_assert_nonnull (root);
+  n = create_tree (root, N_DIRS, 10);
+
+  list = create_list (root, TRUE, &changes);
+  /* restart while subdirectories are still being enumerated */
+  while (g_list_model_get_n_items (G_LIST_MODEL (list)) == 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_true (gtk_directory_list_is_loading (list));
+  gtk_directory_list_set_file (list, NULL);
+  g_assert_false (gtk_directory_list_is_loading (list));
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 0);
+
+  /* callbacks of the cancelled enumerations must not touch the list */
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 0);
+
+  g_object_unref (list);
+
+  /* cancelled while enumerations are still running */
+  changes.n_added = 0;
+  list = create_list (root, TRUE, &changes);
+  g_object_unref (list);
+  while (g_main_context_iteration (NULL, FALSE));
+
+  changes.n_added = 0;
+  list = create_list (root, TRUE, &changes);
+  wait_for_loading (list);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, n);
+  g_assert_cmpuint (changes.n_added, ==, n);
+  g_object_unref (list);
+
+  remove_tree (root);
+  g_free (root);
+}
+
+/* Big enough to need many queries */
+#define N_MANY_FILES 6400
+
+static void
+test_many_files (void)
+{
+  GtkDirectoryList *list;
+  Changes changes = { 0, };
+  char *root;
+  gint64 start, elapsed;
+  guint n;
+
+  root = g_dir_make_tmp ("gtk-directorylist-XXXXXX", NULL);
+  g_assert_nonnull (root);
+  n = create_tree (root, 0, N_MANY_FILES);
+
+  start = g_get_monotonic_time ();
+  list = create_list (root, FALSE, &changes);
+  wait_for_loading (list);
+  elapsed = g_get_monotonic_time () - start;
+
+  /* All files were appended in order, in fewer batches than files */
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, n);
+  g_assert_cmpuint (changes.n_added, ==, n);
+  g_assert_cmpuint (changes.n_changes, >, 0);
+  g_assert_cmpuint (changes.n_changes, <, n);
+  g_free (list_to_string (G_LIST_MODEL (list), root));
+
+  if (g_test_perf ())
+    g_test_minimized_result ((double) elapsed / G_USEC_PER_SEC,
+                             "loaded %u files in %u batches", n, changes.n_changes);
+
+  g_object_unref (list);
+  remove_tree (root);
+  g_free (root);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/directorylist/recursive", test_recursive);
+  g_test_add_func ("/directorylist/cancel-recursive", test_cancel_recursive);
+  g_test_add_func ("/directorylist/many-files", test_many_files);
+
+  return g_test_run ();
+}
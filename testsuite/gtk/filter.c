@@ -18,6 +18,7 @@
  */
 
 #include <locale.h>
+#include <string.h>
 
 #include <gtk/gtk.h>
 
@@ -324,6 +325,94 @@ test_string_properties (void)
   g_object_unref (filter);
 }
 
+static void
+test_string_refine (void)
+{
+  GtkFilterListModel *model;
+  GtkFilter *filter;
+  gpointer item;
+
+  filter = GTK_FILTER (gtk_string_filter_new (
+               gtk_cclosure_expression_new (G_TYPE_STRING,
+                                            NULL,
+                                            0, NULL,
+                                            G_CALLBACK (get_spelled_out),
+                                            NULL, NULL)));
+
+  model = new_model (20, filter);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "een");
+  assert_model (model, "13 14 15 16 17 18 19");
+
+  /* not a prefix, but still more strict */
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "nteen");
+  assert_model (model, "17 19");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "NTEEN");
+  assert_model (model, "17 19");
+
+  /* the cached string must not be used once the item changed */
+  item = g_list_model_get_item (gtk_filter_list_model_get_model (model), 0);
+  g_object_set_qdata (item, number_quark, GUINT_TO_POINTER (17));
+  g_object_unref (item);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "een");
+  assert_model (model, "17 13 14 15 16 17 18 19");
+
+  /* longer exact matches are not more strict */
+  gtk_string_filter_set_match_mode (GTK_STRING_FILTER (filter), GTK_STRING_FILTER_MATCH_MODE_EXACT);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thirte");
+  assert_model (model, "");
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "thirteen");
+  assert_model (model, "13");
+
+  g_object_unref (model);
+  g_object_unref (filter);
+}
+
+static void
+test_string_fuzzy (void)
+{
+  GtkFilterListModel *model;
+  GtkStringFilter *filter;
+  GListModel *source;
+  gpointer ten, nineteen;
+
+  filter = gtk_string_filter_new (
+               gtk_cclosure_expression_new (G_TYPE_STRING,
+                                            NULL,
+                                            0, NULL,
+                                            G_CALLBACK (get_spelled_out),
+                                            NULL, NULL));
+  gtk_string_filter_set_match_mode (filter, GTK_STRING_FILTER_MATCH_MODE_FUZZY);
+
+  model = new_model (30, GTK_FILTER (filter));
+  gtk_string_filter_set_search (filter, "tn");
+  assert_model (model, "10 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29");
+
+  gtk_string_filter_set_search (filter, "tnn");
+  assert_model (model, "21 27 29");
+
+  /* matches at the start of a word rank higher */
+  source = gtk_filter_list_model_get_model (model);
+  ten = g_list_model_get_item (source, 9);
+  nineteen = g_list_model_get_item (source, 18);
+  gtk_string_filter_set_search (filter, "tn");
+  g_assert_cmpuint (gtk_string_filter_get_score (filter, nineteen), >, 0);
+  g_assert_cmpuint (gtk_string_filter_get_score (filter, ten), >, gtk_string_filter_get_score (filter, nineteen));
+
+  gtk_string_filter_set_match_mode (filter, GTK_STRING_FILTER_MATCH_MODE_WORD_PREFIX);
+  gtk_string_filter_set_search (filter, "on tw");
+  assert_model (model, "21");
+  gtk_string_filter_set_search (filter, "t");
+  assert_model (model, "2 3 10 12 13 20 21 22 23 24 25 26 27 28 29 30");
+  g_assert_cmpuint (gtk_string_filter_get_score (filter, ten), >, 0);
+  g_assert_cmpuint (gtk_string_filter_get_score (filter, nineteen), ==, 0);
+
+  g_object_unref (ten);
+  g_object_unref (nineteen);
+  g_object_unref (model);
+  g_object_unref (filter);
+}
+
 static void
 test_bool_simple (void)
 {
@@ -371,6 +460,181 @@ test_bool_simple (void)
   g_object_unref (model);
 }
 
+static void
+test_string_changes (void)
+{
+  GtkFilter *filter;
+  GtkEntryBuffer *buffer;
+
+  filter = GTK_FILTER (gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_ENTRY_BUFFER, NULL, "text")));
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "two");
+
+  buffer = gtk_entry_buffer_new ("one", -1);
+  g_assert_false (gtk_filter_match (filter, buffer));
+  g_assert_false (gtk_filter_match (filter, buffer));
+
+  /* cached results must not survive a change */
+  gtk_entry_buffer_set_text (buffer, "two", -1);
+  g_assert_true (gtk_filter_match (filter, buffer));
+  gtk_entry_buffer_set_text (buffer, "three", -1);
+  g_assert_false (gtk_filter_match (filter, buffer));
+  g_object_unref (buffer);
+
+  buffer = gtk_entry_buffer_new ("twenty", -1);
+  g_assert_true (gtk_filter_match (filter, buffer));
+  g_object_unref (filter);
+  g_object_unref (buffer);
+}
+
+static void
+test_string_invalid_utf8 (void)
+{
+  GtkFilter *filter;
+  GtkStringObject *valid, *invalid;
+
+  filter = GTK_FILTER (gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")));
+  valid = gtk_string_object_new ("One \xc3\xa9 two");
+  invalid = gtk_string_object_new ("One \xff two");
+
+  /* invalid strings never match */
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "two");
+  g_assert_true (gtk_filter_match (filter, valid));
+  g_assert_false (gtk_filter_match (filter, invalid));
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "one");
+  g_assert_true (gtk_filter_match (filter, valid));
+  g_assert_false (gtk_filter_match (filter, invalid));
+
+  /* strings prepared while ignoring case must not be used without */
+  gtk_string_filter_set_ignore_case (GTK_STRING_FILTER (filter), FALSE);
+  g_assert_false (gtk_filter_match (filter, valid));
+  g_assert_false (gtk_filter_match (filter, invalid));
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "One");
+  g_assert_true (gtk_filter_match (filter, valid));
+  g_assert_false (gtk_filter_match (filter, invalid));
+
+  gtk_string_filter_set_ignore_case (GTK_STRING_FILTER (filter), TRUE);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "ONE");
+  g_assert_true (gtk_filter_match (filter, valid));
+  g_assert_false (gtk_filter_match (filter, invalid));
+
+  g_object_unref (valid);
+  g_object_unref (invalid);
+  g_object_unref (filter);
+}
+
+static GListModel *
+create_no_children (gpointer item,
+                    gpointer unused)
+{
+  return NULL;
+}
+
+static GtkExpression *
+new_row_item_expression (GType       item_type,
+                         const char *property_name)
+{
+  return gtk_property_expression_new (item_type,
+                                      gtk_property_expression_new (GTK_TYPE_TREE_LIST_ROW, NULL, "item"),
+                                      property_name);
+}
+
+/* Like test_string_changes(), but with a nested expression
+ * that can be cached.
+ */
+static void
+test_string_nested_changes (void)
+{
+  GtkTreeListModel *tree;
+  GtkTreeListRow *row;
+  GListStore *store;
+  GtkFilter *filter;
+  GtkEntryBuffer *buffer;
+
+  store = g_list_store_new (GTK_TYPE_ENTRY_BUFFER);
+  buffer = gtk_entry_buffer_new ("one", -1);
+  g_list_store_append (store, buffer);
+  tree = gtk_tree_list_model_new (G_LIST_MODEL (store), FALSE, FALSE, create_no_children, NULL, NULL);
+  row = g_list_model_get_item (G_LIST_MODEL (tree), 0);
+
+  filter = GTK_FILTER (gtk_string_filter_new (new_row_item_expression (GTK_TYPE_ENTRY_BUFFER, "text")));
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "two");
+
+  g_assert_false (gtk_filter_match (filter, row));
+  g_assert_false (gtk_filter_match (filter, row));
+
+  gtk_entry_buffer_set_text (buffer, "two", -1);
+  g_assert_true (gtk_filter_match (filter, row));
+  gtk_entry_buffer_set_text (buffer, "three", -1);
+  g_assert_false (gtk_filter_match (filter, row));
+
+  g_object_unref (filter);
+  g_object_unref (row);
+  g_object_unref (tree);
+  g_object_unref (buffer);
+  g_object_unref (store);
+}
+
+/* Refilters rows of a tree with a nested expression, so that
+ * results can be taken from the expression cache.
+ */
+static void
+test_string_nested_performance (void)
+{
+  const char *searches[] = { "1", "12", "123", "2", "23", "3", "1" };
+  guint n = g_test_perf () ? 200 * 1000 : 10 * 1000;
+  GtkStringList *list;
+  GtkTreeListModel *tree;
+  GListStore *rows;
+  GtkFilter *filter;
+  GtkFilterListModel *model;
+  double elapsed;
+  guint i, j, n_matches;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n; i++)
+    gtk_string_list_take (list, g_strdup_printf ("%u", i));
+
+  /* rows only live as long as somebody references them */
+  tree = gtk_tree_list_model_new (G_LIST_MODEL (list), FALSE, FALSE, create_no_children, NULL, NULL);
+  rows = g_list_store_new (GTK_TYPE_TREE_LIST_ROW);
+  for (i = 0; i < n; i++)
+    {
+      gpointer row = g_list_model_get_item (G_LIST_MODEL (tree), i);
+      g_list_store_append (rows, row);
+      g_object_unref (row);
+    }
+
+  filter = GTK_FILTER (gtk_string_filter_new (new_row_item_expression (GTK_TYPE_STRING_OBJECT, "string")));
+  gtk_string_filter_set_match_mode (GTK_STRING_FILTER (filter), GTK_STRING_FILTER_MATCH_MODE_SUBSTRING);
+  model = gtk_filter_list_model_new (g_object_ref (G_LIST_MODEL (rows)), g_object_ref (filter));
+
+  g_test_timer_start ();
+  for (i = 0; i < G_N_ELEMENTS (searches); i++)
+    {
+      gtk_string_filter_set_search (GTK_STRING_FILTER (filter), searches[i]);
+
+      n_matches = 0;
+      for (j = 0; j < n; j++)
+        {
+          char *s = g_strdup_printf ("%u", j);
+          if (strstr (s, searches[i]))
+            n_matches++;
+          g_free (s);
+        }
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_matches);
+    }
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "filtering %u rows %u times: %gsec", n, (guint) G_N_ELEMENTS (searches), elapsed);
+
+  g_object_unref (model);
+  g_object_unref (filter);
+  g_object_unref (rows);
+  g_object_unref (tree);
+  g_object_unref (list);
+}
+
 static void
 test_every_dispose (void)
 {
@@ -405,6 +669,12 @@ main (int argc, char *argv[])
   g_test_add_func ("/filter/any/simple", test_any_simple);
   g_test_add_func ("/filter/string/simple", test_string_simple);
   g_test_add_func ("/filter/string/properties", test_string_properties);
+  g_test_add_func ("/filter/string/refine", test_string_refine);
+  g_test_add_func ("/filter/string/fuzzy", test_string_fuzzy);
+  g_test_add_func ("/filter/string/changes", test_string_changes);
+  g_test_add_func ("/filter/string/invalid-utf8", test_string_invalid_utf8);
+  g_test_add_func ("/filter/string/nested-changes", test_string_nested_changes);
+  g_test_add_func ("/filter/string/nested-performance", test_string_nested_performance);
   g_test_add_func ("/filter/bool/simple", test_bool_simple);
   g_test_add_func ("/filter/every/dispose", test_every_dispose);
 
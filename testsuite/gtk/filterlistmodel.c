@@ -376,6 +376,62 @@ test_incremental (void)
   g_object_unref (filter);
 }
 
+/* Test that threaded filtering finds the same items as filtering
+ * on the main thread.
+ */
+static void
+test_threaded (gconstpointer data)
+{
+  gboolean incremental = GPOINTER_TO_UINT (data);
+  GtkFilterListModel *threaded, *regular;
+  GtkStringList *list;
+  GtkFilter *filter;
+  const guint n_items = 20000;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    {
+      char *s = g_strdup_printf ("%u", g_random_int_range (0, n_items));
+      gtk_string_list_append (list, s);
+      g_free (s);
+    }
+
+  filter = GTK_FILTER (gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")));
+  threaded = gtk_filter_list_model_new (g_object_ref (G_LIST_MODEL (list)), g_object_ref (filter));
+  gtk_filter_list_model_set_threaded (threaded, TRUE);
+  gtk_filter_list_model_set_incremental (threaded, incremental);
+  g_assert_true (gtk_filter_list_model_get_threaded (threaded));
+  regular = gtk_filter_list_model_new (g_object_ref (G_LIST_MODEL (list)), g_object_ref (filter));
+
+  for (i = 0; i < 3; i++)
+    {
+      const char *searches[] = { "1", "12", "2" };
+      guint j;
+
+      gtk_string_filter_set_search (GTK_STRING_FILTER (filter), searches[i]);
+      while (gtk_filter_list_model_get_pending (threaded) != 0)
+        g_main_context_iteration (NULL, TRUE);
+
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (threaded)), ==, g_list_model_get_n_items (G_LIST_MODEL (regular)));
+      for (j = 0; j < g_list_model_get_n_items (G_LIST_MODEL (regular)); j++)
+        {
+          gpointer a = g_list_model_get_item (G_LIST_MODEL (threaded), j);
+          gpointer b = g_list_model_get_item (G_LIST_MODEL (regular), j);
+
+          g_assert_true (a == b);
+
+          g_object_unref (a);
+          g_object_unref (b);
+        }
+    }
+
+  g_object_unref (threaded);
+  g_object_unref (regular);
+  g_object_unref (filter);
+  g_object_unref (list);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -389,6 +445,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/filterlistmodel/empty_set_filter", test_empty_set_filter);
   g_test_add_func ("/filterlistmodel/change_filter", test_change_filter);
   g_test_add_func ("/filterlistmodel/incremental", test_incremental);
+  g_test_add_data_func ("/filterlistmodel/threaded", GUINT_TO_POINTER (FALSE), test_threaded);
+  g_test_add_data_func ("/filterlistmodel/incremental/threaded", GUINT_TO_POINTER (TRUE), test_threaded);
 
   return g_test_run ();
 }
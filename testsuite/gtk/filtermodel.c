@@ -6824,6 +6824,71 @@ test_row_changed (void)
   g_object_unref (store);
 }
 
+static int refilter_visibility_modulus;
+
+static gboolean
+refilter_visibility_visible_func (GtkTreeModel *model,
+                                  GtkTreeIter  *iter,
+                                  gpointer      data)
+{
+  int value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value % refilter_visibility_modulus == 0;
+}
+
+static void
+count_signal (GtkTreeModel *model,
+              GtkTreePath  *path,
+              gpointer      data)
+{
+  int *count = data;
+
+  (*count)++;
+}
+
+static void
+test_refilter_visibility (void)
+{
+  GtkListStore *store;
+  GtkTreeModel *filter;
+  int inserted = 0, deleted = 0, changed = 0;
+  int i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 12; i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, i, -1);
+
+  refilter_visibility_modulus = 2;
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          refilter_visibility_visible_func,
+                                          NULL, NULL);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 6);
+
+  g_signal_connect (filter, "row-inserted", G_CALLBACK (count_signal), &inserted);
+  g_signal_connect (filter, "row-deleted", G_CALLBACK (count_signal), &deleted);
+  g_signal_connect (filter, "row-changed", G_CALLBACK (count_signal), &changed);
+
+  /* 0 6 stay, 2 4 8 10 go, 3 9 come */
+  refilter_visibility_modulus = 3;
+  gtk_tree_model_filter_refilter_visibility (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 4);
+  g_assert_cmpint (inserted, ==, 2);
+  g_assert_cmpint (deleted, ==, 4);
+  g_assert_cmpint (changed, ==, 0);
+
+  inserted = deleted = 0;
+  gtk_tree_model_filter_refilter_visibility (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (inserted, ==, 0);
+  g_assert_cmpint (deleted, ==, 0);
+  g_assert_cmpint (changed, ==, 0);
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
 
 /* main */
 
@@ -7188,4 +7253,5 @@ register_filter_model_tests (void)
                    specific_bug_679910);
 
   g_test_add_func ("/TreeModelFilter/signal/row-changed", test_row_changed);
+  g_test_add_func ("/TreeModelFilter/signal/refilter-visibility", test_refilter_visibility);
 }
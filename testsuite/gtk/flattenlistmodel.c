@@ -394,6 +394,86 @@ test_submodel_remove (void)
   g_object_unref (flat);
 }
 
+static void
+test_lookup (void)
+{
+  GtkFlattenListModel *flat;
+  GListStore *model, *store;
+  guint i, j, n;
+
+  model = g_list_store_new (G_TYPE_LIST_MODEL);
+  n = 0;
+  for (i = 0; i < 500; i++)
+    {
+      /* every third model is empty */
+      if (i % 3 == 0)
+        add_store (model, 1, 0, 1);
+      else
+        {
+          add_store (model, n + 1, n + 5, 1);
+          n += 5;
+        }
+    }
+  flat = new_model (model);
+
+  /* look up often enough to make the model switch representation */
+  for (j = 0; j < 3; j++)
+    {
+      for (i = 0; i < n; i++)
+        g_assert_cmpuint (get (G_LIST_MODEL (flat), i), ==, i + 1);
+      g_assert_null (g_list_model_get_item (G_LIST_MODEL (flat), n));
+      g_assert_true (gtk_flatten_list_model_get_model_for_item (flat, 0) == g_list_model_get_item (G_LIST_MODEL (model), 1));
+      g_object_unref (g_list_model_get_item (G_LIST_MODEL (model), 1));
+    }
+
+  /* changes must be picked up */
+  store = G_LIST_STORE (g_list_model_get_item (G_LIST_MODEL (model), 1));
+  g_list_store_remove (store, 0);
+  g_object_unref (store);
+  assert_changes (flat, "-0");
+  for (i = 0; i < n - 1; i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (flat), i), ==, i + 2);
+
+  g_list_store_remove (model, 1);
+  assert_changes (flat, "0-4");
+  for (i = 0; i < n - 5; i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (flat), i), ==, i + 6);
+  g_assert_null (g_list_model_get_item (G_LIST_MODEL (flat), n - 5));
+
+  g_object_unref (model);
+  g_object_unref (flat);
+}
+
+static void
+test_performance (void)
+{
+  GtkFlattenListModel *flat;
+  GListStore *model;
+  guint i, n_models, n_items;
+  double elapsed;
+
+  n_models = g_test_perf () ? 1000 : 100;
+  n_items = 1000;
+
+  model = g_list_store_new (G_TYPE_LIST_MODEL);
+  for (i = 0; i < n_models; i++)
+    add_store (model, i * n_items + 1, (i + 1) * n_items, 1);
+  flat = new_model (model);
+  g_object_unref (model);
+
+  g_test_timer_start ();
+  for (i = 0; i < n_models * n_items; i++)
+    {
+      guint pos = g_test_rand_int_range (0, n_models * n_items);
+      g_assert_cmpuint (get (G_LIST_MODEL (flat), pos), ==, pos + 1);
+    }
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "random access to %u items: %gsec", n_models * n_items, elapsed);
+
+  g_object_unref (flat);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -406,6 +486,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/flattenlistmodel/create_empty", test_create_empty);
   g_test_add_func ("/flattenlistmodel/create", test_create);
   g_test_add_func ("/flattenlistmodel/model/add", test_model_add);
+  g_test_add_func ("/flattenlistmodel/lookup", test_lookup);
+  g_test_add_func ("/flattenlistmodel/performance", test_performance);
 #if GLIB_CHECK_VERSION (2, 58, 0) /* g_list_store_splice() is broken before 2.58 */
   g_test_add_func ("/flattenlistmodel/submodel/add", test_submodel_add);
   g_test_add_func ("/flattenlistmodel/submodel/add2", test_submodel_add2);
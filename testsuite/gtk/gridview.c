@@ -0,0 +1,391 @@
+/* GtkGridView tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define N_ITEMS 1000
+
+static void
+setup_cb (GtkSignalListItemFactory *factory,
+          GtkListItem              *list_item,
+          gpointer                  size)
+{
+  GtkWidget *child = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+
+  gtk_widget_set_size_request (child, GPOINTER_TO_INT (size), GPOINTER_TO_INT (size));
+  gtk_list_item_set_child (list_item, child);
+}
+
+static void
+bind_cb (GtkSignalListItemFactory *factory,
+         GtkListItem              *list_item,
+         gpointer                  size)
+{
+  GtkWidget *child = gtk_list_item_get_child (list_item);
+
+  g_object_set_data (G_OBJECT (child), "item", gtk_list_item_get_item (list_item));
+}
+
+static void
+unbind_cb (GtkSignalListItemFactory *factory,
+           GtkListItem              *list_item,
+           gpointer                  size)
+{
+  g_object_set_data (G_OBJECT (gtk_list_item_get_child (list_item)), "item", NULL);
+}
+
+static GtkListItemFactory *
+create_factory (int size)
+{
+  GtkListItemFactory *factory;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_cb), GINT_TO_POINTER (size));
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_cb), GINT_TO_POINTER (size));
+  g_signal_connect (factory, "unbind", G_CALLBACK (unbind_cb), GINT_TO_POINTER (size));
+
+  return factory;
+}
+
+static GtkSelectionModel *
+create_model (guint n_items)
+{
+  GtkStringList *list;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    gtk_string_list_take (list, g_strdup_printf ("%u", i));
+
+  return GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (list)));
+}
+
+/* List items are only set up once they are rooted */
+static GtkWidget *
+create_grid (int      size,
+             gboolean uniform)
+{
+  GtkWidget *window, *grid;
+
+  window = gtk_window_new ();
+  grid = gtk_grid_view_new (create_model (N_ITEMS), create_factory (size));
+  gtk_grid_view_set_uniform_cells (GTK_GRID_VIEW (grid), uniform);
+  gtk_window_set_child (GTK_WINDOW (window), grid);
+
+  return grid;
+}
+
+static void
+destroy_grid (GtkWidget *grid)
+{
+  gtk_window_destroy (GTK_WINDOW (gtk_widget_get_root (grid)));
+}
+
+static void
+allocate (GtkWidget *widget,
+          int        width,
+          int        height)
+{
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, NULL, NULL, NULL, NULL);
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, width, NULL, NULL, NULL, NULL);
+  gtk_widget_size_allocate (widget, &(GtkAllocation) { 0, 0, width, height }, -1);
+}
+
+static void
+run_idles (void)
+{
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static GtkAdjustment *
+get_vadjustment (GtkWidget *grid)
+{
+  return gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (grid));
+}
+
+static void
+scroll_to_offset (GtkWidget *grid,
+                  double     offset)
+{
+  gtk_adjustment_set_value (get_vadjustment (grid), offset);
+  allocate (grid, 200, 200);
+}
+
+static void
+scroll_to_item (GtkWidget *grid,
+                guint      position)
+{
+  gtk_widget_activate_action (grid, "list.scroll-to-item", "u", position);
+  allocate (grid, 200, 200);
+}
+
+/* Returns the items of the visible children, sorted by their position
+ * in the grid and separated by spaces.
+ */
+static char *
+get_visible_items (GtkWidget *grid)
+{
+  GtkWidget *child;
+  GPtrArray *items;
+  GString *string;
+  guint i;
+
+  items = g_ptr_array_new ();
+  for (child = gtk_widget_get_first_child (grid);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      GtkWidget *box = gtk_widget_get_first_child (child);
+      graphene_rect_t bounds;
+      GtkStringObject *item;
+
+      if (!gtk_widget_get_child_visible (child) || box == NULL)
+        continue;
+
+      item = g_object_get_data (G_OBJECT (box), "item");
+      g_assert_nonnull (item);
+
+      if (!gtk_widget_compute_bounds (child, grid, &bounds) ||
+          bounds.origin.y + bounds.size.height <= 0 ||
+          bounds.origin.y >= gtk_widget_get_height (grid))
+        continue;
+
+      g_ptr_array_add (items, (gpointer) gtk_string_object_get_string (item));
+    }
+
+  g_ptr_array_sort (items, (GCompareFunc) g_strcmp0);
+
+  string = g_string_new (NULL);
+  for (i = 0; i < items->len; i++)
+    {
+      if (i > 0)
+        g_string_append_c (string, ' ');
+      g_string_append (string, g_ptr_array_index (items, i));
+    }
+
+  g_ptr_array_unref (items);
+
+  return g_string_free (string, FALSE);
+}
+
+static void
+assert_same_layout (GtkWidget *grid,
+                    GtkWidget *uniform)
+{
+  char *expected, *visible;
+
+  g_assert_cmpfloat (gtk_adjustment_get_upper (get_vadjustment (uniform)), ==,
+                     gtk_adjustment_get_upper (get_vadjustment (grid)));
+  g_assert_cmpfloat (gtk_adjustment_get_value (get_vadjustment (uniform)), ==,
+                     gtk_adjustment_get_value (get_vadjustment (grid)));
+
+  expected = get_visible_items (grid);
+  visible = get_visible_items (uniform);
+  g_assert_cmpstr (visible, ==, expected);
+  g_assert_cmpstr (visible, !=, "");
+  g_free (visible);
+  g_free (expected);
+}
+
+/* Test that the positions computed for uniform cells match the ones
+ * found by walking the tree when all cells have the same size.
+ */
+static void
+test_uniform_positions (void)
+{
+  const guint positions[] = { 0, 1, 37, 400, 123, N_ITEMS - 1, 0 };
+  const double offsets[] = { 0, 1234, 6000, 12300, 49, 50, 0 };
+  GtkWidget *grid, *uniform;
+  guint i;
+
+  grid = create_grid (50, FALSE);
+  uniform = create_grid (50, TRUE);
+
+  allocate (grid, 200, 200);
+  allocate (uniform, 200, 200);
+  /* 4 columns, rows are 50 high */
+  g_assert_cmpfloat (gtk_adjustment_get_upper (get_vadjustment (uniform)), ==, N_ITEMS / 4 * 50);
+  assert_same_layout (grid, uniform);
+
+  for (i = 0; i < G_N_ELEMENTS (positions); i++)
+    {
+      scroll_to_item (grid, positions[i]);
+      scroll_to_item (uniform, positions[i]);
+      assert_same_layout (grid, uniform);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (offsets); i++)
+    {
+      scroll_to_offset (grid, offsets[i]);
+      scroll_to_offset (uniform, offsets[i]);
+      assert_same_layout (grid, uniform);
+    }
+
+  /* Until it is allocated again, the grid has no uniform row height */
+  gtk_grid_view_set_uniform_cells (GTK_GRID_VIEW (grid), TRUE);
+  scroll_to_item (grid, 400);
+  scroll_to_item (uniform, 400);
+  assert_same_layout (grid, uniform);
+
+  destroy_grid (grid);
+  destroy_grid (uniform);
+}
+
+/* Test that the cell size set by the application is used instead of
+ * measuring a cell.
+ */
+static void
+test_uniform_cell_size (void)
+{
+  GtkWidget *grid, *child;
+
+  grid = create_grid (10, TRUE);
+  gtk_grid_view_set_cell_size (GTK_GRID_VIEW (grid), 40, 30);
+
+  /* 5 columns of 40, rows are 30 high */
+  allocate (grid, 200, 300);
+  g_assert_cmpfloat (gtk_adjustment_get_upper (get_vadjustment (grid)), ==, N_ITEMS / 5 * 30);
+  for (child = gtk_widget_get_first_child (grid);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (!gtk_widget_get_child_visible (child))
+        continue;
+
+      g_assert_cmpint (gtk_widget_get_width (child), ==, 40);
+      g_assert_cmpint (gtk_widget_get_height (child), ==, 30);
+    }
+
+  /* Without a size, a cell is measured: 7 columns at most, and
+   * rows of at least a 30th of the height.
+   */
+  gtk_grid_view_set_cell_size (GTK_GRID_VIEW (grid), -1, -1);
+  allocate (grid, 200, 300);
+  g_assert_cmpfloat (gtk_adjustment_get_upper (get_vadjustment (grid)), ==, (N_ITEMS + 6) / 7 * 10);
+
+  destroy_grid (grid);
+}
+
+/* Test that uniform cells without a height don't break positioning */
+static void
+test_uniform_empty_cells (void)
+{
+  GtkWidget *grid;
+
+  grid = create_grid (0, TRUE);
+
+  allocate (grid, 200, 0);
+  g_assert_cmpfloat (gtk_adjustment_get_upper (get_vadjustment (grid)), ==, 0);
+
+  gtk_widget_activate_action (grid, "list.scroll-to-item", "u", 400);
+  allocate (grid, 200, 0);
+  gtk_adjustment_set_value (get_vadjustment (grid), 100);
+  allocate (grid, 200, 0);
+  g_assert_cmpfloat (gtk_adjustment_get_value (get_vadjustment (grid)), ==, 0);
+
+  destroy_grid (grid);
+}
+
+typedef struct {
+  guint n_emissions;
+  guint position;
+  guint n_items;
+} Prefetch;
+
+static void
+prefetch_cb (GtkGridView *grid,
+             guint        position,
+             guint        n_items,
+             Prefetch    *prefetch)
+{
+  prefetch->n_emissions++;
+  prefetch->position = position;
+  prefetch->n_items = n_items;
+}
+
+static void
+assert_prefetch (Prefetch *prefetch,
+                 guint     position,
+                 guint     n_items)
+{
+  /* the signal is only emitted when idle */
+  g_assert_cmpuint (prefetch->n_emissions, ==, 0);
+  run_idles ();
+
+  g_assert_cmpuint (prefetch->n_emissions, ==, n_items > 0 ? 1 : 0);
+  if (n_items > 0)
+    {
+      g_assert_cmpuint (prefetch->position, ==, position);
+      g_assert_cmpuint (prefetch->n_items, ==, n_items);
+    }
+
+  prefetch->n_emissions = 0;
+}
+
+/* Test that ::prefetch reports the page next to the visible area in
+ * the direction of scrolling.
+ */
+static void
+test_prefetch (void)
+{
+  Prefetch prefetch = { 0, };
+  GtkWidget *grid;
+
+  grid = create_grid (50, TRUE);
+  g_signal_connect (grid, "prefetch", G_CALLBACK (prefetch_cb), &prefetch);
+
+  /* 4 columns, rows are 50 high, so a page holds 16 items */
+  allocate (grid, 200, 200);
+  assert_prefetch (&prefetch, 16, 16);
+
+  /* Allocating again without scrolling doesn't emit the signal */
+  allocate (grid, 200, 200);
+  assert_prefetch (&prefetch, 0, 0);
+
+  scroll_to_offset (grid, 1000);
+  assert_prefetch (&prefetch, 96, 16);
+
+  /* scrolling back prefetches the page before the visible area */
+  scroll_to_offset (grid, 800);
+  assert_prefetch (&prefetch, 48, 16);
+
+  scroll_to_offset (grid, 100);
+  assert_prefetch (&prefetch, 0, 8);
+
+  /* nothing before the start... */
+  scroll_to_offset (grid, 0);
+  assert_prefetch (&prefetch, 0, 0);
+
+  /* ...or after the end */
+  scroll_to_offset (grid, N_ITEMS / 4 * 50 - 200);
+  assert_prefetch (&prefetch, 0, 0);
+
+  destroy_grid (grid);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/gridview/uniform/positions", test_uniform_positions);
+  g_test_add_func ("/gridview/uniform/cell-size", test_uniform_cell_size);
+  g_test_add_func ("/gridview/uniform/empty-cells", test_uniform_empty_cells);
+  g_test_add_func ("/gridview/prefetch", test_prefetch);
+
+  return g_test_run ();
+}
@@ -0,0 +1,335 @@
+/* GtkListView tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+typedef struct {
+  guint n_setup;
+  guint n_bind;
+  guint n_unbind;
+  guint n_teardown;
+} Counts;
+
+static void
+setup_cb (GtkSignalListItemFactory *factory,
+          GtkListItem              *list_item,
+          Counts                   *counts)
+{
+  counts->n_setup++;
+  gtk_list_item_set_child (list_item, gtk_label_new (NULL));
+}
+
+static void
+bind_cb (GtkSignalListItemFactory *factory,
+         GtkListItem              *list_item,
+         Counts                   *counts)
+{
+  GtkStringObject *string = gtk_list_item_get_item (list_item);
+
+  counts->n_bind++;
+  gtk_label_set_label (GTK_LABEL (gtk_list_item_get_child (list_item)),
+                       gtk_string_object_get_string (string));
+}
+
+static void
+unbind_cb (GtkSignalListItemFactory *factory,
+           GtkListItem              *list_item,
+           Counts                   *counts)
+{
+  counts->n_unbind++;
+}
+
+static void
+teardown_cb (GtkSignalListItemFactory *factory,
+             GtkListItem              *list_item,
+             Counts                   *counts)
+{
+  counts->n_teardown++;
+}
+
+static GtkListItemFactory *
+create_factory (Counts *counts)
+{
+  GtkListItemFactory *factory;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_cb), counts);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_cb), counts);
+  g_signal_connect (factory, "unbind", G_CALLBACK (unbind_cb), counts);
+  g_signal_connect (factory, "teardown", G_CALLBACK (teardown_cb), counts);
+
+  return factory;
+}
+
+static GtkSelectionModel *
+create_model (const char *prefix,
+              guint       n_items)
+{
+  GtkStringList *list;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    gtk_string_list_take (list, g_strdup_printf ("%s%u", prefix, i));
+
+  return GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (list)));
+}
+
+/* Checks that all visible rows show an item with the given prefix
+ * and returns the number of visible rows.
+ */
+static guint
+check_rows (GtkWidget  *list,
+            const char *prefix)
+{
+  GtkWidget *child;
+  guint n_visible = 0;
+
+  for (child = gtk_widget_get_first_child (list);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      GtkWidget *label = gtk_widget_get_first_child (child);
+
+      if (!gtk_widget_get_child_visible (child) || !GTK_IS_LABEL (label))
+        continue;
+
+      g_assert_true (g_str_has_prefix (gtk_label_get_label (GTK_LABEL (label)), prefix));
+      n_visible++;
+    }
+
+  return n_visible;
+}
+
+static void
+set_model (GtkWidget         *list,
+           GtkSelectionModel *model)
+{
+  gtk_list_view_set_model (GTK_LIST_VIEW (list), model);
+  g_object_unref (model);
+}
+
+static void
+test_recycle (void)
+{
+  Counts counts = { 0, };
+  GtkListItemFactory *factory;
+  GtkWidget *window, *list;
+  guint n_rows;
+
+  /* List items are only set up once they are rooted */
+  window = gtk_window_new ();
+  list = gtk_list_view_new (create_model ("a", 10), create_factory (&counts));
+  gtk_window_set_child (GTK_WINDOW (window), list);
+
+  n_rows = counts.n_setup;
+  g_assert_cmpuint (n_rows, >, 1);
+  g_assert_cmpuint (counts.n_bind, ==, n_rows);
+  g_assert_cmpuint (check_rows (list, "a"), ==, n_rows);
+
+  /* Replacing the model rebinds the existing widgets */
+  set_model (list, create_model ("b", 10));
+  g_assert_cmpuint (counts.n_setup, ==, n_rows);
+  g_assert_cmpuint (counts.n_teardown, ==, 0);
+  g_assert_cmpuint (counts.n_unbind, ==, n_rows);
+  g_assert_cmpuint (counts.n_bind, ==, 2 * n_rows);
+  g_assert_cmpuint (check_rows (list, "b"), ==, n_rows);
+
+  /* Unused widgets are kept hidden, not torn down... */
+  set_model (list, create_model ("c", 1));
+  g_assert_cmpuint (counts.n_setup, ==, n_rows);
+  g_assert_cmpuint (counts.n_teardown, ==, 0);
+  g_assert_cmpuint (check_rows (list, "c"), ==, 1);
+
+  /* ...and are reused once the model grows again */
+  set_model (list, create_model ("d", 10));
+  g_assert_cmpuint (counts.n_setup, ==, n_rows);
+  g_assert_cmpuint (counts.n_teardown, ==, 0);
+  g_assert_cmpuint (check_rows (list, "d"), ==, n_rows);
+
+  /* Widgets set up by the old factory are not reused by a new one */
+  factory = create_factory (&counts);
+  gtk_list_view_set_factory (GTK_LIST_VIEW (list), factory);
+  g_object_unref (factory);
+  g_assert_cmpuint (counts.n_setup, ==, 2 * n_rows);
+  g_assert_cmpuint (counts.n_teardown, ==, n_rows);
+  g_assert_cmpuint (check_rows (list, "d"), ==, n_rows);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+static void
+sized_setup_cb (GtkSignalListItemFactory *factory,
+                GtkListItem              *list_item,
+                GHashTable               *bound)
+{
+  gtk_list_item_set_child (list_item, gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0));
+}
+
+static void
+sized_bind_cb (GtkSignalListItemFactory *factory,
+               GtkListItem              *list_item,
+               GHashTable               *bound)
+{
+  GtkStringObject *string = gtk_list_item_get_item (list_item);
+  guint number;
+
+  /* strings are a prefix character followed by a number */
+  number = g_ascii_strtoull (gtk_string_object_get_string (string) + 1, NULL, 10);
+
+  /* the first rows are smaller than the rest */
+  gtk_widget_set_size_request (gtk_list_item_get_child (list_item), 10, number < 100 ? 10 : 30);
+
+  g_assert_true (g_hash_table_add (bound, string));
+}
+
+static void
+sized_unbind_cb (GtkSignalListItemFactory *factory,
+                 GtkListItem              *list_item,
+                 GHashTable               *bound)
+{
+  g_assert_true (g_hash_table_remove (bound, gtk_list_item_get_item (list_item)));
+}
+
+static GtkListItemFactory *
+create_sized_factory (GHashTable *bound)
+{
+  GtkListItemFactory *factory;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (sized_setup_cb), bound);
+  g_signal_connect (factory, "bind", G_CALLBACK (sized_bind_cb), bound);
+  g_signal_connect (factory, "unbind", G_CALLBACK (sized_unbind_cb), bound);
+
+  return factory;
+}
+
+static void
+allocate (GtkWidget *widget,
+          int        width,
+          int        height)
+{
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, NULL, NULL, NULL, NULL);
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, width, NULL, NULL, NULL, NULL);
+  gtk_widget_size_allocate (widget, &(GtkAllocation) { 0, 0, width, height }, -1);
+}
+
+static void
+run_idles (void)
+{
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static guint
+count_visible_children (GtkWidget *widget)
+{
+  GtkWidget *child;
+  guint n_visible = 0;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (gtk_widget_get_child_visible (child))
+        n_visible++;
+    }
+
+  return n_visible;
+}
+
+/* Test that rows without a widget get the average height of rows
+ * that were measured, including the ones measured in idle time.
+ */
+static void
+test_estimate (void)
+{
+  const guint n_items = 10000;
+  GtkWidget *window, *list;
+  GtkAdjustment *vadjustment;
+  GHashTable *bound;
+  double upper;
+
+  bound = g_hash_table_new (NULL, NULL);
+  window = gtk_window_new ();
+  list = gtk_list_view_new (create_model ("a", n_items), create_sized_factory (bound));
+  gtk_window_set_child (GTK_WINDOW (window), list);
+  vadjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (list));
+
+  /* only the small rows at the top have been measured... */
+  allocate (list, 100, 100);
+  upper = gtk_adjustment_get_upper (vadjustment);
+  g_assert_cmpfloat (upper, <, 20 * n_items);
+
+  /* ...until rows all over the list are measured when idle */
+  run_idles ();
+  allocate (list, 100, 100);
+  g_assert_cmpfloat (gtk_adjustment_get_upper (vadjustment), >, 20 * n_items);
+  g_assert_cmpfloat (gtk_adjustment_get_value (vadjustment), ==, 0);
+
+  /* the measuring widget doesn't keep an item bound */
+  g_assert_cmpuint (g_hash_table_size (bound), ==, count_visible_children (list));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_hash_table_unref (bound);
+}
+
+/* Test that changing the model while rows are measured in idle
+ * time doesn't leave items of the old model bound.
+ */
+static void
+test_estimate_model_change (void)
+{
+  GtkWidget *window, *list;
+  GHashTableIter iter;
+  GHashTable *bound;
+  gpointer item;
+
+  bound = g_hash_table_new (NULL, NULL);
+  window = gtk_window_new ();
+  list = gtk_list_view_new (create_model ("a", 10000), create_sized_factory (bound));
+  gtk_window_set_child (GTK_WINDOW (window), list);
+
+  allocate (list, 100, 100);
+  g_main_context_iteration (NULL, FALSE);
+
+  set_model (list, create_model ("b", 10000));
+  g_hash_table_iter_init (&iter, bound);
+  while (g_hash_table_iter_next (&iter, &item, NULL))
+    g_assert_cmpint (gtk_string_object_get_string (item)[0], ==, 'b');
+
+  allocate (list, 100, 100);
+  run_idles ();
+  g_hash_table_iter_init (&iter, bound);
+  while (g_hash_table_iter_next (&iter, &item, NULL))
+    g_assert_cmpint (gtk_string_object_get_string (item)[0], ==, 'b');
+  g_assert_cmpuint (g_hash_table_size (bound), ==, count_visible_children (list));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_hash_table_unref (bound);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/listview/recycle", test_recycle);
+  g_test_add_func ("/listview/estimate", test_estimate);
+  g_test_add_func ("/listview/estimate-model-change", test_estimate_model_change);
+
+  return g_test_run ();
+}
@@ -286,6 +286,101 @@ test_set_map_func (void)
   g_object_unref (map);
 }
 
+static void
+test_lookup (void)
+{
+  GtkMapListModel *map;
+  GListStore *store;
+  gpointer keep[3];
+  guint i, j;
+
+  store = new_store (1, 200, 1);
+  map = new_model (store);
+
+  keep[0] = g_list_model_get_item (G_LIST_MODEL (map), 0);
+  keep[1] = g_list_model_get_item (G_LIST_MODEL (map), 100);
+  keep[2] = g_list_model_get_item (G_LIST_MODEL (map), 199);
+
+  /* look up often enough to make the model switch representation */
+  for (j = 0; j < 3; j++)
+    {
+      for (i = 0; i < 200; i++)
+        g_assert_cmpuint (get (G_LIST_MODEL (map), i), ==, 2 * (i + 1));
+      g_assert_null (g_list_model_get_item (G_LIST_MODEL (map), 200));
+    }
+
+  /* mapped items must be kept */
+  for (j = 0; j < 3; j++)
+    {
+      gpointer item = g_list_model_get_item (G_LIST_MODEL (map), j == 0 ? 0 : j == 1 ? 100 : 199);
+      g_assert_true (item == keep[j]);
+      g_object_unref (item);
+    }
+
+  /* also when switching back */
+  g_list_store_remove (store, 50);
+  assert_changes (map, "-50");
+  g_assert_true (g_list_model_get_item (G_LIST_MODEL (map), 99) == keep[1]);
+  g_assert_true (g_list_model_get_item (G_LIST_MODEL (map), 198) == keep[2]);
+  g_object_unref (keep[1]);
+  g_object_unref (keep[2]);
+  for (i = 0; i < 199; i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (map), i), ==, 2 * (i < 50 ? i + 1 : i + 2));
+
+  for (j = 0; j < 3; j++)
+    g_object_unref (keep[j]);
+
+  g_object_unref (store);
+  g_object_unref (map);
+}
+
+static void
+test_performance (void)
+{
+  GtkMapListModel *map;
+  GListStore *store;
+  gpointer *items;
+  guint i, n;
+  double elapsed;
+
+  n = g_test_perf () ? 1000 * 1000 : 10 * 1000;
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+  items = g_new (gpointer, n);
+  for (i = 0; i < n; i++)
+    {
+      items[i] = g_object_new (G_TYPE_OBJECT, NULL);
+      g_object_set_qdata (items[i], number_quark, GUINT_TO_POINTER (i + 1));
+    }
+  g_list_store_splice (store, 0, 0, items, n);
+  for (i = 0; i < n; i++)
+    g_object_unref (items[i]);
+  g_free (items);
+
+  map = new_model (store);
+  g_object_unref (store);
+
+  /* keep every item alive, so only the lookup is measured */
+  items = g_new (gpointer, n);
+  for (i = 0; i < n; i++)
+    items[i] = g_list_model_get_item (G_LIST_MODEL (map), i);
+
+  g_test_timer_start ();
+  for (i = 0; i < n; i++)
+    {
+      guint pos = g_test_rand_int_range (0, n);
+      g_assert_cmpuint (get (G_LIST_MODEL (map), pos), ==, 2 * (pos + 1));
+    }
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "random access to %u items: %gsec", n, elapsed);
+
+  for (i = 0; i < n; i++)
+    g_object_unref (items[i]);
+  g_free (items);
+  g_object_unref (map);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -298,6 +393,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/maplistmodel/create_empty", test_create_empty);
   g_test_add_func ("/maplistmodel/create", test_create);
   g_test_add_func ("/maplistmodel/set-model", test_set_model);
+  g_test_add_func ("/maplistmodel/lookup", test_lookup);
+  g_test_add_func ("/maplistmodel/performance", test_performance);
   g_test_add_func ("/maplistmodel/set-map-func", test_set_map_func);
 
   return g_test_run ();
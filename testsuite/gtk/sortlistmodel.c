@@ -412,6 +412,42 @@ test_remove_items (void)
   g_object_unref (sort);
 }
 
+static void
+test_single_changes (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+
+  store = new_store ((guint[]) { 5, 9, 1, 0 });
+  sort = new_model (store);
+  assert_model (sort, "1 5 9");
+  assert_changes (sort, "");
+
+  add (store, 4);
+  assert_model (sort, "1 4 5 9");
+  assert_changes (sort, "+1");
+
+  add (store, 10);
+  assert_model (sort, "1 4 5 9 10");
+  assert_changes (sort, "+4");
+
+  g_list_store_remove (store, 2);
+  assert_model (sort, "4 5 9 10");
+  assert_changes (sort, "-0");
+
+  /* replace 9 with 3 */
+  splice (store, 1, 1, (guint[]) { 3 }, 1);
+  assert_model (sort, "3 4 5 10");
+  assert_changes (sort, "0-3+3");
+
+  g_list_store_remove (store, 3);
+  assert_model (sort, "3 4 5");
+  assert_changes (sort, "-3");
+
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
 static void
 test_stability (void)
 {
@@ -434,6 +470,44 @@ test_stability (void)
   g_object_unref (sort);
 }
 
+static guint
+get_tens (GObject *object)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark)) / 10;
+}
+
+/* Test that inverting the sorter keeps equal items in model order */
+static void
+test_invert (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+  GtkSorter *sorter;
+  guint indexed;
+
+  for (indexed = 0; indexed < 2; indexed++)
+    {
+      store = new_store ((guint[]) { 11, 31, 21, 1, 12, 2, 0 });
+      sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL, (GCallback) get_tens, NULL, NULL)));
+      sort = g_object_new (GTK_TYPE_SORT_LIST_MODEL,
+                           "indexed", indexed,
+                           "model", store,
+                           "sorter", sorter,
+                           NULL);
+      assert_model (sort, "1 2 11 12 21 31");
+
+      gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter), GTK_SORT_DESCENDING);
+      assert_model (sort, "31 21 11 12 1 2");
+
+      gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter), GTK_SORT_ASCENDING);
+      assert_model (sort, "1 2 11 12 21 31");
+
+      g_object_unref (sorter);
+      g_object_unref (store);
+      g_object_unref (sort);
+    }
+}
+
 static GListStore *
 new_shuffled_store (guint size)
 {
@@ -517,6 +591,205 @@ test_incremental_remove (void)
   g_object_unref (removed);
 }
 
+/* Test that sort keys generated in threads end up sorting
+ * correctly, also when the model changes during generation.
+ */
+static void
+test_parallel_keys (gconstpointer data)
+{
+  gboolean incremental = GPOINTER_TO_UINT (data);
+  GtkStringList *list;
+  GtkSortListModel *model;
+  GtkSorter *sorter;
+  const guint n_items = 50000;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    {
+      char *s = g_strdup_printf ("%08u", g_random_int_range (0, n_items));
+      gtk_string_list_append (list, s);
+      g_free (s);
+    }
+
+  sorter = GTK_SORTER (gtk_string_sorter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")));
+  model = gtk_sort_list_model_new (NULL, sorter);
+  g_assert_false (gtk_sort_list_model_get_threaded (model));
+  gtk_sort_list_model_set_threaded (model, TRUE);
+  gtk_sort_list_model_set_incremental (model, incremental);
+  gtk_sort_list_model_set_model (model, G_LIST_MODEL (list));
+
+  if (incremental)
+    {
+      g_assert_cmpuint (gtk_sort_list_model_get_pending (model), >, 0);
+      gtk_string_list_splice (list, 100, 100, NULL);
+      while (gtk_sort_list_model_get_pending (model) != 0)
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, g_list_model_get_n_items (G_LIST_MODEL (list)));
+  for (i = 1; i < g_list_model_get_n_items (G_LIST_MODEL (model)); i++)
+    {
+      GtkStringObject *a = g_list_model_get_item (G_LIST_MODEL (model), i - 1);
+      GtkStringObject *b = g_list_model_get_item (G_LIST_MODEL (model), i);
+
+      g_assert_cmpstr (gtk_string_object_get_string (a), <=, gtk_string_object_get_string (b));
+
+      g_object_unref (a);
+      g_object_unref (b);
+    }
+
+  g_object_unref (model);
+  g_object_unref (list);
+}
+
+static void
+append_number (GtkStringList *list,
+               guint          number)
+{
+  char *s = g_strdup_printf ("%08u", number);
+  gtk_string_list_append (list, s);
+  g_free (s);
+}
+
+/* Test that sorting large models, which may happen on multiple
+ * threads, still only reports the items that actually moved.
+ */
+static void
+test_large_changes (void)
+{
+  GtkStringList *list;
+  GtkSortListModel *model;
+  GtkSorter *sorter;
+  const guint n_items = 70000;
+  char **added;
+  guint i;
+
+  /* even numbers in order, except for two swapped ones */
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    append_number (list, 2 * (i == 1000 ? 2000 : i == 2000 ? 1000 : i));
+
+  model = new_model (NULL);
+  gtk_sort_list_model_set_threaded (model, TRUE);
+  gtk_sort_list_model_set_model (model, G_LIST_MODEL (list));
+  ignore_changes (model);
+
+  /* sorting from scratch */
+  sorter = GTK_SORTER (gtk_string_sorter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")));
+  gtk_sort_list_model_set_sorter (model, sorter);
+  assert_changes (model, "1000-1001+1001");
+
+  /* resorting after too many items were added to put them into
+   * place one by one
+   */
+  added = g_new0 (char *, 101);
+  for (i = 0; i < 100; i++)
+    added[i] = g_strdup_printf ("%08u", 2 * (3000 + i) + 1);
+  gtk_string_list_splice (list, n_items, 0, (const char * const *) added);
+  g_strfreev (added);
+  assert_changes (model, "3001-99+199");
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_items + 100);
+  for (i = 1; i < g_list_model_get_n_items (G_LIST_MODEL (model)); i++)
+    {
+      GtkStringObject *a = g_list_model_get_item (G_LIST_MODEL (model), i - 1);
+      GtkStringObject *b = g_list_model_get_item (G_LIST_MODEL (model), i);
+
+      g_assert_cmpstr (gtk_string_object_get_string (a), <, gtk_string_object_get_string (b));
+
+      g_object_unref (a);
+      g_object_unref (b);
+    }
+
+  g_object_unref (sorter);
+  g_object_unref (model);
+  g_object_unref (list);
+}
+
+/* Test that an indexed model sorts like a regular one while the
+ * model is changed both in small and large steps.
+ */
+static void
+test_indexed (void)
+{
+  GListStore *store;
+  GtkSortListModel *indexed, *regular;
+  GtkSorter *sorter;
+  const guint n_items = 1000;
+  guint i, j, n;
+
+  store = new_shuffled_store (n_items);
+  sorter = GTK_SORTER (gtk_custom_sorter_new (compare_modulo, GUINT_TO_POINTER (100), NULL));
+  indexed = g_object_new (GTK_TYPE_SORT_LIST_MODEL,
+                          "indexed", TRUE,
+                          "model", store,
+                          "sorter", sorter,
+                          NULL);
+  regular = gtk_sort_list_model_new (g_object_ref (G_LIST_MODEL (store)), g_object_ref (sorter));
+  g_assert_true (gtk_sort_list_model_get_indexed (indexed));
+  g_assert_false (gtk_sort_list_model_get_indexed (regular));
+
+  for (i = 0; i < 500; i++)
+    {
+      guint position;
+
+      n = g_list_model_get_n_items (G_LIST_MODEL (store));
+      position = g_random_int_range (0, n);
+
+      switch (g_random_int_range (0, 4))
+        {
+        case 0:
+          insert (store, position, g_random_int_range (1, 10000));
+          break;
+
+        case 1:
+          g_list_store_remove (store, position);
+          break;
+
+        case 2:
+          splice (store, position, MIN (3, n - position), (guint[]) { 7, 107, 207 }, 3);
+          break;
+
+        case 3:
+          if (i % 50 == 0)
+            {
+              /* too large for single changes */
+              g_list_store_splice (store, 0, n / 2, NULL, 0);
+              for (j = 0; j < n / 2; j++)
+                add (store, g_random_int_range (1, 10000));
+            }
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+
+      if (i == 250)
+        {
+          gtk_custom_sorter_set_sort_func (GTK_CUSTOM_SORTER (sorter), compare, NULL, NULL);
+        }
+
+      n = g_list_model_get_n_items (G_LIST_MODEL (store));
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (indexed)), ==, n);
+      for (j = 0; j < n; j++)
+        {
+          gpointer a = g_list_model_get_item (G_LIST_MODEL (indexed), j);
+          gpointer b = g_list_model_get_item (G_LIST_MODEL (regular), j);
+
+          g_assert_true (a == b);
+
+          g_object_unref (a);
+          g_object_unref (b);
+        }
+    }
+
+  g_object_unref (indexed);
+  g_object_unref (regular);
+  g_object_unref (sorter);
+  g_object_unref (store);
+}
+
 static void
 test_out_of_bounds_access (void)
 {
@@ -551,9 +824,15 @@ main (int argc, char *argv[])
   g_test_add_func ("/sortlistmodel/add_items", test_add_items);
   g_test_add_func ("/sortlistmodel/remove_items", test_remove_items);
 #endif
+  g_test_add_func ("/sortlistmodel/single-changes", test_single_changes);
   g_test_add_func ("/sortlistmodel/stability", test_stability);
+  g_test_add_func ("/sortlistmodel/invert", test_invert);
+  g_test_add_func ("/sortlistmodel/indexed", test_indexed);
   g_test_add_func ("/sortlistmodel/incremental/remove", test_incremental_remove);
   g_test_add_func ("/sortlistmodel/oob-access", test_out_of_bounds_access);
+  g_test_add_data_func ("/sortlistmodel/parallel-keys", GUINT_TO_POINTER (FALSE), test_parallel_keys);
+  g_test_add_data_func ("/sortlistmodel/incremental/parallel-keys", GUINT_TO_POINTER (TRUE), test_parallel_keys);
+  g_test_add_func ("/sortlistmodel/large-changes", test_large_changes);
 
   return g_test_run ();
 }
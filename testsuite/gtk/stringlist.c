@@ -242,6 +242,111 @@ test_take (void)
   g_object_unref (list);
 }
 
+static void
+test_create_take (void)
+{
+  GtkStringList *list;
+
+  list = gtk_string_list_new_take (g_strsplit ("a b c", " ", -1));
+  assert_model (list, "a b c");
+  g_object_unref (list);
+
+  list = gtk_string_list_new_take (NULL);
+  assert_model (list, "");
+  g_object_unref (list);
+}
+
+static void
+test_items (void)
+{
+  GtkStringList *list;
+  GtkStringObject *a, *b;
+
+  list = new_model ((const char *[]){ "a", "b", "c", NULL });
+
+  a = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  b = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_true (a == b);
+  g_assert_cmpstr (gtk_string_object_get_string (a), ==, "a");
+  g_object_unref (b);
+
+  /* the object must survive the string leaving the list */
+  gtk_string_list_remove (list, 0);
+  assert_changes (list, "-0");
+  g_assert_cmpstr (gtk_string_object_get_string (a), ==, "a");
+
+  b = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_cmpstr (gtk_string_object_get_string (b), ==, "c");
+
+  g_object_unref (list);
+
+  g_assert_cmpstr (gtk_string_object_get_string (a), ==, "a");
+  g_assert_cmpstr (gtk_string_object_get_string (b), ==, "c");
+  g_object_unref (a);
+  g_object_unref (b);
+}
+
+/* Test that looking up a row again returns the same object
+ * while somebody holds a reference to it, and that the list
+ * itself doesn't keep objects alive.
+ */
+static void
+test_item_identity (void)
+{
+  GtkStringList *list;
+  GtkStringObject *a, *b;
+  GQuark quark;
+  gpointer weak;
+
+  quark = g_quark_from_static_string ("stringlist-test-identity");
+  list = new_model ((const char *[]){ "a", "b", "c", NULL });
+
+  a = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_object_set_qdata (G_OBJECT (a), quark, GUINT_TO_POINTER (1));
+
+  b = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_true (a == b);
+  g_assert_cmpuint (GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (b), quark)), ==, 1);
+  g_object_unref (b);
+
+  /* rows keep their object when other rows change */
+  gtk_string_list_splice (list, 0, 1, (const char *[]){ "x", "y", NULL });
+  assert_changes (list, "0-1+2");
+  b = g_list_model_get_item (G_LIST_MODEL (list), 2);
+  g_assert_true (a == b);
+  g_assert_cmpstr (gtk_string_object_get_string (b), ==, "b");
+  g_object_unref (b);
+
+  /* a row that was removed and added again gets a new object,
+   * while the old one keeps its string
+   */
+  gtk_string_list_remove (list, 2);
+  assert_changes (list, "-2");
+  gtk_string_list_append (list, "b");
+  assert_changes (list, "+3");
+  b = g_list_model_get_item (G_LIST_MODEL (list), 3);
+  g_assert_true (a != b);
+  g_assert_cmpstr (gtk_string_object_get_string (a), ==, "b");
+  g_assert_cmpstr (gtk_string_object_get_string (b), ==, "b");
+  g_assert_null (g_object_get_qdata (G_OBJECT (b), quark));
+  g_object_unref (a);
+
+  /* the list doesn't keep objects alive */
+  g_object_set_qdata (G_OBJECT (b), quark, GUINT_TO_POINTER (2));
+  weak = b;
+  g_object_add_weak_pointer (G_OBJECT (b), &weak);
+  g_object_unref (b);
+  g_assert_null (weak);
+  b = g_list_model_get_item (G_LIST_MODEL (list), 3);
+  g_assert_cmpstr (gtk_string_object_get_string (b), ==, "b");
+  g_assert_null (g_object_get_qdata (G_OBJECT (b), quark));
+
+  /* objects outlive the list */
+  g_object_unref (list);
+  g_assert_cmpstr (gtk_string_object_get_string (b), ==, "b");
+  g_object_unref (b);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -252,11 +357,14 @@ main (int argc, char *argv[])
   g_test_add_func ("/stringobject/basic", test_string_object);
   g_test_add_func ("/stringlist/create/empty", test_create_empty);
   g_test_add_func ("/stringlist/create/strv", test_create_strv);
+  g_test_add_func ("/stringlist/create/take", test_create_take);
   g_test_add_func ("/stringlist/create/builder", test_create_builder);
   g_test_add_func ("/stringlist/get_string", test_get_string);
   g_test_add_func ("/stringlist/splice", test_splice);
   g_test_add_func ("/stringlist/add_remove", test_add_remove);
   g_test_add_func ("/stringlist/take", test_take);
+  g_test_add_func ("/stringlist/items", test_items);
+  g_test_add_func ("/stringlist/item-identity", test_item_identity);
 
   return g_test_run ();
 }
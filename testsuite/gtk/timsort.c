@@ -196,6 +196,80 @@ test_pointers_huge (void)
   g_free (a);
 }
 
+typedef struct {
+  int key;
+  guint index;
+} KeyedInt;
+
+static int
+compare_keyed_int (gconstpointer a,
+                   gconstpointer b,
+                   gpointer      unused)
+{
+  int ia = ((const KeyedInt *) a)->key;
+  int ib = ((const KeyedInt *) b)->key;
+
+  return ia < ib ? -1 : (ia > ib);
+}
+
+/* Compare against the serial sort. Keys have lots of duplicates,
+ * so this also checks that the parallel sort is stable.
+ */
+static void
+run_parallel_comparison (gsize n,
+                         int   max_key,
+                         guint n_threads)
+{
+  gint64 start, mid, end;
+  KeyedInt *a, *b;
+  gsize i;
+
+  a = g_new (KeyedInt, n);
+  for (i = 0; i < n; i++)
+    {
+      a[i].key = g_test_rand_int_range (0, max_key);
+      a[i].index = i;
+    }
+  b = g_memdup (a, sizeof (KeyedInt) * n);
+
+  start = g_get_monotonic_time ();
+  gtk_tim_sort (a, n, sizeof (KeyedInt), compare_keyed_int, NULL);
+  mid = g_get_monotonic_time ();
+  gtk_tim_sort_parallel (b, n, sizeof (KeyedInt), compare_keyed_int, NULL, n_threads);
+  end = g_get_monotonic_time ();
+
+  g_test_message ("%zu items with %u threads in %uus vs %uus serial (%u%%)",
+                  n, n_threads,
+                  (guint) (end - mid),
+                  (guint) (mid - start),
+                  (guint) (100 * (end - mid) / MAX (1, mid - start)));
+  g_assert_cmpmem (a, sizeof (KeyedInt) * n, b, sizeof (KeyedInt) * n);
+
+  g_free (b);
+  g_free (a);
+}
+
+static void
+test_parallel (void)
+{
+  gsize run;
+
+  for (run = 0; run < 10; run++)
+    {
+      run_parallel_comparison (g_test_rand_int_range (0, 200 * 1000),
+                               g_test_rand_bit () ? 100 : G_MAXINT,
+                               g_test_rand_int_range (1, 17));
+    }
+}
+
+static void
+test_parallel_huge (void)
+{
+  run_parallel_comparison (g_test_rand_int_range (2 * 1000 * 1000, 5 * 1000 * 1000),
+                           G_MAXINT,
+                           g_get_num_processors ());
+}
+
 static void
 test_steps (void)
 {
@@ -248,6 +322,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/timsort/pointers", test_pointers);
   g_test_add_func ("/timsort/pointers/huge", test_pointers_huge);
   g_test_add_func ("/timsort/steps", test_steps);
+  g_test_add_func ("/timsort/parallel", test_parallel);
+  g_test_add_func ("/timsort/parallel/huge", test_parallel_huge);
 
   return g_test_run ();
 }
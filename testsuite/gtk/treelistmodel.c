@@ -31,6 +31,15 @@ get (GListModel *model,
   GObject *object = g_list_model_get_item (model, position);
   guint number;
   g_assert (object != NULL);
+  if (GTK_IS_TREE_LIST_ROW (object))
+    {
+      GObject *item = gtk_tree_list_row_get_item (GTK_TREE_LIST_ROW (object));
+      g_object_unref (object);
+      /* placeholder rows have no item */
+      if (item == NULL)
+        return 0;
+      object = item;
+    }
   number = GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark));
   g_object_unref (object);
   return number;
@@ -252,10 +261,298 @@ test_remove_some (void)
   g_object_unref (tree);
 }
 
+typedef struct {
+  GtkTreeListRow *row;
+  guint request;
+} Request;
+
+static void
+clear_request (gpointer data)
+{
+  Request *request = data;
+
+  g_object_unref (request->row);
+}
+
+static void
+create_sub_model_async_cb (GtkTreeListRow *row,
+                           gpointer        item,
+                           guint           request,
+                           gpointer        data)
+{
+  GArray *requests = data;
+  Request r = { g_object_ref (row), request };
+
+  g_array_append_val (requests, r);
+}
+
+static GtkTreeListModel *
+new_async_model (gboolean  passthrough,
+                 GArray   *requests)
+{
+  GtkTreeListModel *tree;
+  GString *changes;
+
+  tree = gtk_tree_list_model_new_async (G_LIST_MODEL (new_store (100, 100, 100)),
+                                        passthrough, FALSE,
+                                        create_sub_model_async_cb, requests, NULL);
+  changes = g_string_new ("");
+  g_object_set_qdata_full (G_OBJECT(tree), changes_quark, changes, free_changes);
+  g_signal_connect (tree, "items-changed", G_CALLBACK (items_changed), changes);
+
+  return tree;
+}
+
+static GArray *
+new_requests (void)
+{
+  GArray *requests;
+
+  requests = g_array_new (FALSE, FALSE, sizeof (Request));
+  g_array_set_clear_func (requests, clear_request);
+
+  return requests;
+}
+
+static void
+test_async (void)
+{
+  GtkTreeListModel *tree;
+  GtkTreeListRow *row;
+  GArray *requests;
+  Request *request;
+  gpointer item;
+
+  requests = new_requests ();
+  tree = new_async_model (TRUE, requests);
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_assert_true (gtk_tree_list_row_get_expanded (row));
+  g_assert_cmpuint (requests->len, ==, 1);
+  request = &g_array_index (requests, Request, 0);
+  g_assert_true (request->row == row);
+  assert_model (tree, "100");
+  assert_changes (tree, "");
+
+  item = gtk_tree_list_row_get_item (row);
+  gtk_tree_list_row_set_children (row, request->request, item);
+  g_object_unref (item);
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "1+10");
+
+  /* rows without children stop being expandable */
+  g_object_unref (row);
+  row = gtk_tree_list_model_get_row (tree, 1);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_assert_cmpuint (requests->len, ==, 2);
+  request = &g_array_index (requests, Request, 1);
+  gtk_tree_list_row_set_children (row, request->request, NULL);
+  g_assert_false (gtk_tree_list_row_get_expanded (row));
+  g_assert_false (gtk_tree_list_row_is_expandable (row));
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "");
+  g_object_unref (row);
+
+  g_object_unref (tree);
+  g_array_unref (requests);
+}
+
+static void
+test_async_placeholder (void)
+{
+  GtkTreeListModel *tree;
+  GtkTreeListRow *row, *placeholder;
+  GArray *requests;
+  Request *request;
+  gpointer item;
+
+  requests = new_requests ();
+  tree = new_async_model (FALSE, requests);
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_assert_cmpuint (requests->len, ==, 1);
+  request = &g_array_index (requests, Request, 0);
+  g_assert_true (request->row == row);
+
+  /* a placeholder row without an item is shown while loading */
+  assert_model (tree, "100 0");
+  assert_changes (tree, "+1");
+  placeholder = gtk_tree_list_model_get_row (tree, 1);
+  g_assert_null (gtk_tree_list_row_get_item (placeholder));
+  g_assert_false (gtk_tree_list_row_is_expandable (placeholder));
+  g_assert_cmpuint (gtk_tree_list_row_get_depth (placeholder), ==, 1);
+  g_object_unref (placeholder);
+
+  /* and replaced by the children */
+  item = gtk_tree_list_row_get_item (row);
+  gtk_tree_list_row_set_children (row, request->request, item);
+  g_object_unref (item);
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "1-1+10");
+
+  /* or removed if there are none */
+  g_object_unref (row);
+  row = gtk_tree_list_model_get_row (tree, 1);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_assert_cmpuint (requests->len, ==, 2);
+  assert_model (tree, "100 100 0 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "+2");
+  request = &g_array_index (requests, Request, 1);
+  gtk_tree_list_row_set_children (row, request->request, NULL);
+  g_assert_false (gtk_tree_list_row_get_expanded (row));
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "-2");
+  g_object_unref (row);
+
+  g_object_unref (tree);
+  g_array_unref (requests);
+}
+
+/* Test that answers to requests from before the row was collapsed
+ * are ignored, also when the row was expanded again.
+ */
+static void
+test_async_stale (void)
+{
+  GtkTreeListModel *tree;
+  GtkTreeListRow *row;
+  GArray *requests;
+  guint first, second;
+  gpointer item;
+
+  requests = new_requests ();
+  tree = new_async_model (FALSE, requests);
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  item = gtk_tree_list_row_get_item (row);
+
+  /* collapsed */
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_assert_cmpuint (requests->len, ==, 1);
+  first = g_array_index (requests, Request, 0).request;
+  gtk_tree_list_row_set_expanded (row, FALSE);
+  assert_changes (tree, "+1, -1");
+
+  gtk_tree_list_row_set_children (row, first, item);
+  g_assert_false (gtk_tree_list_row_get_expanded (row));
+  assert_model (tree, "100");
+  assert_changes (tree, "");
+
+  /* collapsed and expanded again */
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_assert_cmpuint (requests->len, ==, 2);
+  second = g_array_index (requests, Request, 1).request;
+  g_assert_cmpuint (first, !=, second);
+  assert_changes (tree, "+1");
+
+  gtk_tree_list_row_set_children (row, first, NULL);
+  g_assert_true (gtk_tree_list_row_get_expanded (row));
+  assert_model (tree, "100 0");
+  assert_changes (tree, "");
+
+  /* the current request still works */
+  gtk_tree_list_row_set_children (row, second, item);
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "1-1+10");
+
+  /* and can only be answered once */
+  gtk_tree_list_row_set_children (row, second, NULL);
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "");
+
+  g_object_unref (item);
+  g_object_unref (row);
+  g_object_unref (tree);
+  g_array_unref (requests);
+}
+
+static void
+run_idles (void)
+{
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static void
+test_autoexpand_depth (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+  GtkTreeExpander *expander;
+  GtkTreeListRow *row;
+  guint i;
+
+  gtk_tree_list_model_set_autoexpand_depth (tree, 1);
+  gtk_tree_list_model_set_autoexpand (tree, TRUE);
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_object_unref (row);
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "1+10");
+
+  /* looking up the rows doesn't expand them */
+  run_idles ();
+  assert_model (tree, "100 100 90 80 70 60 50 40 30 20 10");
+  assert_changes (tree, "");
+
+  /* showing them in an expander expands them when idle */
+  expander = GTK_TREE_EXPANDER (g_object_ref_sink (gtk_tree_expander_new ()));
+  for (i = 1; i < 11; i++)
+    {
+      row = gtk_tree_list_model_get_row (tree, i);
+      gtk_tree_expander_set_list_row (expander, row);
+      g_object_unref (row);
+    }
+  gtk_tree_expander_set_list_row (expander, NULL);
+  assert_changes (tree, "");
+  run_idles ();
+
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  assert_changes (tree, "2+10, 13+10, 24+10, 35+10, 46+10, 57+10, 68+10, 79+10, 90+10, 101+10");
+
+  g_object_unref (expander);
+  g_object_unref (tree);
+}
+
+/* Test that sorting, which looks up every row, doesn't autoexpand
+ * the rows that are too deep, so the tree doesn't grow without
+ * bounds while the sort model keeps up with it.
+ */
+static void
+test_autoexpand_sorted (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+  GtkSortListModel *sort;
+  GtkTreeListRow *row;
+
+  gtk_tree_list_model_set_autoexpand_depth (tree, 1);
+  gtk_tree_list_model_set_autoexpand (tree, TRUE);
+
+  sort = gtk_sort_list_model_new (g_object_ref (G_LIST_MODEL (tree)),
+                                  GTK_SORTER (gtk_tree_list_row_sorter_new (NULL)));
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sort)), ==, 1);
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  gtk_tree_list_row_set_expanded (row, TRUE);
+  g_object_unref (row);
+  assert_changes (tree, "1+10");
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sort)), ==, 11);
+
+  run_idles ();
+  assert_changes (tree, "");
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (tree)), ==, 11);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sort)), ==, 11);
+
+  g_object_unref (sort);
+  g_object_unref (tree);
+}
+
 int
 main (int argc, char *argv[])
 {
-  g_test_init (&argc, &argv, NULL);
+  gtk_test_init (&argc, &argv, NULL);
   setlocale (LC_ALL, "C");
 
   number_quark = g_quark_from_static_string ("Hell and fire was spawned to be released.");
@@ -263,6 +560,11 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/treelistmodel/expand", test_expand);
   g_test_add_func ("/treelistmodel/remove_some", test_remove_some);
+  g_test_add_func ("/treelistmodel/async", test_async);
+  g_test_add_func ("/treelistmodel/async-placeholder", test_async_placeholder);
+  g_test_add_func ("/treelistmodel/async-stale", test_async_stale);
+  g_test_add_func ("/treelistmodel/autoexpand-depth", test_autoexpand_depth);
+  g_test_add_func ("/treelistmodel/autoexpand-sorted", test_autoexpand_sorted);
 
   return g_test_run ();
 }